@@ -1,174 +1,178 @@
 #include "ad-envelope.h"
 
-#include <pico/time.h>
-
+#include "cv-units.h"
+#include "exp-table.h"
 #include "fixed-point.h"
+#include "pot-curves.h"
 
 namespace {
-constexpr float kEnvelopePeakSignalV = 5.0f;	// Envelope signal domain: 0..+5V.
-constexpr float kCenterVoltageV = 5.0f;		// DAC domain center for 0V signal.
-constexpr float kMaxDacVoltageV = 10.0f;
-constexpr float kGateThresholdV = 1.0f;
+// Envelope signal domain 0..+5V sits on the upper half of the DAC range.
+constexpr int32_t kEnvelopePeakCodes = cv_units::kDacMax - cv_units::kDacCenter;
+
+// Stage times run ~1 ms..5 s; the minimum avoids division by zero.
+constexpr auto kStageTimeUs = pot_curves::make_table<uint32_t>(pot_curves::envelope_stage_us);
+
+// Exponential segments are RC curves run for kCurveTimeConstants time
+// constants, then scaled so each stage still spans exactly 0..peak.
+constexpr uint32_t kCurveTimeConstants = 5;
+constexpr int32_t kCurveEndQ15 = exp_table::exp_neg_q15(kCurveTimeConstants << 16);
+constexpr uint32_t kCurveGainQ16 =
+	((static_cast<uint32_t>(exp_table::kQ15One) << 16) +
+	 (exp_table::kQ15One - kCurveEndQ15) / 2) /
+	(exp_table::kQ15One - kCurveEndQ15);
+
+uint16_t envelope_to_dac(int32_t envelope_q15) {
+	return cv_units::clamp_dac(cv_units::kDacCenter +
+							   ((envelope_q15 * kEnvelopePeakCodes) >> 15));
+}
 }
 
 AdEnvelope::AdEnvelope()
-	: envelope_a_{Stage::kIdle, 0, 0, 0, false},
-	  envelope_b_{Stage::kIdle, 0, 0, 0, false},
+	: envelope_a_{Stage::kIdle, 0},
+	  envelope_b_{Stage::kIdle, 0},
 	  button_b_prev_(false),
-	  pulse_triggered_(false) {}
-
-void AdEnvelope::init(brain::io::Pulse& pulse) {
-	pulse.on_rise([this]() {
-		pulse_triggered_ = true;
-	});
-}
-
-void AdEnvelope::update(brain::ui::Pots& pots, brain::io::AudioCvIn& cv_in,
-						 brain::io::AudioCvOut& cv_out, brain::io::Pulse& pulse,
-						 Calibration& calibration, bool button_b_pressed,
-						 brain::ui::Leds& leds, LedController& led_controller) {
-	(void)calibration;
-
-	pulse.poll();
-
-	uint32_t now_us = time_us_32();
-
-	// Read pots
-	uint32_t attack_us = pot_to_time_us(pots.get(kPotAttack));
-	uint32_t decay_us = pot_to_time_us(pots.get(kPotDecay));
-	uint16_t shape_q15 = fixed_point::u8_to_q15(pots.get(kPotShape));
-
-	// Trigger detection: per-channel gate rising edges, manual button, and pulse-in.
-	bool trigger_a = false;
-	bool trigger_b = false;
-	const bool gate_a_high = cv_in.get_voltage_channel_a() > kGateThresholdV;
-	const bool gate_b_high = cv_in.get_voltage_channel_b() > kGateThresholdV;
-	if (!envelope_a_.gate_prev_high && gate_a_high) {
-		trigger_a = true;
+	  out_a_code_(cv_units::kDacCenter),
+	  out_b_code_(cv_units::kDacCenter),
+	  shape_q15_(0),
+	  increment_period_us_(0),
+	  attack_increment_(0),
+	  decay_increment_(0) {}
+
+void AdEnvelope::process(const BlockParams& params, const Frame* in, Frame* out, size_t n) {
+	const ControlSnapshot& controls = params.controls;
+
+	// Pot-derived parameters, refreshed only when a pot moves. A new time
+	// also applies to a stage already running, from its current phase.
+	const bool period_changed = params.period_us != increment_period_us_;
+	increment_period_us_ = params.period_us;
+	if (pot_watch_.changed(controls, kPotAttack) || period_changed) {
+		attack_increment_ =
+			phase_increment(params.period_us, kStageTimeUs[controls.pots[kPotAttack]]);
 	}
-	if (!envelope_b_.gate_prev_high && gate_b_high) {
-		trigger_b = true;
+	if (pot_watch_.changed(controls, kPotDecay) || period_changed) {
+		decay_increment_ =
+			phase_increment(params.period_us, kStageTimeUs[controls.pots[kPotDecay]]);
 	}
-	envelope_a_.gate_prev_high = gate_a_high;
-	envelope_b_.gate_prev_high = gate_b_high;
-
-	if (!button_b_prev_ && button_b_pressed) {
-		trigger_a = true;
-		trigger_b = true;
+	if (pot_watch_.changed(controls, kPotShape)) {
+		shape_q15_ = fixed_point::u8_to_q15_shift(controls.pots[kPotShape]);
 	}
-	button_b_prev_ = button_b_pressed;
+	const uint32_t attack_increment = attack_increment_;
+	const uint32_t decay_increment = decay_increment_;
+	const uint16_t shape_q15 = shape_q15_;
+
+	// Manual button triggers both channels on the block's first frame.
+	bool button_trigger = !button_b_prev_ && controls.button_b_pressed;
+	button_b_prev_ = controls.button_b_pressed;
+
+	for (size_t i = 0; i < n; ++i) {
+		// Running stages move on first, so a trigger frame starts at phase 0.
+		const bool eoc_a = advance(envelope_a_, attack_increment, decay_increment);
+		const bool eoc_b = advance(envelope_b_, attack_increment, decay_increment);
+
+		// Triggers: per-channel gate rising edges, manual button, and pulse-in.
+		// An edge between frames starts the attack that far in; with several,
+		// the newest wins.
+		const Frame& f = in[i];
+		uint32_t age_a = kNoTrigger;
+		uint32_t age_b = kNoTrigger;
+		if (button_trigger) age_a = age_b = 0;
+		if (f.pulse & Frame::kPulseRise) {
+			age_a = min_age(age_a, f.pulse_us);
+			age_b = min_age(age_b, f.pulse_us);
+		}
+		if (f.gate & Frame::kGateRiseA) age_a = min_age(age_a, f.gate_rise_age_us[0]);
+		if (f.gate & Frame::kGateRiseB) age_b = min_age(age_b, f.gate_rise_age_us[1]);
+		button_trigger = false;
 
-	if (pulse_triggered_) {
-		trigger_a = true;
-		trigger_b = true;
-		pulse_triggered_ = false;
-	}
+		if (age_a != kNoTrigger) {
+			trigger(envelope_a_, attack_increment, age_a, params.period_us);
+		}
+		if (age_b != kNoTrigger) {
+			trigger(envelope_b_, attack_increment, age_b, params.period_us);
+		}
 
-	if (trigger_a) {
-		trigger_envelope(envelope_a_, now_us, attack_us);
-	}
-	if (trigger_b) {
-		trigger_envelope(envelope_b_, now_us, attack_us);
+		// Unipolar envelope signal (0..+5V) into DAC domain around +5V center.
+		out[i].a = envelope_to_dac(level_q15(envelope_a_, shape_q15));
+		out[i].b = envelope_to_dac(level_q15(envelope_b_, shape_q15));
+		out[i].pulse = (eoc_a || eoc_b) ? Frame::kPulseRise : 0;
+		out[i].pulse_us = (eoc_a || eoc_b) ? kEndOfCyclePulseUs : 0;
 	}
 
-	const bool eoc_a = process_envelope(envelope_a_, now_us, decay_us, shape_q15);
-	const bool eoc_b = process_envelope(envelope_b_, now_us, decay_us, shape_q15);
-	pulse.set(eoc_a || eoc_b);
-
-	// Clamp and convert unipolar envelope signal (0..+5V) into DAC domain around +5V center.
-	envelope_a_.envelope_q15 = fixed_point::clamp_i32(envelope_a_.envelope_q15, 0, kQ15One);
-	envelope_b_.envelope_q15 = fixed_point::clamp_i32(envelope_b_.envelope_q15, 0, kQ15One);
-	const float envelope_a_signal_v = static_cast<float>(envelope_a_.envelope_q15) *
-									  kEnvelopePeakSignalV / static_cast<float>(kQ15One);
-	const float envelope_b_signal_v = static_cast<float>(envelope_b_.envelope_q15) *
-									  kEnvelopePeakSignalV / static_cast<float>(kQ15One);
-	float out_a_voltage = envelope_a_signal_v + kCenterVoltageV;
-	float out_b_voltage = envelope_b_signal_v + kCenterVoltageV;
-	if (out_a_voltage < 0.0f) out_a_voltage = 0.0f;
-	if (out_a_voltage > kMaxDacVoltageV) out_a_voltage = kMaxDacVoltageV;
-	if (out_b_voltage < 0.0f) out_b_voltage = 0.0f;
-	if (out_b_voltage > kMaxDacVoltageV) out_b_voltage = kMaxDacVoltageV;
-
-	cv_out.set_voltage(brain::io::AudioCvOutChannel::kChannelA, out_a_voltage);
-	cv_out.set_voltage(brain::io::AudioCvOutChannel::kChannelB, out_b_voltage);
-	led_controller.render_output_vu(leds, out_a_voltage, out_b_voltage);
+	if (n > 0) {
+		out_a_code_ = out[n - 1].a;
+		out_b_code_ = out[n - 1].b;
+	}
 }
 
-uint32_t AdEnvelope::pot_to_time_us(uint8_t pot_value) {
-	if (pot_value == 0) return kMinTimeUs;
-	// Cubic log curve: x^3 mapped to kMinTimeUs..kMaxTimeUs
-	uint32_t x = static_cast<uint32_t>(pot_value);
-	// x^3 / 255^3 * range + min
-	// Use 64-bit to avoid overflow: (x*x*x) can be up to 255^3 = 16581375
-	uint64_t cubed = static_cast<uint64_t>(x) * x * x;
-	uint64_t max_cubed = 255ULL * 255 * 255;
-	return static_cast<uint32_t>(kMinTimeUs + (cubed * (kMaxTimeUs - kMinTimeUs)) / max_cubed);
+void AdEnvelope::render_leds(hal::Leds& leds, const LedController& led_controller) const {
+	led_controller.render_output_vu(leds, out_a_code_, out_b_code_);
 }
 
-int32_t AdEnvelope::apply_shape(int32_t linear_pos_q15, uint16_t shape_q15, bool is_attack) {
-	// Linear component: just the position as-is
-	// Exponential component: for attack, curve upward (slow start, fast end)
-	//                        for decay, curve downward (fast start, slow end)
-	// Approximate exponential with x^2 (cheaper than real exp)
-
-	int32_t exp_pos_q15;
-	if (is_attack) {
-		// Exponential attack: x^2 (slow start, fast finish)
-		exp_pos_q15 = fixed_point::mul_q15(linear_pos_q15,
-										   static_cast<uint16_t>(linear_pos_q15));
-	} else {
-		// Exponential decay: 1 - (1-x)^2 (fast start, slow finish)
-		int32_t inv = kQ15One - linear_pos_q15;
-		int32_t inv_sq = fixed_point::mul_q15(inv, static_cast<uint16_t>(inv));
-		exp_pos_q15 = kQ15One - inv_sq;
-	}
-
-	// Blend linear and exponential based on shape pot
-	return fixed_point::blend_q15(linear_pos_q15, exp_pos_q15, shape_q15);
+void AdEnvelope::trigger(EnvelopeState& state, uint32_t attack_increment, uint32_t age_us,
+						 uint32_t period_us) {
+	state.stage = Stage::kAttack;
+	state.phase = 0;
+	if (age_us == 0 || period_us == 0) return;
+	// The attack's progress since the edge; one 64-bit divide per trigger.
+	const uint64_t phase = (static_cast<uint64_t>(attack_increment) * age_us) / period_us;
+	state.phase = phase >= kPhaseOne ? kPhaseOne - 1 : static_cast<uint32_t>(phase);
 }
 
-void AdEnvelope::trigger_envelope(EnvelopeState& state, uint32_t now_us, uint32_t attack_us) {
-	state.stage = Stage::kAttack;
-	state.stage_start_us = now_us;
-	state.stage_duration_us = attack_us;
+uint32_t AdEnvelope::phase_increment(uint32_t period_us, uint32_t stage_us) {
+	// Rounded up, so the stage ends on the first frame at or after stage_us.
+	const uint64_t increment =
+		((static_cast<uint64_t>(period_us) << 31) + stage_us - 1) / stage_us;
+	return increment > kPhaseOne ? kPhaseOne : static_cast<uint32_t>(increment);
 }
 
-bool AdEnvelope::process_envelope(EnvelopeState& state, uint32_t now_us, uint32_t decay_us,
-								  uint16_t shape_q15) {
+bool AdEnvelope::advance(EnvelopeState& state, uint32_t attack_increment,
+						 uint32_t decay_increment) {
 	switch (state.stage) {
 		case Stage::kIdle:
-			state.envelope_q15 = 0;
 			return false;
 
-		case Stage::kAttack: {
-			uint32_t elapsed_us = now_us - state.stage_start_us;
-			if (elapsed_us >= state.stage_duration_us) {
-				// Attack complete, transition to decay.
-				state.envelope_q15 = kQ15One;
+		case Stage::kAttack:
+			state.phase += attack_increment;
+			if (state.phase >= kPhaseOne) {
+				// Attack complete: decay starts from the peak.
 				state.stage = Stage::kDecay;
-				state.stage_start_us = now_us;
-				state.stage_duration_us = decay_us;
-			} else {
-				int32_t linear_q15 = static_cast<int32_t>(
-					(static_cast<int64_t>(elapsed_us) * kQ15One) / state.stage_duration_us);
-				state.envelope_q15 = apply_shape(linear_q15, shape_q15, true);
+				state.phase = 0;
 			}
 			return false;
-		}
 
-		case Stage::kDecay: {
-			uint32_t elapsed_us = now_us - state.stage_start_us;
-			if (elapsed_us >= state.stage_duration_us) {
-				// Decay complete, back to idle.
-				state.envelope_q15 = 0;
+		case Stage::kDecay:
+			state.phase += decay_increment;
+			if (state.phase >= kPhaseOne) {
 				state.stage = Stage::kIdle;
+				state.phase = 0;
 				return true;
 			}
-			int32_t linear_q15 = kQ15One - static_cast<int32_t>(
-				(static_cast<int64_t>(elapsed_us) * kQ15One) / state.stage_duration_us);
-			state.envelope_q15 = apply_shape(linear_q15, shape_q15, false);
 			return false;
-		}
 	}
 	return false;
 }
+
+int32_t AdEnvelope::level_q15(const EnvelopeState& state, uint16_t shape_q15) {
+	if (state.stage == Stage::kIdle) return 0;
+
+	// Stage position 0..1 in Q15, and the RC curve's exp(-t/tau) at it.
+	const uint32_t position_q15 = state.phase >> 16;
+	const int32_t decay_q15 = exp_table::exp_neg_q15((position_q15 * kCurveTimeConstants) << 1);
+
+	int32_t linear_q15;
+	int32_t curve_q15;
+	if (state.stage == Stage::kAttack) {
+		// RC charge: fast start, easing into the peak.
+		linear_q15 = static_cast<int32_t>(position_q15);
+		curve_q15 = static_cast<int32_t>(
+			(static_cast<uint32_t>(kQ15One - decay_q15) * kCurveGainQ16) >> 16);
+	} else {
+		// RC discharge: fast drop, long tail.
+		linear_q15 = kQ15One - static_cast<int32_t>(position_q15);
+		curve_q15 = static_cast<int32_t>(
+			(static_cast<uint32_t>(decay_q15 - kCurveEndQ15) * kCurveGainQ16) >> 16);
+	}
+	// Both segments are Q15 near 0..1, well inside the narrow blend's range.
+	return fixed_point::clamp_i32(fixed_point::blend_q15_narrow(linear_q15, curve_q15, shape_q15),
+								  0, kQ15One);
+}
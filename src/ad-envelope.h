@@ -3,23 +3,17 @@
 
 #include <cstdint>
 
-#include "calibration.h"
+#include "frame.h"
+#include "hal.h"
 #include "led-controller.h"
-#include "brain-io/audio-cv-in.h"
-#include "brain-io/audio-cv-out.h"
-#include "brain-io/pulse.h"
-#include "brain-ui/leds.h"
-#include "brain-ui/pots.h"
 
 class AdEnvelope {
 public:
 	AdEnvelope();
 
-	void init(brain::io::Pulse& pulse);
-	void update(brain::ui::Pots& pots, brain::io::AudioCvIn& cv_in,
-				brain::io::AudioCvOut& cv_out, brain::io::Pulse& pulse,
-				Calibration& calibration, bool button_b_pressed,
-				brain::ui::Leds& leds, LedController& led_controller);
+	// Pulse out fires a kEndOfCyclePulseUs trigger at end of cycle.
+	void process(const BlockParams& params, const Frame* in, Frame* out, size_t n);
+	void render_leds(hal::Leds& leds, const LedController& led_controller) const;
 
 private:
 	enum class Stage : uint8_t {
@@ -27,12 +21,11 @@ private:
 		kAttack,
 		kDecay
 	};
+	// Stage progress is a phase accumulator: kPhaseOne is the end of the
+	// stage, and each frame adds the stage's increment.
 	struct EnvelopeState {
 		Stage stage;
-		int32_t envelope_q15;
-		uint32_t stage_start_us;
-		uint32_t stage_duration_us;
-		bool gate_prev_high;
+		uint32_t phase;
 	};
 
 	static constexpr uint8_t kPotAttack = 0;
@@ -42,27 +35,39 @@ private:
 	// Envelope output in Q15 fixed-point signal domain (0 = 0V, kQ15One = +5V)
 	static constexpr int32_t kQ15One = 32768;
 
-	// Max envelope time ~5 seconds in microseconds
-	static constexpr uint32_t kMaxTimeUs = 5000000;
+	static constexpr uint32_t kPhaseOne = 1u << 31;
+	static constexpr uint16_t kEndOfCyclePulseUs = 5000;
+	static constexpr uint32_t kNoTrigger = UINT32_MAX;
 
-	// Minimum time to avoid division by zero (~1ms)
-	static constexpr uint32_t kMinTimeUs = 1000;
+	static uint32_t min_age(uint32_t a, uint32_t b) { return a < b ? a : b; }
 
-	// Convert pot value (0-255) to time in microseconds (logarithmic)
-	static uint32_t pot_to_time_us(uint8_t pot_value);
-
-	// Apply shape curve to linear position (0..kQ15One)
-	// shape_q15: 0 = linear, kQ15One = exponential
-	static int32_t apply_shape(int32_t linear_pos_q15, uint16_t shape_q15, bool is_attack);
-	static void trigger_envelope(EnvelopeState& state, uint32_t now_us, uint32_t attack_us);
-	static bool process_envelope(EnvelopeState& state, uint32_t now_us, uint32_t decay_us,
-								 uint16_t shape_q15);
+	// Phase added per frame for a stage of `stage_us` at a frame period of
+	// `period_us`. One 64-bit divide, only when a pot or the period changes.
+	static uint32_t phase_increment(uint32_t period_us, uint32_t stage_us);
+	// Start the attack from an edge `age_us` before the frame.
+	static void trigger(EnvelopeState& state, uint32_t attack_increment, uint32_t age_us,
+						uint32_t period_us);
+	// Advance one frame; moves to the next stage at the end of one. Returns
+	// true when decay completes (end of cycle).
+	static bool advance(EnvelopeState& state, uint32_t attack_increment,
+						uint32_t decay_increment);
+	// Envelope level for the current stage and phase.
+	// shape_q15: 0 = linear, kQ15One = exponential (RC charge/discharge)
+	static int32_t level_q15(const EnvelopeState& state, uint16_t shape_q15);
 
 	// State
 	EnvelopeState envelope_a_;
 	EnvelopeState envelope_b_;
 	bool button_b_prev_;
-	bool pulse_triggered_;
+	uint16_t out_a_code_;
+	uint16_t out_b_code_;
+
+	// Pot-derived parameters
+	PotWatch pot_watch_;
+	uint16_t shape_q15_;
+	uint32_t increment_period_us_;
+	uint32_t attack_increment_;
+	uint32_t decay_increment_;
 };
 
 #endif  // AD_ENVELOPE_H_
@@ -0,0 +1,112 @@
+#ifndef ADAPTIVE_SMOOTHER_H_
+#define ADAPTIVE_SMOOTHER_H_
+
+#include <cstdint>
+
+// One-pole smoother whose cutoff rises with the signal's speed (the
+// "one euro" filter). A held voltage sees only the minimum cutoff, so input
+// noise is averaged away; a jump drives the cutoff up to near pass-through, so
+// it arrives within a millisecond. There is no deadband: any held value is
+// reached exactly.
+//
+// Per frame: the speed is the distance from the output to the input, low-pass
+// filtered at the derivative cutoff; the cutoff is
+//   min_cutoff + speed_gain * |speed|
+// and the output moves alpha = w / (1 + w) of the way, with w = 2 pi cutoff T.
+// Values are millivolts within +-16 V, kept in Q16.
+class AdaptiveSmoother {
+public:
+	// min_cutoff_millihz, derivative_cutoff_millihz: in mHz.
+	// speed_gain: mHz of cutoff added per mV/s of speed.
+	constexpr AdaptiveSmoother(uint32_t min_cutoff_millihz, uint32_t speed_gain,
+							   uint32_t derivative_cutoff_millihz)
+		: min_cutoff_millihz_(min_cutoff_millihz),
+		  derivative_cutoff_millihz_(derivative_cutoff_millihz),
+		  // 2 pi * speed_gain / 1000 per mV per frame: T cancels out.
+		  speed_w_q16_(static_cast<uint32_t>(
+			  (static_cast<uint64_t>(kTwoPiQ16) * speed_gain + 500) / 1000)) {}
+
+	// Frame period; coefficients are recomputed only when it changes.
+	void set_period_us(uint32_t period_us) {
+		if (period_us == period_us_) return;
+		period_us_ = period_us;
+		min_w_q16_ = w_q16(min_cutoff_millihz_, period_us);
+		derivative_alpha_q16_ = alpha_q16(w_q16(derivative_cutoff_millihz_, period_us));
+	}
+
+	void reset(int32_t value_mv) {
+		output_q16_ = clamp_mv(value_mv) << 16;
+		speed_q16_ = 0;
+		initialized_ = true;
+	}
+
+	int32_t process(int32_t target_mv) {
+		return (process_q16(clamp_mv(target_mv) << 16) + (1 << 15)) >> 16;
+	}
+
+	// process() in Q16 millivolts, for callers that keep the fraction.
+	int32_t process_q16(int32_t target_q16) {
+		target_q16 = clamp_q16(target_q16);
+		if (!initialized_) {
+			output_q16_ = target_q16;
+			speed_q16_ = 0;
+			initialized_ = true;
+			return output_q16_;
+		}
+
+		const int32_t diff_q16 = target_q16 - output_q16_;
+		speed_q16_ += static_cast<int32_t>(
+			((static_cast<int64_t>(diff_q16) - speed_q16_) * derivative_alpha_q16_) >> 16);
+
+		const uint32_t abs_speed_q16 =
+			static_cast<uint32_t>(speed_q16_ < 0 ? -static_cast<int64_t>(speed_q16_) : speed_q16_);
+		uint64_t w = min_w_q16_ + ((static_cast<uint64_t>(abs_speed_q16) * speed_w_q16_) >> 16);
+		if (w > kMaxWQ16) w = kMaxWQ16;
+
+		output_q16_ += static_cast<int32_t>(
+			(static_cast<int64_t>(diff_q16) * alpha_q16(static_cast<uint32_t>(w))) >> 16);
+		return output_q16_;
+	}
+
+private:
+	static constexpr int32_t kMaxAbsMv = 16000;
+	static constexpr uint32_t kOneQ16 = 1u << 16;
+	static constexpr uint32_t kTwoPiQ16 = 411775;  // 2 pi in Q16
+	// w = 4 (alpha 0.8) is already near pass-through; the cap keeps the
+	// alpha division in 32 bits.
+	static constexpr uint32_t kMaxWQ16 = 4 * kOneQ16;
+
+	static int32_t clamp_mv(int32_t mv) {
+		return mv < -kMaxAbsMv ? -kMaxAbsMv : (mv > kMaxAbsMv ? kMaxAbsMv : mv);
+	}
+
+	static int32_t clamp_q16(int32_t q16) {
+		constexpr int32_t kMaxAbsQ16 = kMaxAbsMv << 16;
+		return q16 < -kMaxAbsQ16 ? -kMaxAbsQ16 : (q16 > kMaxAbsQ16 ? kMaxAbsQ16 : q16);
+	}
+
+	// 2 pi f T in Q16, capped.
+	static uint32_t w_q16(uint32_t cutoff_millihz, uint32_t period_us) {
+		const uint64_t w = (static_cast<uint64_t>(kTwoPiQ16) * cutoff_millihz * period_us +
+							500000000u) /
+						   1000000000u;
+		return static_cast<uint32_t>(w > kMaxWQ16 ? kMaxWQ16 : w);
+	}
+
+	// w / (1 + w) = 1 - 1 / (1 + w): one 32-bit divide.
+	static uint32_t alpha_q16(uint32_t w_q16) {
+		return kOneQ16 - 0xFFFFFFFFu / (kOneQ16 + w_q16);
+	}
+
+	uint32_t min_cutoff_millihz_;
+	uint32_t derivative_cutoff_millihz_;
+	uint32_t speed_w_q16_;
+	uint32_t period_us_ = 0;
+	uint32_t min_w_q16_ = 0;
+	uint32_t derivative_alpha_q16_ = kOneQ16;
+	int32_t output_q16_ = 0;
+	int32_t speed_q16_ = 0;  // mV per frame, Q16
+	bool initialized_ = false;
+};
+
+#endif  // ADAPTIVE_SMOOTHER_H_
@@ -1,39 +1,56 @@
 #include "attenuverter.h"
 
+#include "fixed-point.h"
+
 namespace {
-int16_t clamp16(int16_t v, int16_t lo, int16_t hi) {
-	return v < lo ? lo : (v > hi ? hi : v);
+constexpr int32_t kFullScaleMvQ16 = cv_units::kDacFullScaleMv << 16;
+constexpr int32_t kCenterMvQ16 = cv_units::kCenterMv << 16;
+// One DC offset pot step: 16 DAC codes, in Q16 millivolts.
+constexpr int32_t kOffsetStepMvQ16 =
+	static_cast<int32_t>((int64_t{16} * cv_units::kDacFullScaleMv << 16) / cv_units::kDacMax);
+
+// Output in Q16 millivolts (0..10 V) -> nearest whole DAC code.
+int16_t to_code(int32_t mv_q16) {
+	const int32_t clamped = fixed_point::clamp_i32(mv_q16, 0, kFullScaleMvQ16);
+	return static_cast<int16_t>((cv_units::mv_q16_to_code_q8(clamped) + 128) >> 8);
 }
+}  // namespace
+
+void Attenuverter::process(const BlockParams& params, const Frame* in, Frame* out,
+						   size_t n) {
+	const ControlSnapshot& controls = params.controls;
+	// Pots: 0-255, inputs: mV, outputs: Q16 mV until the final conversion.
+
+	// Attenuation: pot 0 → -256, pot 128 → 0, pot 255 → +254 (in 1/256)
+	const int32_t atten_ch1 = (static_cast<int32_t>(controls.pots[kPotAttenCh1]) - 128) * 2;
+	const int32_t atten_ch2 = (static_cast<int32_t>(controls.pots[kPotAttenCh2]) - 128) * 2;
+
+	// Output center plus DC offset: pot 0 → -2048 codes, pot 128 → 0, pot 255 → +2032
+	const int32_t center_q16 =
+		kCenterMvQ16 +
+		(static_cast<int32_t>(controls.pots[kPotDcOffset]) - 128) * kOffsetStepMvQ16;
+
+	for (size_t i = 0; i < n; ++i) {
+		// in * atten / 256 in Q16 is in * atten << 8. Inputs are clamped well
+		// beyond what the ADC reads so the product stays in 32 bits.
+		const int32_t in_ch1 = fixed_point::clamp_i32(in[i].a, -cv_units::kDacFullScaleMv,
+													  cv_units::kDacFullScaleMv);
+		const int32_t in_ch2 = fixed_point::clamp_i32(in[i].b, -cv_units::kDacFullScaleMv,
+													  cv_units::kDacFullScaleMv);
+		out[i].a = to_code(center_q16 + ((in_ch1 * atten_ch1) << 8));
+		out[i].b = to_code(center_q16 + ((in_ch2 * atten_ch2) << 8));
+		out[i].pulse = 0;
+		out[i].pulse_us = 0;
+		out[i].code_frac[0] = 0;
+		out[i].code_frac[1] = 0;
+	}
+
+	if (n > 0) {
+		out_a_code_ = out[n - 1].a;
+		out_b_code_ = out[n - 1].b;
+	}
 }
 
-void Attenuverter::update(brain::ui::Pots& pots, brain::io::AudioCvIn& cv_in,
-						  brain::io::AudioCvOut& cv_out, brain::ui::Leds& leds,
-						  LedController& led_controller) {
-	// Pots: 0-255, ADC/DAC: 0-4095
-
-	// Attenuation: pot 0 → -256, pot 128 → 0, pot 255 → +254
-	int16_t atten_ch1 = (static_cast<int16_t>(pots.get(kPotAttenCh1)) - 128) * 2;
-	int16_t atten_ch2 = (static_cast<int16_t>(pots.get(kPotAttenCh2)) - 128) * 2;
-
-	// DC offset as DAC units: pot 0 → -2048, pot 128 → 0, pot 255 → +2047
-	int16_t dc_offset = (static_cast<int16_t>(pots.get(kPotDcOffset)) - 128) * 16;
-
-	// CV input as signed: raw 0-4095 → signed -2048 to +2047
-	int16_t in_ch1 = static_cast<int16_t>(cv_in.get_raw_channel_a()) - kDacCenter;
-	int16_t in_ch2 = static_cast<int16_t>(cv_in.get_raw_channel_b()) - kDacCenter;
-
-	// Attenuate and shift to unsigned DAC range
-	// (in * atten) / 256 keeps result in ~12-bit range, then add center + offset
-	int16_t out_ch1 = static_cast<int16_t>((in_ch1 * atten_ch1) / 256) + kDacCenter + dc_offset;
-	int16_t out_ch2 = static_cast<int16_t>((in_ch2 * atten_ch2) / 256) + kDacCenter + dc_offset;
-
-	// Clamp to DAC range
-	const uint16_t dac_ch1 = static_cast<uint16_t>(clamp16(out_ch1, 0, kDacMax));
-	const uint16_t dac_ch2 = static_cast<uint16_t>(clamp16(out_ch2, 0, kDacMax));
-
-	const float out_a_voltage = static_cast<float>(dac_ch1) * 10.0f / kDacMax;
-	const float out_b_voltage = static_cast<float>(dac_ch2) * 10.0f / kDacMax;
-	cv_out.set_voltage(brain::io::AudioCvOutChannel::kChannelA, out_a_voltage);
-	cv_out.set_voltage(brain::io::AudioCvOutChannel::kChannelB, out_b_voltage);
-	led_controller.render_output_vu(leds, out_a_voltage, out_b_voltage);
+void Attenuverter::render_leds(hal::Leds& leds, const LedController& led_controller) const {
+	led_controller.render_output_vu(leds, out_a_code_, out_b_code_);
 }
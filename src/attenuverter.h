@@ -3,24 +3,23 @@
 
 #include <cstdint>
 
-#include "brain-io/audio-cv-in.h"
-#include "brain-io/audio-cv-out.h"
-#include "brain-ui/leds.h"
-#include "brain-ui/pots.h"
+#include "cv-units.h"
+#include "frame.h"
+#include "hal.h"
 #include "led-controller.h"
 
 class Attenuverter {
 public:
-	void update(brain::ui::Pots& pots, brain::io::AudioCvIn& cv_in,
-				brain::io::AudioCvOut& cv_out, brain::ui::Leds& leds,
-				LedController& led_controller);
+	void process(const BlockParams& params, const Frame* in, Frame* out, size_t n);
+	void render_leds(hal::Leds& leds, const LedController& led_controller) const;
 
 private:
 	static constexpr uint8_t kPotAttenCh1 = 0;
 	static constexpr uint8_t kPotAttenCh2 = 1;
 	static constexpr uint8_t kPotDcOffset = 2;
-	static constexpr uint16_t kDacMax = 4095;
-	static constexpr uint16_t kDacCenter = 2048;
+
+	uint16_t out_a_code_ = cv_units::kDacCenter;
+	uint16_t out_b_code_ = cv_units::kDacCenter;
 };
 
 #endif  // ATTENUVERTER_H_
@@ -1,11 +1,10 @@
 #include "calibration.h"
 
-#include <cstring>
+#include "cv-units.h"
+#include "trace.h"
 
 #include "hardware/flash.h"
 #include "hardware/regs/addressmap.h"
-#include "hardware/sync.h"
-#include "pico/time.h"
 
 namespace {
 
@@ -13,13 +12,31 @@ int16_t clamp16(int16_t v, int16_t lo, int16_t hi) {
 	return v < lo ? lo : (v > hi ? hi : v);
 }
 
+// Legacy layout: one record at the start of the last flash sector, which
+// older firmware erased and rewrote on every save. Read once to migrate.
 constexpr uint32_t kMagic = 0x5043414C;  // "PCAL"
 constexpr uint16_t kVersion = 3;          // v3: separate offset A/B
-constexpr uint32_t kFlashOffset = PICO_FLASH_SIZE_BYTES - FLASH_SECTOR_SIZE;
+constexpr uint32_t kLegacyFlashOffset = PICO_FLASH_SIZE_BYTES - FLASH_SECTOR_SIZE;
+constexpr int32_t kGainScale = 10000;     // gain trims: 1/10000 units
 
 // Blink period in microseconds (500ms on, 500ms off)
 constexpr uint32_t kBlinkPeriodUs = 500000;
+constexpr uint32_t kFastBlinkPeriodUs = 100000;
 
+constexpr uint8_t kNumChannels = OutputCalibration::kNumChannels;
+constexpr uint8_t kNumPoints = OutputCalibration::kNumPoints;
+
+// Settings store records
+struct CalibrationRecord {
+	int16_t corrections[OutputCalibration::kNumChannels][OutputCalibration::kNumPoints];
+};
+
+struct InputCalibrationRecord {
+	InputCalibration::Endpoints endpoints[InputCalibration::kNumChannels];
+};
+
+// One gain and offset trim per output. v1 holds only the gains, followed by
+// a checksum where v3 has the offsets; older firmware never checked it.
 struct CalibrationStorage {
 	uint32_t magic;
 	uint16_t version;
@@ -42,75 +59,195 @@ uint16_t compute_checksum(const CalibrationStorage& d) {
 	return static_cast<uint16_t>(sum & 0xFFFFu);
 }
 
-int16_t pot_to_gain_trim(uint8_t pot_value, int16_t min_val, int16_t max_val) {
+int16_t pot_to_correction(uint8_t pot_value, int16_t min_val, int16_t max_val) {
 	int32_t span = static_cast<int32_t>(max_val - min_val);
 	return static_cast<int16_t>(min_val + (static_cast<int32_t>(pot_value) * span + 127) / 255);
 }
 
-int16_t pot_to_offset_trim(uint8_t pot_value, int16_t min_val, int16_t max_val) {
-	int32_t span = static_cast<int32_t>(max_val - min_val);
-	return static_cast<int16_t>(min_val + (static_cast<int32_t>(pot_value) * span + 127) / 255);
+uint8_t pot_to_point(uint8_t pot_value) {
+	return static_cast<uint8_t>((static_cast<uint32_t>(pot_value) * kNumPoints) / 256);
 }
 
 }  // namespace
 
 Calibration::Calibration()
-	: gain_trim_a_(0),
-	  gain_trim_b_(0),
-	  offset_trim_a_(0),
-	  offset_trim_b_(0),
-	  blink_timer_(0) {}
+	: store_(nullptr),
+	  selected_point_(0),
+	  blink_timer_(0),
+	  capture_stage_(CaptureStage::kIdle),
+	  capture_stage_started_us_(0),
+	  capture_next_pair_(0),
+	  capture_count_(0),
+	  capture_sum_q4_{},
+	  capture_high_q4_{},
+	  capture_failed_until_us_(0) {}
 
-void Calibration::init() {
+void Calibration::init(FlashStore& store) {
+	store_ = &store;
 	load_from_flash();
 }
 
-void Calibration::update_from_pots(brain::ui::Pots& pots,
-								   bool button_a_held, bool button_b_held) {
-	if (button_a_held) {
-		// Hold A + Pot 3 → offset A
-		offset_trim_a_ = pot_to_offset_trim(pots.get(2), kOffsetTrimMin, kOffsetTrimMax);
-	} else if (button_b_held) {
-		// Hold B + Pot 3 → offset B
-		offset_trim_b_ = pot_to_offset_trim(pots.get(2), kOffsetTrimMin, kOffsetTrimMax);
-	} else {
-		// No button held: Pot 1 = scale A, Pot 2 = scale B
-		gain_trim_a_ = pot_to_gain_trim(pots.get(0), kGainTrimMin, kGainTrimMax);
-		gain_trim_b_ = pot_to_gain_trim(pots.get(1), kGainTrimMin, kGainTrimMax);
+uint8_t Calibration::output_point() const {
+	switch (capture_stage_) {
+		case CaptureStage::kSettleHigh:
+		case CaptureStage::kMeasureHigh:
+			return kCapturePointHigh;
+		case CaptureStage::kSettleLow:
+		case CaptureStage::kMeasureLow:
+			return kCapturePointLow;
+		case CaptureStage::kIdle:
+			break;
 	}
+	return selected_point_;
 }
 
-void Calibration::save() {
-	save_to_flash();
+void Calibration::begin(const ControlSnapshot& controls) {
+	pot_watch_ = PotWatch();
+	pot_watch_.changed(controls, kPotPoint);
+	pot_watch_.changed(controls, kPotCorrectionA);
+	pot_watch_.changed(controls, kPotCorrectionB);
+	selected_point_ = pot_to_point(controls.pots[kPotPoint]);
 }
 
-void Calibration::process_passthrough(brain::io::AudioCvIn& cv_in,
-									  brain::io::AudioCvOut& cv_out) const {
-	const float in_a = cv_in.get_voltage_channel_a();
-	const float in_b = cv_in.get_voltage_channel_b();
+void Calibration::update_from_pots(const ControlSnapshot& controls) {
+	if (pot_watch_.changed(controls, kPotPoint)) {
+		selected_point_ = pot_to_point(controls.pots[kPotPoint]);
+	}
+	if (pot_watch_.changed(controls, kPotCorrectionA)) {
+		output_.set_correction(
+			OutputCalibration::kChannelA, selected_point_,
+			pot_to_correction(controls.pots[kPotCorrectionA], kCorrectionMin, kCorrectionMax));
+		output_.rebuild(OutputCalibration::kChannelA);
+	}
+	if (pot_watch_.changed(controls, kPotCorrectionB)) {
+		output_.set_correction(
+			OutputCalibration::kChannelB, selected_point_,
+			pot_to_correction(controls.pots[kPotCorrectionB], kCorrectionMin, kCorrectionMax));
+		output_.rebuild(OutputCalibration::kChannelB);
+	}
+}
+
+bool Calibration::save() {
+	return save_to_flash();
+}
 
-	constexpr float kDacMax = 4095.0f;
-	constexpr float kOffsetTrimToVolts = 10.0f / kDacMax;
+void Calibration::start_input_capture(uint32_t now_us) {
+	capture_stage_ = CaptureStage::kSettleHigh;
+	capture_stage_started_us_ = now_us;
+	capture_failed_until_us_ = now_us;
+}
 
-	// Direct voltage passthrough with trim correction.
-	float out_a = in_a * static_cast<float>(kCalibScale + gain_trim_a_) /
-				  static_cast<float>(kCalibScale);
-	float out_b = in_b * static_cast<float>(kCalibScale + gain_trim_b_) /
-				  static_cast<float>(kCalibScale);
-	out_a += static_cast<float>(offset_trim_a_) * kOffsetTrimToVolts;
-	out_b += static_cast<float>(offset_trim_b_) * kOffsetTrimToVolts;
+void Calibration::update_input_capture(const CvInCapture& capture, uint32_t now_us) {
+	switch (capture_stage_) {
+		case CaptureStage::kIdle:
+			return;
+		case CaptureStage::kSettleHigh:
+		case CaptureStage::kSettleLow:
+			// Let the output and the input filter settle on the new level.
+			if (now_us - capture_stage_started_us_ < kCaptureSettleUs) return;
+			capture_stage_ = capture_stage_ == CaptureStage::kSettleHigh
+								 ? CaptureStage::kMeasureHigh
+								 : CaptureStage::kMeasureLow;
+			capture_next_pair_ = capture.pairs_captured();
+			capture_count_ = 0;
+			for (int32_t& sum : capture_sum_q4_) sum = 0;
+			return;
+		case CaptureStage::kMeasureHigh:
+		case CaptureStage::kMeasureLow:
+			break;
+	}
 
-	out_a = out_a < 0.0f ? 0.0f : (out_a > 10.0f ? 10.0f : out_a);
-	out_b = out_b < 0.0f ? 0.0f : (out_b > 10.0f ? 10.0f : out_b);
+	// Average the linearized readings, so dither across a wide code is
+	// weighted by where the code really sits.
+	CvInCapture::Sample samples[kCaptureChunk];
+	while (capture_count_ < kCapturePairs) {
+		const CvInCapture::Progress progress = capture.progress();
+		// Every pot scan pauses capture, and the slots of the pairs due
+		// meanwhile still hold older data, possibly the other reference
+		// level. Reading picks up again at the first pair of the new run.
+		if (static_cast<int32_t>(capture_next_pair_ - progress.run_start_pair) < 0) {
+			capture_next_pair_ = progress.run_start_pair;
+		}
+		const uint32_t available = progress.pairs - capture_next_pair_;
+		if (available == 0) return;
+		if (available > CvInCapture::kRingPairs - 1) {
+			// Fell behind the ring: continue from a chunk before the newest
+			// pair, which stays readable however long the UI loop takes.
+			capture_next_pair_ = progress.pairs - kCaptureChunk;
+			continue;
+		}
+		uint32_t count = available < kCaptureChunk ? available : kCaptureChunk;
+		if (count > kCapturePairs - capture_count_) count = kCapturePairs - capture_count_;
+		// Fails only if a resume raced the copy; the next lap sees the new run.
+		if (!capture.read_block(capture_next_pair_, samples, count)) continue;
+		for (uint32_t i = 0; i < count; ++i) {
+			capture_sum_q4_[InputCalibration::kChannelA] +=
+				InputCalibration::linearize_q4(samples[i].raw_a);
+			capture_sum_q4_[InputCalibration::kChannelB] +=
+				InputCalibration::linearize_q4(samples[i].raw_b);
+		}
+		capture_next_pair_ += count;
+		capture_count_ += count;
+	}
 
-	cv_out.set_voltage(brain::io::AudioCvOutChannel::kChannelA, out_a);
-	cv_out.set_voltage(brain::io::AudioCvOutChannel::kChannelB, out_b);
+	int32_t mean_q4[InputCalibration::kNumChannels];
+	for (uint8_t channel = 0; channel < InputCalibration::kNumChannels; ++channel) {
+		mean_q4[channel] = static_cast<int32_t>(
+			(capture_sum_q4_[channel] + static_cast<int32_t>(kCapturePairs / 2)) /
+			static_cast<int32_t>(kCapturePairs));
+	}
+	if (capture_stage_ == CaptureStage::kMeasureHigh) {
+		for (uint8_t channel = 0; channel < InputCalibration::kNumChannels; ++channel) {
+			capture_high_q4_[channel] = mean_q4[channel];
+		}
+		capture_stage_ = CaptureStage::kSettleLow;
+		capture_stage_started_us_ = now_us;
+		return;
+	}
+	finish_input_capture(mean_q4, now_us);
 }
 
-void Calibration::update_leds(brain::ui::Leds& leds) {
+void Calibration::finish_input_capture(const int32_t* low_q4, uint32_t now_us) {
+	capture_stage_ = CaptureStage::kIdle;
+
+	// Both channels or neither: a half-patched loopback should not leave one
+	// input on a bad line.
+	InputCalibration::Endpoints fitted[InputCalibration::kNumChannels];
+	bool ok = true;
+	for (uint8_t channel = 0; channel < InputCalibration::kNumChannels; ++channel) {
+		const bool channel_ok =
+			InputCalibration::fit(kCaptureLowMv, low_q4[channel], kCaptureHighMv,
+								  capture_high_q4_[channel], fitted[channel]) &&
+			InputCalibration::plausible(fitted[channel]);
+		trace::ui.write(now_us, trace::Event::kInputCalibration, channel,
+						fitted[channel].minus_q4, fitted[channel].plus_q4, channel_ok);
+		ok = ok && channel_ok;
+	}
+
+	if (ok) {
+		for (uint8_t channel = 0; channel < InputCalibration::kNumChannels; ++channel) {
+			input_.set_endpoints(channel, fitted[channel]);
+		}
+		ok = save_input();
+	}
+	if (!ok) capture_failed_until_us_ = now_us + kCaptureFailedShowUs;
+}
+
+void Calibration::process_reference(uint8_t point, const OutputCalibration& output,
+									hal::CvOut& cv_out) {
+	const uint16_t code = OutputCalibration::point_code(point);
+	cv_out.stage(hal::CvOutChannel::kChannelA, output.apply(OutputCalibration::kChannelA, code));
+	cv_out.stage(hal::CvOutChannel::kChannelB, output.apply(OutputCalibration::kChannelB, code));
+}
+
+void Calibration::update_leds(hal::Leds& leds, uint32_t now_us) {
 	// Blink all LEDs
-	uint32_t now = time_us_32();
-	uint32_t phase = (now / kBlinkPeriodUs) % 2;
+	uint32_t phase = (now_us / kBlinkPeriodUs) % 2;
+	if (input_capture_active()) {
+		phase = 0;
+	} else if (static_cast<int32_t>(now_us - capture_failed_until_us_) < 0) {
+		phase = (now_us / kFastBlinkPeriodUs) % 2;
+	}
 
 	for (uint8_t i = 0; i < 6; i++) {
 		if (phase == 0) {
@@ -122,64 +259,75 @@ void Calibration::update_leds(brain::ui::Leds& leds) {
 }
 
 void Calibration::load_from_flash() {
-	const auto* data =
-		reinterpret_cast<const CalibrationStorage*>(XIP_BASE + kFlashOffset);
-
-	if (data->magic != kMagic) {
-		gain_trim_a_ = 0;
-		gain_trim_b_ = 0;
-		offset_trim_a_ = 0;
-		offset_trim_b_ = 0;
-		return;
+	InputCalibrationRecord input_record;
+	if (store_->load(StoreKey::kInputCalibration, &input_record, sizeof(input_record))) {
+		// Implausible endpoints leave the nominal ones.
+		for (uint8_t channel = 0; channel < InputCalibration::kNumChannels; ++channel) {
+			input_.set_endpoints(channel, input_record.endpoints[channel]);
+		}
 	}
 
-	// v1: magic, version, trim_a, trim_b, checksum, reserved
-	if (data->version == 1) {
-		gain_trim_a_ = clamp16(data->gain_trim_a, kGainTrimMin, kGainTrimMax);
-		gain_trim_b_ = clamp16(data->gain_trim_b, kGainTrimMin, kGainTrimMax);
-		offset_trim_a_ = 0;
-		offset_trim_b_ = 0;
-		return;
+	CalibrationRecord record;
+	if (store_->load(StoreKey::kCalibration, &record, sizeof(record))) {
+		for (uint8_t channel = 0; channel < kNumChannels; ++channel) {
+			for (uint8_t point = 0; point < kNumPoints; ++point) {
+				output_.set_correction(channel, point,
+									   clamp16(record.corrections[channel][point],
+											   kCorrectionMin, kCorrectionMax));
+			}
+		}
+	} else if (load_legacy()) {
+		// Into the store before the legacy sector gets recycled.
+		save_to_flash();
 	}
+	// Otherwise the identity correction stays.
 
-	if (data->version != kVersion) {
-		gain_trim_a_ = 0;
-		gain_trim_b_ = 0;
-		offset_trim_a_ = 0;
-		offset_trim_b_ = 0;
-		return;
+	for (uint8_t channel = 0; channel < kNumChannels; ++channel) {
+		output_.rebuild(channel);
 	}
+}
 
-	if (data->checksum != compute_checksum(*data)) {
-		gain_trim_a_ = 0;
-		gain_trim_b_ = 0;
-		offset_trim_a_ = 0;
-		offset_trim_b_ = 0;
-		return;
+bool Calibration::load_legacy() {
+	const auto* data =
+		reinterpret_cast<const CalibrationStorage*>(XIP_BASE + kLegacyFlashOffset);
+	if (data->magic != kMagic ||
+		!(data->version == 1 ||
+		  (data->version == kVersion && data->checksum == compute_checksum(*data)))) {
+		return false;
 	}
-
-	gain_trim_a_ = clamp16(data->gain_trim_a, kGainTrimMin, kGainTrimMax);
-	gain_trim_b_ = clamp16(data->gain_trim_b, kGainTrimMin, kGainTrimMax);
-	offset_trim_a_ = clamp16(data->offset_trim_a, kOffsetTrimMin, kOffsetTrimMax);
-	offset_trim_b_ = clamp16(data->offset_trim_b, kOffsetTrimMin, kOffsetTrimMax);
+	// Single gain/offset trims, as modes applied them in DAC codes:
+	// corrected = code * (1 + gain) + offset.
+	const bool has_offsets = data->version == kVersion;
+	const int16_t gains[kNumChannels] = {data->gain_trim_a, data->gain_trim_b};
+	const int16_t offsets[kNumChannels] = {has_offsets ? data->offset_trim_a : int16_t{0},
+										   has_offsets ? data->offset_trim_b : int16_t{0}};
+	for (uint8_t channel = 0; channel < kNumChannels; ++channel) {
+		for (uint8_t point = 0; point < kNumPoints; ++point) {
+			const int32_t code = OutputCalibration::point_code(point);
+			const int32_t correction = code * gains[channel] / kGainScale + offsets[channel];
+			output_.set_correction(
+				channel, point,
+				clamp16(static_cast<int16_t>(correction), kCorrectionMin, kCorrectionMax));
+		}
+	}
+	return true;
 }
 
-void Calibration::save_to_flash() {
-	CalibrationStorage data;
-	data.magic = kMagic;
-	data.version = kVersion;
-	data.gain_trim_a = gain_trim_a_;
-	data.gain_trim_b = gain_trim_b_;
-	data.offset_trim_a = offset_trim_a_;
-	data.offset_trim_b = offset_trim_b_;
-	data.checksum = compute_checksum(data);
-
-	uint8_t page_buffer[FLASH_PAGE_SIZE];
-	memset(page_buffer, 0xFF, sizeof(page_buffer));
-	memcpy(page_buffer, &data, sizeof(data));
+bool Calibration::save_input() {
+	InputCalibrationRecord record;
+	for (uint8_t channel = 0; channel < InputCalibration::kNumChannels; ++channel) {
+		record.endpoints[channel] = input_.endpoints(channel);
+	}
+	return store_->save(StoreKey::kInputCalibration, &record, sizeof(record));
+}
 
-	uint32_t interrupts = save_and_disable_interrupts();
-	flash_range_erase(kFlashOffset, FLASH_SECTOR_SIZE);
-	flash_range_program(kFlashOffset, page_buffer, FLASH_PAGE_SIZE);
-	restore_interrupts(interrupts);
+bool Calibration::save_to_flash() {
+	CalibrationRecord record;
+	for (uint8_t channel = 0; channel < kNumChannels; ++channel) {
+		for (uint8_t point = 0; point < kNumPoints; ++point) {
+			record.corrections[channel][point] = output_.correction(channel, point);
+		}
+	}
+	// One page program; never an erase.
+	return store_->save(StoreKey::kCalibration, &record, sizeof(record));
 }
@@ -3,58 +3,119 @@
 
 #include <cstdint>
 
-#include "brain-io/audio-cv-in.h"
-#include "brain-io/audio-cv-out.h"
-#include "brain-ui/leds.h"
-#include "brain-ui/pots.h"
+#include "control-snapshot.h"
+#include "cv-in-capture.h"
+#include "flash-store.h"
+#include "hal.h"
+#include "input-calibration.h"
+#include "output-calibration.h"
 
 class Calibration {
 public:
 	Calibration();
 
-	void init();
+	// Load the output points and input endpoints from the settings store and
+	// expand their tables. Output calibration saved by older firmware is
+	// converted into the store.
+	void init(FlashStore& store);
 
-	// Getters
-	int16_t gain_trim_a() const { return gain_trim_a_; }
-	int16_t gain_trim_b() const { return gain_trim_b_; }
-	int16_t offset_trim_a() const { return offset_trim_a_; }
-	int16_t offset_trim_b() const { return offset_trim_b_; }
+	// Shared output correction tables, applied by the sample tick.
+	const OutputCalibration& output() const { return output_; }
+
+	// Shared input conversion tables, applied by the sample tick.
+	const InputCalibration& input() const { return input_; }
+
+	// Point being calibrated (0-10 = volts).
+	uint8_t selected_point() const { return selected_point_; }
+
+	// Point the outputs hold: the selected one, or the reference of a
+	// running input capture.
+	uint8_t output_point() const;
+
+	// Call on entering calibration mode. The current pot positions select the
+	// point but leave every correction as stored.
+	void begin(const ControlSnapshot& controls);
 
 	// Update calibration values from pots.
-	// base mode: Pot 1 = scale A, Pot 2 = scale B
-	// hold Button A + Pot 3 = offset A
-	// hold Button B + Pot 3 = offset B
-	void update_from_pots(brain::ui::Pots& pots,
-						  bool button_a_held, bool button_b_held);
+	// Pot 1 = point select (0V..10V)
+	// Pot 2 = output A correction at the selected point
+	// Pot 3 = output B correction at the selected point
+	// A correction only changes once its pot moves, so selecting another point
+	// keeps that point's stored value.
+	void update_from_pots(const ControlSnapshot& controls);
 
-	// Save to flash
-	void save();
+	// Append the points to the settings store. False if the store is full
+	// until its maintenance runs.
+	bool save();
 
-	// Calibration passthrough: input A->output A, input B->output B.
-	// Uses SDK voltage reads and applies live gain/offset trims.
-	void process_passthrough(brain::io::AudioCvIn& cv_in,
-							 brain::io::AudioCvOut& cv_out) const;
+	// Input calibration by loopback: with Out A patched to In A and Out B to
+	// In B, both outputs step to +4V and then -4V, and the inputs are averaged
+	// at each. The line through the two points gives each input's -5V/+5V
+	// endpoints, which are applied and saved if plausible.
+	void start_input_capture(uint32_t now_us);
+	bool input_capture_active() const { return capture_stage_ != CaptureStage::kIdle; }
+	// UI loop while a capture runs: consumes the input pairs captured since
+	// the last call. Only pairs converted while the output held the level
+	// count: pairs due during a capture pause are skipped.
+	void update_input_capture(const CvInCapture& capture, uint32_t now_us);
+	// Drops a capture in progress; nothing is applied or saved.
+	void cancel_input_capture() { capture_stage_ = CaptureStage::kIdle; }
 
-	// Blink all LEDs for calibration mode visual feedback
-	void update_leds(brain::ui::Leds& leds);
+	// Calibration output: both channels hold the selected point's voltage,
+	// corrected through the output tables, for measuring with a meter.
+	// Runs on the DSP core.
+	static void process_reference(uint8_t point, const OutputCalibration& output,
+								  hal::CvOut& cv_out);
 
-	// Constants for modes that apply calibration
-	static constexpr int32_t kCalibScale = 10000;
+	// Blink all LEDs for calibration mode visual feedback: solid while an
+	// input capture runs, fast blink for a second after one fails.
+	void update_leds(hal::Leds& leds, uint32_t now_us);
 
 private:
-	static constexpr int16_t kGainTrimMin = -300;    // -3.00%
-	static constexpr int16_t kGainTrimMax = 300;     // +3.00%
-	static constexpr int16_t kOffsetTrimMin = -200;  // ~-0.5V in DAC units
-	static constexpr int16_t kOffsetTrimMax = 200;   // ~+0.5V in DAC units
-
-	int16_t gain_trim_a_;
-	int16_t gain_trim_b_;
-	int16_t offset_trim_a_;
-	int16_t offset_trim_b_;
+	enum class CaptureStage : uint8_t {
+		kIdle = 0,
+		kSettleHigh,
+		kMeasureHigh,
+		kSettleLow,
+		kMeasureLow,
+	};
+
+	static constexpr uint8_t kCapturePointHigh = 9;  // +4V signal
+	static constexpr uint8_t kCapturePointLow = 1;   // -4V signal
+	static constexpr int32_t kCaptureHighMv = 4000;
+	static constexpr int32_t kCaptureLowMv = -4000;
+	static constexpr uint32_t kCaptureSettleUs = 100000;
+	static constexpr uint32_t kCapturePairs = 4096;
+	static constexpr uint32_t kCaptureChunk = 64;
+	static constexpr uint32_t kCaptureFailedShowUs = 1000000;
+
+	static constexpr uint8_t kPotPoint = 0;
+	static constexpr uint8_t kPotCorrectionA = 1;
+	static constexpr uint8_t kPotCorrectionB = 2;
+	static constexpr int16_t kCorrectionMin = -200;  // ~-0.5V in DAC units
+	static constexpr int16_t kCorrectionMax = 200;   // ~+0.5V in DAC units
+
+	OutputCalibration output_;
+	InputCalibration input_;
+	FlashStore* store_;
+	PotWatch pot_watch_;
+	uint8_t selected_point_;
 	uint32_t blink_timer_;
 
+	// Input capture
+	CaptureStage capture_stage_;
+	uint32_t capture_stage_started_us_;
+	uint32_t capture_next_pair_;
+	uint32_t capture_count_;
+	int32_t capture_sum_q4_[InputCalibration::kNumChannels];
+	int32_t capture_high_q4_[InputCalibration::kNumChannels];
+	uint32_t capture_failed_until_us_;
+
 	void load_from_flash();
-	void save_to_flash();
+	bool load_legacy();
+	bool save_to_flash();
+	bool save_input();
+	void finish_input_capture(const int32_t* low_q4, uint32_t now_us);
 };
 
 #endif  // CALIBRATION_H_
@@ -0,0 +1,43 @@
+#ifndef CONTROL_SNAPSHOT_H_
+#define CONTROL_SNAPSHOT_H_
+
+#include <cstdint>
+
+// Pot and button state captured by the UI core and handed to the mode DSP.
+struct ControlSnapshot {
+	static constexpr uint8_t kNumPots = 3;
+
+	uint8_t pots[kNumPots];
+	uint16_t pots_raw[kNumPots];
+	// Bumped each time pots[i] changes, so modes can cache pot-derived values.
+	uint16_t pot_generation[kNumPots];
+	bool button_b_pressed;
+
+	void set_pot(uint8_t index, uint8_t value, uint16_t raw) {
+		if (pots[index] != value) {
+			pots[index] = value;
+			++pot_generation[index];
+		}
+		pots_raw[index] = raw;
+	}
+};
+
+// Tells a mode which pots moved since it last looked.
+class PotWatch {
+public:
+	// True if pot `index` changed since the previous call for it; always true the first time.
+	bool changed(const ControlSnapshot& controls, uint8_t index) {
+		const uint8_t bit = static_cast<uint8_t>(1u << index);
+		const uint16_t generation = controls.pot_generation[index];
+		if ((seen_mask_ & bit) && seen_generation_[index] == generation) return false;
+		seen_generation_[index] = generation;
+		seen_mask_ |= bit;
+		return true;
+	}
+
+private:
+	uint16_t seen_generation_[ControlSnapshot::kNumPots] = {};
+	uint8_t seen_mask_ = 0;
+};
+
+#endif  // CONTROL_SNAPSHOT_H_
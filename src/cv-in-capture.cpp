@@ -0,0 +1,196 @@
+#include "cv-in-capture.h"
+
+#include "cv-in-decimator.h"
+#include "hardware/adc.h"
+#include "hardware/dma.h"
+#include "pico/time.h"
+
+namespace {
+constexpr uint32_t kAdcClockHz = 48000000;
+constexpr uint32_t kMicrosPerSecond = 1000000;
+constexpr uint32_t kMinPairRateHz = 1000;       // keeps the Q16 period in 32 bits
+constexpr uint32_t kMaxPairRateHz = 250000;     // 500 kS/s ADC limit, two inputs
+constexpr uint8_t kNumAdcInputs = 4;
+
+constexpr uint32_t log2_exact(uint32_t v) {
+	uint32_t bits = 0;
+	while ((1u << bits) < v) ++bits;
+	return bits;
+}
+
+// Nominal-unit voltage; the calibrated conversion is the input stage's table.
+float nominal_voltage(uint16_t raw) {
+	constexpr InputCalibration::Endpoints kNominal = InputCalibration::kNominal;
+	return -5.0f + static_cast<float>(InputCalibration::linearize_q4(raw) - kNominal.minus_q4) *
+					   10.0f / static_cast<float>(kNominal.plus_q4 - kNominal.minus_q4);
+}
+}  // namespace
+
+bool CvInCapture::start(uint8_t adc_input_a, uint8_t adc_input_b, uint32_t pair_rate_hz) {
+	static_assert((kRingBytes & (kRingBytes - 1)) == 0, "DMA ring size must be a power of two");
+	if (dma_channel_ >= 0 || adc_input_a == adc_input_b || adc_input_a >= kNumAdcInputs ||
+		adc_input_b >= kNumAdcInputs || pair_rate_hz < kMinPairRateHz ||
+		pair_rate_hz > kMaxPairRateHz) {
+		return false;
+	}
+
+	// Round robin visits enabled inputs in ascending order from the selected one.
+	a_first_ = adc_input_a < adc_input_b;
+	first_input_ = a_first_ ? adc_input_a : adc_input_b;
+	round_robin_mask_ = static_cast<uint8_t>((1u << adc_input_a) | (1u << adc_input_b));
+	pair_rate_hz_ = pair_rate_hz;
+	period_us_q16_ =
+		static_cast<uint32_t>((static_cast<uint64_t>(kMicrosPerSecond) << 16) / pair_rate_hz);
+
+	dma_channel_ = dma_claim_unused_channel(true);
+	start_us_ = time_us_64();
+	paused_pairs_ = 0;
+	resume();
+	missed_pairs_ = 0;
+	return true;
+}
+
+void CvInCapture::start_run() {
+	// One conversion every (1 + div) ADC clocks, two conversions per pair. The
+	// divider has 8 fractional bits, so e.g. 128k pairs/s (187.5 clocks) is exact.
+	adc_set_clkdiv(static_cast<float>(kAdcClockHz) / static_cast<float>(2 * pair_rate_hz_) -
+				   1.0f);
+	adc_fifo_drain();
+	adc_fifo_setup(true, true, 1, false, false);
+	adc_select_input(first_input_);
+	adc_set_round_robin(round_robin_mask_);
+
+	dma_channel_config config = dma_channel_get_default_config(dma_channel_);
+	channel_config_set_transfer_data_size(&config, DMA_SIZE_16);
+	channel_config_set_read_increment(&config, false);
+	channel_config_set_write_increment(&config, true);
+	channel_config_set_ring(&config, true, log2_exact(kRingBytes));
+	channel_config_set_dreq(&config, DREQ_ADC);
+	uint16_t* const write_start = &ring_[(run_start_pair_ * 2) & (kRingEntries - 1)];
+	dma_channel_configure(dma_channel_, &config, write_start, &adc_hw->fifo,
+						  dma_encode_transfer_count(kTransferCount), true);
+	adc_run(true);
+}
+
+void CvInCapture::pause() {
+	if (!running_) return;
+	adc_run(false);
+	// Let the last conversion land and DMA empty the FIFO before counting.
+	while (!(adc_hw->cs & ADC_CS_READY_BITS)) tight_loop_contents();
+	while (adc_fifo_get_level() != 0) tight_loop_contents();
+
+	const uint32_t seq = sequence_.load(std::memory_order_relaxed);
+	sequence_.store(seq + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	paused_pairs_ = run_start_pair_ + run_pairs();
+	running_ = false;
+	sequence_.store(seq + 2, std::memory_order_release);
+
+	dma_channel_abort(dma_channel_);
+	adc_set_round_robin(0);
+	adc_fifo_setup(false, false, 0, false, false);
+	adc_fifo_drain();
+}
+
+void CvInCapture::resume() {
+	if (running_ || dma_channel_ < 0) return;
+
+	// Rejoin the time grid: the next pair index is the one due now.
+	const uint64_t elapsed_us = time_us_64() - start_us_;
+	uint32_t next_pair =
+		static_cast<uint32_t>((elapsed_us * pair_rate_hz_) / kMicrosPerSecond) + 1;
+	if (static_cast<int32_t>(next_pair - paused_pairs_) < 0) next_pair = paused_pairs_;
+
+	// The gap is never converted. Nothing is written into the ring for it:
+	// the sample tick may be reading the slots, and readers skip the gap.
+	missed_pairs_ += next_pair - paused_pairs_;
+
+	const uint32_t seq = sequence_.load(std::memory_order_relaxed);
+	sequence_.store(seq + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	run_start_pair_ = next_pair;
+	run_start_us_ = static_cast<uint32_t>(
+		start_us_ + ((static_cast<uint64_t>(next_pair) * period_us_q16_) >> 16));
+	start_run();
+	running_ = true;
+	sequence_.store(seq + 2, std::memory_order_release);
+}
+
+void CvInCapture::rearm_if_ending() {
+	if (!running_ || run_pairs() < kRearmPairs) return;
+	pause();
+	resume();
+}
+
+uint32_t CvInCapture::run_pairs() const {
+	const uint32_t remaining =
+		dma_channel_hw_addr(dma_channel_)->transfer_count & kTransferCountMask;
+	return (kTransferCount - remaining) / 2;
+}
+
+CvInCapture::Progress CvInCapture::progress() const {
+	// Retries only while the UI core is inside pause()/resume(), a few microseconds.
+	while (true) {
+		const uint32_t before = sequence_.load(std::memory_order_acquire);
+		if ((before & 1u) != 0) continue;
+		const Progress p{running_ ? run_start_pair_ + run_pairs() : paused_pairs_,
+						 run_start_pair_};
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if (sequence_.load(std::memory_order_relaxed) == before) return p;
+	}
+}
+
+uint32_t CvInCapture::pairs_captured() const {
+	return progress().pairs;
+}
+
+bool CvInCapture::latest(Sample& out) const {
+	return read_block(progress().pairs - 1, &out, 1);
+}
+
+bool CvInCapture::read_block(uint32_t first, Sample* out, uint32_t count) const {
+	const Progress before = progress();
+	if (!range_in_run(before, first, count)) return false;
+	copy_pairs(first, out, count);
+	return window_intact(before, progress(), first);
+}
+
+void CvInCapture::copy_pairs(uint32_t first, Sample* out, uint32_t count) const {
+	for (uint32_t i = 0; i < count; ++i) {
+		const uint32_t slot = ((first + i) * 2) & (kRingEntries - 1);
+		const uint16_t first_raw = ring_[slot];
+		const uint16_t second_raw = ring_[slot + 1];
+		out[i].raw_a = a_first_ ? first_raw : second_raw;
+		out[i].raw_b = a_first_ ? second_raw : first_raw;
+	}
+}
+
+uint32_t CvInCapture::sample_time_us(uint32_t index) const {
+	const int32_t delta = static_cast<int32_t>(index - run_start_pair_);
+	return run_start_us_ +
+		   static_cast<uint32_t>((static_cast<int64_t>(delta) * period_us_q16_) >> 16);
+}
+
+void CvInCapture::update() {
+	const Progress before = progress();
+	uint32_t first = 0;
+	if (!newest_window(before, first)) return;
+	const uint8_t spare = window_index_ ^ 1u;
+	Sample* const window = windows_[spare];
+	copy_pairs(first, window, kWindowPairs);
+	if (!window_intact(before, progress(), first)) return;
+	window_index_ = spare;
+	window_first_ = first;
+	latched_ = window[kWindowPairs - 1];
+	const cv_in_decimator::Reading reading = cv_in_decimator::decimate(window);
+	decimated_q4_a_ = reading.a_q4;
+	decimated_q4_b_ = reading.b_q4;
+}
+
+float CvInCapture::get_voltage_channel_a() const {
+	return nominal_voltage(latched_.raw_a);
+}
+
+float CvInCapture::get_voltage_channel_b() const {
+	return nominal_voltage(latched_.raw_b);
+}
@@ -0,0 +1,170 @@
+#ifndef CV_IN_CAPTURE_H_
+#define CV_IN_CAPTURE_H_
+
+#include <atomic>
+#include <cstdint>
+
+#include "hal.h"
+#include "input-calibration.h"
+
+// Free-running capture of both CV inputs into a DMA ring buffer.
+// The ADC converts the two inputs round-robin at a fixed pair rate and DMA
+// moves every result into RAM, so no CPU time is spent waiting on
+// conversions. Readers on either core get the latest pair or a block of
+// evenly spaced pairs, each with a known timestamp, without blocking. The
+// sample tick runs at a fraction of the pair rate and reads the inputs
+// decimated (cv-in-decimator.h).
+//
+// The ADC is shared with the pots: the UI core brackets its pot scan with
+// pause()/resume() (paced by pot-scan-pacer.h). Pair indices stay on the
+// fixed-rate time grid across a pause. The pairs due while paused are never
+// converted, and their ring slots are left alone; each stretch of capture
+// between pauses is a run, and readers only use pairs from one run.
+class CvInCapture final : public hal::CvIn {
+public:
+	struct Sample {
+		uint16_t raw_a;
+		uint16_t raw_b;
+	};
+
+	// Ring holds the most recent kRingPairs pairs (power of two for the DMA
+	// address wrap).
+	static constexpr uint32_t kRingPairs = 1024;
+	// Pairs latched per update(): the decimation window (cv_in_decimator::kFactor).
+	static constexpr uint32_t kWindowPairs = 16;
+
+	// Pairs passed and the first pair of the current (or last, while paused)
+	// run, read together.
+	struct Progress {
+		uint32_t pairs;
+		uint32_t run_start_pair;
+	};
+
+	// Pairs [first, first + count) are all captured pairs of the run in
+	// `progress` and still in the ring. Pairs before the run start were due
+	// during a pause (their slots hold older data) or belong to an earlier
+	// run. One pair of slack is left for the pair DMA may be writing.
+	static bool range_in_run(const Progress& progress, uint32_t first, uint32_t count) {
+		const uint32_t available = progress.pairs - first;
+		return count != 0 && static_cast<int32_t>(first - progress.run_start_pair) >= 0 &&
+			   available >= count && available <= kRingPairs - 1;
+	}
+
+	// The newest window that lies wholly inside the run: false while the run
+	// has fewer than kWindowPairs pairs, otherwise its first pair index.
+	static bool newest_window(const Progress& progress, uint32_t& first) {
+		first = progress.pairs - kWindowPairs;
+		return range_in_run(progress, first, kWindowPairs);
+	}
+
+	// A copy from pair `first` made between `before` and `after` is good if
+	// the run did not change (a resume restarts DMA at an arbitrary ring
+	// slot) and the ring has not lapped it.
+	static bool window_intact(const Progress& before, const Progress& after, uint32_t first) {
+		return after.run_start_pair == before.run_start_pair &&
+			   after.pairs - first <= kRingPairs - 1;
+	}
+
+	// adc_input_a/b: ADC mux inputs (0-3) of CV in A and B. The pins must
+	// already be set up for analog input.
+	bool start(uint8_t adc_input_a, uint8_t adc_input_b, uint32_t pair_rate_hz);
+
+	// UI core: hand the ADC to other users and take it back.
+	void pause();
+	void resume();
+
+	// UI core, every pass: a run's DMA count is finite, so a run close to its
+	// end is restarted. Pot scans restart runs far more often than this.
+	void rearm_if_ending();
+
+	// Number of pair indices passed since start(), converted or missed while
+	// paused. The latest pair has index pairs_captured() - 1.
+	uint32_t pairs_captured() const;
+
+	// pairs_captured() and the current run's first pair, read together.
+	Progress progress() const;
+
+	// Pairs that fell in pauses since start(). UI core.
+	uint32_t missed_pairs() const { return missed_pairs_; }
+
+	// Latest pair of the current run; false until it has one.
+	bool latest(Sample& out) const;
+
+	// Copies `count` pairs starting at pair index `first`. False if any of them
+	// is not yet captured, already overwritten or outside the current run.
+	bool read_block(uint32_t first, Sample* out, uint32_t count) const;
+
+	// Capture time of pair `index` in microseconds (time_us_32 timebase).
+	uint32_t sample_time_us(uint32_t index) const;
+
+	uint32_t pair_rate_hz() const { return pair_rate_hz_; }
+
+	// Latch the decimated reading and the latest pair, so both channels of one
+	// sample tick come from the same window. A window is only latched once it
+	// is all converted pairs of one run: after start() and after every pause
+	// the previous reading is held until the run has captured a full window.
+	void update();
+
+	// Latched decimated reading, straightened for DNL, in 1/16 codes.
+	int32_t decimated_q4_a() const { return decimated_q4_a_; }
+	int32_t decimated_q4_b() const { return decimated_q4_b_; }
+
+	// The latched window of cv_in_decimator::kFactor raw pairs and the pair
+	// index of its first one, for per-pair work such as gate detection.
+	const Sample* window() const { return windows_[window_index_]; }
+	uint32_t window_first() const { return window_first_; }
+
+	// hal::CvIn: the latched pair
+	uint16_t get_raw_channel_a() const override { return latched_.raw_a; }
+	uint16_t get_raw_channel_b() const override { return latched_.raw_b; }
+	float get_voltage_channel_a() const override;
+	float get_voltage_channel_b() const override;
+
+private:
+	static constexpr uint32_t kRingEntries = kRingPairs * 2;
+	static constexpr uint32_t kRingBytes = kRingEntries * sizeof(uint16_t);
+	// DMA count for one run, two transfers per pair: about 17 minutes at 128k
+	// pairs/s. It must fit the 28-bit count field: on RP2350 the top four bits
+	// of TRANS_COUNT are its mode, so the count is written encoded and masked
+	// when read back.
+	static constexpr uint32_t kTransferCount = 0x0FFFFFFEu;
+	static constexpr uint32_t kTransferCountMask = 0x0FFFFFFFu;
+	// Runs this long are restarted, a ring's worth of pairs before the end.
+	static constexpr uint32_t kRearmPairs = kTransferCount / 2 - kRingPairs;
+	// 0V on a nominal unit, read until the first window is captured.
+	static constexpr int32_t kNominalZeroQ4 =
+		(InputCalibration::kNominal.minus_q4 + InputCalibration::kNominal.plus_q4) / 2;
+
+	void start_run();
+	uint32_t run_pairs() const;
+	void copy_pairs(uint32_t first, Sample* out, uint32_t count) const;
+
+	alignas(kRingBytes) uint16_t ring_[kRingEntries] = {};
+
+	int dma_channel_ = -1;
+	uint8_t first_input_ = 0;
+	uint8_t round_robin_mask_ = 0;
+	bool a_first_ = true;
+	uint32_t pair_rate_hz_ = 0;
+	uint32_t period_us_q16_ = 0;
+	uint64_t start_us_ = 0;
+
+	// Written by the UI core under the sequence counter, read by both cores.
+	std::atomic<uint32_t> sequence_{0};
+	uint32_t run_start_pair_ = 0;   // pair index of the first pair in this run
+	uint32_t run_start_us_ = 0;     // grid time of run_start_pair_
+	uint32_t paused_pairs_ = 0;     // pairs captured when last paused
+	bool running_ = false;
+	uint32_t missed_pairs_ = 0;     // UI core only
+
+	// Sample tick only. update() copies into the spare window and switches to
+	// it once the copy is known good.
+	Sample latched_{};
+	Sample windows_[2][kWindowPairs] = {};
+	uint8_t window_index_ = 0;
+	uint32_t window_first_ = 0;
+	int32_t decimated_q4_a_ = kNominalZeroQ4;
+	int32_t decimated_q4_b_ = kNominalZeroQ4;
+};
+
+#endif  // CV_IN_CAPTURE_H_
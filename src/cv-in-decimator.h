@@ -0,0 +1,55 @@
+#ifndef CV_IN_DECIMATOR_H_
+#define CV_IN_DECIMATOR_H_
+
+#include <cstdint>
+
+#include "cv-in-capture.h"
+#include "input-calibration.h"
+
+// Boxcar decimator (a first-order CIC) from the oversampled CV input capture
+// down to the sample tick. The ADC runs kFactor pairs per tick. Each tick
+// takes the mean of the newest kFactor pairs, after straightening every
+// reading for the ADC's DNL, in 1/16 codes. The ADC's own noise (about an LSB)
+// dithers the readings, so the mean resolves steps below one code with a
+// quarter of a single reading's noise: two more effective bits.
+//
+// The window always ends at the newest pair, so the group delay is fixed at
+// (kFactor - 1) / 2 pair periods. Its response has nulls at every multiple of
+// the tick rate, which are exactly the bands that would alias onto DC.
+//
+// Pairs due while capture is paused for a pot scan are never converted, and
+// the capture only hands out windows of kFactor consecutive converted pairs
+// (CvInCapture::newest_window), so every reading has the full two bits and
+// the fixed delay. After a pause the previous reading is held until the new
+// run has a full window, about one tick.
+namespace cv_in_decimator {
+
+constexpr uint32_t kFactorLog2 = 4;
+constexpr uint32_t kFactor = 1u << kFactorLog2;
+static_assert(kFactor == CvInCapture::kWindowPairs, "capture window must match the decimator");
+
+struct Reading {
+	int32_t a_q4;
+	int32_t b_q4;
+};
+
+// Mean straightened reading of kFactor consecutive pairs, rounded.
+inline Reading decimate(const CvInCapture::Sample* pairs) {
+	int32_t sum_a = 0;
+	int32_t sum_b = 0;
+	for (uint32_t i = 0; i < kFactor; ++i) {
+		sum_a += InputCalibration::linearize_q4(pairs[i].raw_a);
+		sum_b += InputCalibration::linearize_q4(pairs[i].raw_b);
+	}
+	constexpr int32_t kHalf = 1 << (kFactorLog2 - 1);
+	return {(sum_a + kHalf) >> kFactorLog2, (sum_b + kHalf) >> kFactorLog2};
+}
+
+// Group delay of the window, in nanoseconds at a given pair rate.
+constexpr uint32_t group_delay_ns(uint32_t pair_rate_hz) {
+	return static_cast<uint32_t>((uint64_t{kFactor - 1} * 500000000u) / pair_rate_hz);
+}
+
+}  // namespace cv_in_decimator
+
+#endif  // CV_IN_DECIMATOR_H_
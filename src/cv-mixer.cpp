@@ -1,28 +1,33 @@
 #include "cv-mixer.h"
 
-namespace {
-float clampf(float v, float lo, float hi) {
-	return v < lo ? lo : (v > hi ? hi : v);
-}
-}
+#include "cv-units.h"
+#include "fixed-point.h"
 
-void CvMixer::update(brain::ui::Pots& pots, brain::io::AudioCvIn& cv_in,
-					  brain::io::AudioCvOut& cv_out, brain::ui::Leds& leds,
-					  LedController& led_controller) {
-	float in_a = cv_in.get_voltage_channel_a();
-	float in_b = cv_in.get_voltage_channel_b();
+void CvMixer::process(const BlockParams& params, const Frame* in, Frame* out, size_t n) {
+	const ControlSnapshot& controls = params.controls;
+	const uint16_t level_a_q15 = fixed_point::u8_to_q15_shift(controls.pots[kPotLevelA]);
+	const uint16_t level_b_q15 = fixed_point::u8_to_q15_shift(controls.pots[kPotLevelB]);
+	const uint16_t main_level_q15 = fixed_point::u8_to_q15_shift(controls.pots[kPotMain]);
 
-	float level_a = static_cast<float>(pots.get(kPotLevelA)) / 255.0f;
-	float level_b = static_cast<float>(pots.get(kPotLevelB)) / 255.0f;
-	float main_level = static_cast<float>(pots.get(kPotMain)) / 255.0f;
+	// Inputs are int16 millivolts, so each term and their sum stay within
+	// kNarrowMax and the 32-bit multiplies are exact.
+	for (size_t i = 0; i < n; ++i) {
+		const int32_t in_a_mv = in[i].a;
+		const int32_t in_b_mv = in[i].b;
+		const int32_t mix_mv = fixed_point::mul_q15_narrow(
+			fixed_point::mul_q15_narrow(in_a_mv, level_a_q15) +
+				fixed_point::mul_q15_narrow(in_b_mv, level_b_q15),
+			main_level_q15);
+		const int32_t signal_mv =
+			fixed_point::clamp_i32(mix_mv, kMinSignalMillivolts, kMaxSignalMillivolts);
+		const int16_t out_code =
+			static_cast<int16_t>(cv_units::mv_to_dac(signal_mv + kCenterMillivolts));
+		out[i] = {out_code, out_code, 0};
+	}
 
-	float mix = (in_a * level_a + in_b * level_b) * main_level;
-	float signal = clampf(mix, kMinSignalVoltage, kMaxSignalVoltage);
-	float out = signal + kCenterVoltage;
+	if (n > 0) out_code_ = out[n - 1].a;
+}
 
-	const float out_a_voltage = out;
-	const float out_b_voltage = out;
-	cv_out.set_voltage(brain::io::AudioCvOutChannel::kChannelA, out_a_voltage);
-	cv_out.set_voltage(brain::io::AudioCvOutChannel::kChannelB, out_b_voltage);
-	led_controller.render_output_vu(leds, out_a_voltage, out_b_voltage);
+void CvMixer::render_leds(hal::Leds& leds, const LedController& led_controller) const {
+	led_controller.render_output_vu(leds, out_code_, out_code_);
 }
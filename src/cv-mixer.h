@@ -3,26 +3,25 @@
 
 #include <cstdint>
 
-#include "brain-io/audio-cv-in.h"
-#include "brain-io/audio-cv-out.h"
-#include "brain-ui/leds.h"
-#include "brain-ui/pots.h"
+#include "frame.h"
+#include "hal.h"
 #include "led-controller.h"
 
 class CvMixer {
 public:
-	void update(brain::ui::Pots& pots, brain::io::AudioCvIn& cv_in,
-				brain::io::AudioCvOut& cv_out, brain::ui::Leds& leds,
-				LedController& led_controller);
+	void process(const BlockParams& params, const Frame* in, Frame* out, size_t n);
+	void render_leds(hal::Leds& leds, const LedController& led_controller) const;
 
 private:
 	static constexpr uint8_t kPotLevelA = 0;
 	static constexpr uint8_t kPotLevelB = 1;
 	static constexpr uint8_t kPotMain = 2;
-	static constexpr float kMaxVoltage = 10.0f;
-	static constexpr float kCenterVoltage = 5.0f;
-	static constexpr float kMinSignalVoltage = -5.0f;
-	static constexpr float kMaxSignalVoltage = 5.0f;
+	static constexpr int32_t kCenterMillivolts = 5000;
+	static constexpr int32_t kMinSignalMillivolts = -5000;
+	static constexpr int32_t kMaxSignalMillivolts = 5000;
+
+	// Same signal on both outputs
+	uint16_t out_code_ = 2048;
 };
 
 #endif  // CV_MIXER_H_
@@ -0,0 +1,50 @@
+#ifndef CV_UNITS_H_
+#define CV_UNITS_H_
+
+#include <cstdint>
+
+#include "fixed-point.h"
+
+// Integer conversions between DAC codes and millivolts.
+// Output domain: DAC code 0..4095 == 0..10V, 5V center for bipolar signals.
+// Input domain: bipolar -5V..+5V signal millivolts, converted from raw ADC
+// codes by the input stage (input-calibration.h).
+namespace cv_units {
+
+constexpr uint16_t kDacMax = 4095;
+constexpr uint16_t kDacCenter = 2048;
+constexpr int32_t kDacFullScaleMv = 10000;
+constexpr int32_t kCenterMv = 5000;
+
+inline constexpr uint16_t clamp_dac(int32_t code) {
+	return static_cast<uint16_t>(fixed_point::clamp_i32(code, 0, kDacMax));
+}
+
+// 0..10000 mV -> DAC code, rounded and clamped.
+inline constexpr uint16_t mv_to_dac(int32_t mv) {
+	return clamp_dac((fixed_point::clamp_i32(mv, 0, kDacFullScaleMv) * kDacMax +
+					  (kDacFullScaleMv / 2)) /
+					 kDacFullScaleMv);
+}
+
+// DAC code -> 0..10000 mV, rounded.
+inline constexpr int32_t dac_to_mv(uint16_t code) {
+	return (static_cast<int32_t>(code) * kDacFullScaleMv + (kDacMax / 2)) / kDacMax;
+}
+
+// 4095 * 256 / 10000 codes per mV: 107347.968 as a 2^-26 multiplier on Q16.
+constexpr uint32_t kCodeQ8PerMvQ16Q26 = 107348;
+
+// 0..10000 mV in Q16 -> DAC code in 1/256 codes, within one 1/256 step of
+// the exact value. Only 32-bit multiplies (the M0+ has no 64-bit one): the
+// input is split at bit 15 so each product stays below 2^31, and the high
+// half takes 1/32 back off the rounded-up multiplier.
+inline constexpr uint32_t mv_q16_to_code_q8(int32_t mv_q16) {
+	const uint32_t hi = static_cast<uint32_t>(mv_q16) >> 15;
+	const uint32_t lo = static_cast<uint32_t>(mv_q16) & 0x7FFF;
+	return (hi * kCodeQ8PerMvQ16Q26 - (hi >> 5) + ((lo * kCodeQ8PerMvQ16Q26) >> 15)) >> 11;
+}
+
+}  // namespace cv_units
+
+#endif  // CV_UNITS_H_
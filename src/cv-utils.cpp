@@ -3,20 +3,91 @@
 #include <stdio.h>
 
 #include "brain-common/brain-common.h"
-#include "pico/time.h"
+#include "fixed-point-bench.h"
+#include "hardware/gpio.h"
+#include "pico/flash.h"
+#include "pico/stdio.h"
+
+namespace {
+const char* const kProfileStageNames[] = {
+	"ui.buttons",
+	"ui.pot_scan",
+	"dsp.cv_out",
+	"dsp.snapshot",
+	"dsp.cv_in",
+	"dsp.attenuverter",
+	"dsp.prec_adder",
+	"dsp.slew",
+	"dsp.ad_env",
+	"dsp.cv_mixer",
+	"dsp.noise",
+	"dsp.calibration",
+};
+
+// Iterations per fixed-point kernel: a few hundred thousand cycles each, well
+// inside SysTick's 24-bit range.
+constexpr uint32_t kBenchIterations = 1000;
+
+// Times every fixed_point_bench kernel in SysTick cycles and prints the cost
+// per operation with the input generation subtracted. Runs on the UI core,
+// which stalls for a few tens of milliseconds; the DSP core is untouched.
+void print_fixed_point_bench() {
+	constexpr uint32_t kCounterMask = 0x00FFFFFF;
+	uint32_t baseline_cycles = 0;
+	uint32_t checksum = 0;
+	printf("\n--- fixed point (cycles/op x10, baseline subtracted) ---\n");
+	for (uint32_t k = 0; k < fixed_point_bench::kNumKernels; k++) {
+		const fixed_point_bench::Kernel& kernel = fixed_point_bench::kKernels[k];
+		// The first pass warms the XIP cache; time the second.
+		checksum += kernel.run(kBenchIterations);
+		const uint32_t start = Profiler::now();
+		checksum += kernel.run(kBenchIterations);
+		const uint32_t cycles = (start - Profiler::now()) & kCounterMask;
+		if (k == 0) {
+			baseline_cycles = cycles;
+			printf("%-20s %6lu (raw)\n", kernel.name,
+				   static_cast<unsigned long>(cycles * 10 / kBenchIterations));
+			continue;
+		}
+		const uint32_t net = cycles > baseline_cycles ? cycles - baseline_cycles : 0;
+		printf("%-20s %6lu\n", kernel.name, static_cast<unsigned long>(net * 10 / kBenchIterations));
+	}
+	printf("checksum %08lx\n", static_cast<unsigned long>(checksum));
+}
+}  // namespace
 
 CvUtils::CvUtils()
 	: button_a_(BRAIN_BUTTON_1),
 	  button_b_(BRAIN_BUTTON_2),
+	  hal_cv_out_(cv_out_),
+	  hal_pulse_(pulse_),
+	  pulse_out_(hal_pulse_),
+	  hal_leds_(leds_),
+	  settings_flash_(kSettingsSectors),
+	  settings_store_(settings_flash_),
+	  session_(settings_store_),
+	  dsp_view_{Mode::kAttenuverter, false, {}, 0},
+	  dsp_calibration_active_(false),
+	  gate_next_pair_(0),
+	  controls_{},
 	  current_mode_(Mode::kAttenuverter),
 	  button_a_pressed_(false),
 	  button_b_pressed_(false),
 	  calibration_active_(false),
 	  button_a_release_event_(false),
+	  button_b_solo_(false),
+	  button_b_release_event_(false),
 	  both_pressed_since_(0),
-	  long_press_triggered_(false) {}
+	  long_press_triggered_(false),
+	  trace_output_enabled_(false),
+	  trace_dsp_dropped_(0),
+	  trace_ui_dropped_(0),
+	  boot_init_us_(0),
+	  first_output_us_(0) {}
 
 void CvUtils::init() {
+	boot_init_us_ = clock_.now_us();
+
 	// Initialize buttons
 	button_a_.init();
 	button_b_.init();
@@ -24,6 +95,7 @@ void CvUtils::init() {
 	// Track button press/release state
 	button_a_.set_on_press([this]() {
 		button_a_pressed_ = true;
+		button_b_solo_ = false;
 	});
 	button_a_.set_on_release([this]() {
 		button_a_pressed_ = false;
@@ -31,14 +103,16 @@ void CvUtils::init() {
 	});
 	button_b_.set_on_press([this]() {
 		button_b_pressed_ = true;
+		button_b_solo_ = !button_a_pressed_;
 	});
 	button_b_.set_on_release([this]() {
 		button_b_pressed_ = false;
+		button_b_release_event_ = button_b_solo_;
+		button_b_solo_ = false;
 	});
 
-	// Initialize LEDs
+	// Initialize LEDs. The startup animation runs on core 1 alongside the DSP.
 	leds_.init();
-	leds_.startup_animation();
 
 	// Initialize pots (3 pots, 8-bit resolution, smoothing enabled)
 	brain::ui::PotsConfig pot_config = brain::ui::create_default_config(3, 8);
@@ -54,26 +128,75 @@ void CvUtils::init() {
 	// Initialize pulse I/O
 	pulse_.begin();
 
-	// Load calibration from flash
-	calibration_.init();
+	// Load calibration from the settings store. Store maintenance (an erase)
+	// is left for a mode change so it cannot delay the first output.
+	settings_store_.init();
+	calibration_.init(settings_store_);
+
+	// Timestamp pulse input edges from the GPIO interrupt. brain-sdk's read()
+	// gives the jack level; comparing it with the pin finds the polarity.
+	pulse_in_.start(BRAIN_PULSE_INPUT, gpio_get(BRAIN_PULSE_INPUT) != hal_pulse_.read());
+	pulse_in_edges_ = EdgeInput(pulse_in_.read());
+	pulse_out_.start();
+	set_gate_levels();
+
+	// Pick up where the last session left off
+	set_mode(restore_session());
 
-	// Initialize mode handlers that need setup
-	ad_envelope_.init(pulse_);
+	// Hand the DSP core a complete first snapshot, then start free-running
+	// CV input capture. From here on the ADC is only touched through cv_capture_.
+	pots_.scan();
+	read_controls();
+	publish_ui_snapshot();
+	ui_channel_.try_read(dsp_view_);
+	cv_capture_.start(kCvInAdcInputA, kCvInAdcInputB, kCvInCaptureRateHz);
+
+	// Let core 1 pause this core safely while it writes the settings store.
+	flash_safe_execute_core_init();
+	Profiler::init_core();
 
-	// Set initial mode
-	set_mode(Mode::kAttenuverter);
+	// Start the fixed-rate sample tick (core 0 alarm IRQ)
+	sample_engine_.start(
+		kSampleRateHz,
+		[](void* context, uint32_t tick_us) {
+			static_cast<CvUtils*>(context)->process_sample(tick_us);
+		},
+		this);
+}
 
-	printf("CV Utils initialized\n");
+void CvUtils::run_ui() {
+	Profiler::init_core();
+	led_controller_.start_startup(clock_.now_us());
+	printf("CV Utils initialized (%lu Hz sample rate)\n",
+		   static_cast<unsigned long>(sample_engine_.sample_rate_hz()));
+	printf("Send 'p' to dump the stage profile, 'r' to reset it, 't' to toggle trace output\n");
+	while (true) {
+		update();
+	}
 }
 
 void CvUtils::update() {
 	// Poll hardware
+	uint32_t t = Profiler::now();
 	button_a_.update();
 	button_b_.update();
-	pots_.scan();
-	cv_in_.update();
+	t = profiler_.lap(kStageButtons, t);
+
+	// One timestamp for the whole UI pass.
+	const uint32_t now = clock_.now_us();
 
-	uint32_t now = time_us_32();
+	// Pots share the ADC with CV input capture, so they are scanned at a
+	// bounded rate and duty cycle rather than on every pass.
+	if (pot_scan_pacer_.due(now)) {
+		cv_capture_.pause();
+		pots_.scan();
+		cv_capture_.resume();
+		pot_scan_pacer_.scanned(now, clock_.now_us());
+		profiler_.lap(kStagePotScan, t);
+	}
+	cv_capture_.rearm_if_ending();
+	read_controls();
+	handle_console();
 
 	// --- Long press detection for calibration mode ---
 	if (button_a_pressed_ && button_b_pressed_) {
@@ -86,7 +209,8 @@ void CvUtils::update() {
 			uint32_t held_us = now - both_pressed_since_;
 			if (held_us >= kLongPressUs) {
 				long_press_triggered_ = true;
-				enter_calibration();
+				enter_calibration(now);
+				publish_ui_snapshot();
 				return;
 			}
 		}
@@ -95,7 +219,7 @@ void CvUtils::update() {
 		if (both_pressed_since_ != 0 && !long_press_triggered_) {
 			// Short tap of both buttons
 			if (calibration_active_) {
-				exit_calibration();
+				exit_calibration(now);
 			}
 		}
 		both_pressed_since_ = 0;
@@ -104,56 +228,317 @@ void CvUtils::update() {
 
 	// --- Calibration mode ---
 	if (calibration_active_) {
-		calibration_.update_from_pots(pots_, button_a_pressed_, button_b_pressed_);
-		calibration_.process_passthrough(cv_in_, cv_out_);
-		calibration_.update_leds(leds_);
+		// Button B: capture the inputs from the outputs (A->A, B->B loopback).
+		if (button_b_release_event_ && !calibration_.input_capture_active()) {
+			calibration_.start_input_capture(now);
+		}
+		if (calibration_.input_capture_active()) {
+			calibration_.update_input_capture(cv_capture_, now);
+		} else {
+			calibration_.update_from_pots(controls_);
+		}
+		publish_ui_snapshot();
+		calibration_.update_leds(hal_leds_, now);
 		button_a_release_event_ = false;
+		button_b_release_event_ = false;
 		return;
 	}
 
 	// --- Button A release: cycle modes ---
 	if (button_a_release_event_ && !button_b_pressed_) {
-		next_mode();
+		next_mode(now);
 	}
 	button_a_release_event_ = false;
+	button_b_release_event_ = false;
 
-	// --- Dispatch to current mode ---
-	switch (current_mode_) {
+	publish_ui_snapshot();
+	render_leds(now);
+	// A save parks core 0 for a page program; the dropped ticks show up in
+	// the sample engine's stalled periods.
+	session_.update(session_state(), now);
+	drain_trace();
+}
+
+void CvUtils::handle_console() {
+	static_assert(sizeof(kProfileStageNames) / sizeof(kProfileStageNames[0]) == kNumProfileStages,
+				  "one name per profiler stage");
+	static_assert(kNumProfileStages <= Profiler::kMaxStages, "too many profiler stages");
+
+	const int c = getchar_timeout_us(0);
+	if (c == 'p') {
+		profiler_.dump(kProfileStageNames, kNumProfileStages);
+		printf("Pulse in: %lu edges dropped\n",
+			   static_cast<unsigned long>(pulse_in_.edges().dropped()));
+		const uint32_t cv_pairs = cv_capture_.pairs_captured();
+		const uint32_t cv_missed = cv_capture_.missed_pairs();
+		printf("CV in: %lu pairs converted, %lu missed during pot scans\n",
+			   static_cast<unsigned long>(cv_pairs - cv_missed),
+			   static_cast<unsigned long>(cv_missed));
+		const SampleEngine::Stats engine = sample_engine_.stats();
+		printf("Tick: %lu deadline misses, %lu periods stalled (flash writes)\n",
+			   static_cast<unsigned long>(engine.deadline_misses),
+			   static_cast<unsigned long>(engine.stalled_periods));
+		printf("Boot: init at %lu us, first output at %lu us after reset\n",
+			   static_cast<unsigned long>(boot_init_us_),
+			   static_cast<unsigned long>(first_output_us_));
+	} else if (c == 'r') {
+		profiler_.reset();
+		printf("Profile reset\n");
+	} else if (c == 't') {
+		trace_output_enabled_ = !trace_output_enabled_;
+		printf("Trace output %s\n", trace_output_enabled_ ? "on" : "off");
+	} else if (c == 'b') {
+		print_fixed_point_bench();
+	}
+}
+
+void CvUtils::drain_trace() {
+	// Bounded per loop so a burst of records cannot stall the UI.
+	uint32_t budget = kMaxTraceLinesPerUpdate;
+	budget -= drain_trace_ring(trace::dsp, trace::kSourceDsp, trace_dsp_dropped_, budget);
+	drain_trace_ring(trace::ui, trace::kSourceUi, trace_ui_dropped_, budget);
+}
+
+template <typename Ring>
+uint32_t CvUtils::drain_trace_ring(Ring& ring, uint8_t source, uint32_t& reported_dropped,
+								   uint32_t budget) {
+	uint32_t lines = 0;
+	const uint32_t dropped = ring.dropped();
+	if (dropped != reported_dropped && lines < budget) {
+		const trace::Record lost{clock_.now_us(),
+								 static_cast<uint16_t>(trace::Event::kDropped),
+								 0,
+								 {source, static_cast<int32_t>(dropped - reported_dropped), 0, 0}};
+		reported_dropped = dropped;
+		write_trace_line(source, lost);
+		++lines;
+	}
+	trace::Record record;
+	while (lines < budget && ring.read(record)) {
+		write_trace_line(source, record);
+		++lines;
+	}
+	return lines;
+}
+
+void CvUtils::write_trace_line(uint8_t source, const trace::Record& record) {
+	if (!trace_output_enabled_) return;
+	char line[trace::kLineBufferSize];
+	trace::encode_line(source, record, line);
+	fputs(line, stdout);
+}
+
+void CvUtils::read_controls() {
+	for (uint8_t i = 0; i < ControlSnapshot::kNumPots; i++) {
+		controls_.set_pot(i, pots_.get(i), pots_.get_raw(i));
+	}
+	controls_.button_b_pressed = button_b_pressed_;
+}
+
+void CvUtils::publish_ui_snapshot() {
+	UiSnapshot snapshot;
+	snapshot.mode = current_mode_;
+	snapshot.calibration_active = calibration_active_;
+	snapshot.controls = controls_;
+	snapshot.calibration_point = calibration_.output_point();
+	ui_channel_.publish(snapshot);
+}
+
+void CvUtils::process_sample(uint32_t now) {
+	// Last tick's frame goes out first, at a fixed offset from the alarm, so
+	// the DAC updates on a steady grid however long the mode below takes.
+	uint32_t t = Profiler::now();
+	if (hal_cv_out_.latch() && first_output_us_ == 0) {
+		first_output_us_ = now;
+		trace::dsp.write(first_output_us_, trace::Event::kBoot,
+						 static_cast<int32_t>(boot_init_us_),
+						 static_cast<int32_t>(first_output_us_));
+	}
+	t = profiler_.lap(kStageCvOut, t);
+
+	// Keep the previous snapshot if core 1 is mid-publish.
+	ui_channel_.try_read(dsp_view_);
+	t = profiler_.lap(kStageSnapshotRead, t);
+
+	cv_capture_.update();
+	t = profiler_.lap(kStageCvIn, t);
+
+	if (dsp_view_.calibration_active != dsp_calibration_active_) {
+		apply_output_coupling(dsp_view_.calibration_active);
+		// The input calibration may have changed while calibrating.
+		if (!dsp_calibration_active_) set_gate_levels();
+	}
+
+	if (dsp_calibration_active_) {
+		Calibration::process_reference(dsp_view_.calibration_point, calibration_.output(),
+									   hal_cv_out_);
+		// Keep the edge state current, so no stale trigger fires on exit.
+		Frame discarded{};
+		scan_gates();
+		take_edges(now, discarded);
+		profiler_.lap(kStageCalibration, t);
+		return;
+	}
+
+	// --- One-frame block through the current mode ---
+	Frame in{};
+	const InputCalibration& input_cal = calibration_.input();
+	in.a = input_cal.linear_to_signal_mv(InputCalibration::kChannelA, cv_capture_.decimated_q4_a());
+	in.b = input_cal.linear_to_signal_mv(InputCalibration::kChannelB, cv_capture_.decimated_q4_b());
+	scan_gates();
+	take_edges(now, in);
+
+	const BlockParams params{dsp_view_.controls, now, sample_engine_.period_us()};
+	Frame out;
+	process_block(dsp_view_.mode, params, &in, &out, 1);
+
+	// Output calibration for every mode: one table load per channel, two
+	// when the mode asks for a fraction of a code, which the sigma-delta
+	// dithers in. The codes are written out at the start of the next tick,
+	// and the pulse is timed to go out with them.
+	const OutputCalibration& output_cal = calibration_.output();
+	hal_cv_out_.stage(hal::CvOutChannel::kChannelA,
+					  output_dither_[0].process(output_cal.apply_q8(
+						  OutputCalibration::kChannelA, out.a, out.code_frac[0])));
+	hal_cv_out_.stage(hal::CvOutChannel::kChannelB,
+					  output_dither_[1].process(output_cal.apply_q8(
+						  OutputCalibration::kChannelB, out.b, out.code_frac[1])));
+	if (out.pulse & Frame::kPulseRise) pulse_out_.request(now + params.period_us, out.pulse_us);
+	profiler_.lap(kStageModeFirst + static_cast<uint8_t>(dsp_view_.mode), t);
+}
+
+void CvUtils::process_block(Mode mode, const BlockParams& params, const Frame* in, Frame* out,
+							size_t n) {
+	switch (mode) {
 		case Mode::kAttenuverter:
-			attenuverter_.update(pots_, cv_in_, cv_out_, leds_, led_controller_);
+			attenuverter_.process(params, in, out, n);
 			break;
 		case Mode::kPrecisionAdder:
-			precision_adder_.update(pots_, cv_in_, cv_out_, calibration_,
-									button_b_pressed_, leds_, led_controller_);
+			precision_adder_.process(params, in, out, n);
 			break;
 		case Mode::kSlew:
-			slew_limiter_.update(pots_, cv_in_, cv_out_, calibration_,
-								 button_b_pressed_, leds_, led_controller_);
+			slew_limiter_.process(params, in, out, n);
 			break;
 		case Mode::kAdEnvelope:
-			ad_envelope_.update(pots_, cv_in_, cv_out_, pulse_, calibration_,
-								 button_b_pressed_, leds_, led_controller_);
+			ad_envelope_.process(params, in, out, n);
 			break;
 		case Mode::kCvMixer:
-			cv_mixer_.update(pots_, cv_in_, cv_out_, leds_, led_controller_);
+			cv_mixer_.process(params, in, out, n);
 			break;
 		case Mode::kNoise:
-			noise_.update(pots_, cv_out_, pulse_, button_b_pressed_, leds_, led_controller_);
+			noise_.process(params, in, out, n);
 			break;
 	}
+}
+
+void CvUtils::set_gate_levels() {
+	const InputCalibration& input_cal = calibration_.input();
+	for (uint8_t channel = 0; channel < InputCalibration::kNumChannels; channel++) {
+		gates_[channel].set_levels(
+			static_cast<int32_t>(input_cal.raw_at_mv(channel, GateComparator::kRiseMv)),
+			static_cast<int32_t>(input_cal.raw_at_mv(channel, GateComparator::kFallMv)));
+	}
+}
+
+void CvUtils::scan_gates() {
+	// Pairs are compared once each. After a late tick the pairs before the
+	// window are skipped; the comparators pick up from the window. Windows
+	// never hold pairs from a capture pause, so an edge during one is seen in
+	// the first window after it: at most a pot scan and a window late.
+	const CvInCapture::Sample* pairs = cv_capture_.window();
+	const uint32_t first = cv_capture_.window_first();
+	for (uint32_t i = 0; i < CvInCapture::kWindowPairs; i++) {
+		const uint32_t index = first + i;
+		if (static_cast<int32_t>(index - gate_next_pair_) < 0) continue;
+		const uint16_t raw[InputCalibration::kNumChannels] = {pairs[i].raw_a, pairs[i].raw_b};
+		for (uint8_t channel = 0; channel < InputCalibration::kNumChannels; channel++) {
+			const GateComparator::Transition t = gates_[channel].update(raw[channel]);
+			if (t != GateComparator::Transition::kNone) {
+				gate_edges_[channel].add(cv_capture_.sample_time_us(index),
+										 t == GateComparator::Transition::kRise);
+			}
+		}
+	}
+	gate_next_pair_ = first + CvInCapture::kWindowPairs;
+}
+
+void CvUtils::take_edges(uint32_t frame_us, Frame& in) {
+	pulse_in_edges_.drain(pulse_in_.edges(), frame_us);
+	const EdgeInput::State pulse = pulse_in_edges_.take(frame_us);
+	in.pulse = (pulse.high ? Frame::kPulseHigh : 0) | (pulse.rose ? Frame::kPulseRise : 0);
+	in.pulse_us = pulse.rise_age_us;
+
+	const EdgeInput::State gate_a = gate_edges_[InputCalibration::kChannelA].take(frame_us);
+	const EdgeInput::State gate_b = gate_edges_[InputCalibration::kChannelB].take(frame_us);
+	in.gate = (gate_a.high ? Frame::kGateHighA : 0) | (gate_a.rose ? Frame::kGateRiseA : 0) |
+			  (gate_b.high ? Frame::kGateHighB : 0) | (gate_b.rose ? Frame::kGateRiseB : 0);
+	in.gate_rise_age_us[InputCalibration::kChannelA] = gate_a.rise_age_us;
+	in.gate_rise_age_us[InputCalibration::kChannelB] = gate_b.rise_age_us;
+}
+
+void CvUtils::apply_output_coupling(bool calibration_active) {
+	// Calibration measures DC levels; normal modes run AC coupled.
+	const brain::io::AudioCvOutCoupling coupling =
+		calibration_active ? brain::io::AudioCvOutCoupling::kDcCoupled
+						   : brain::io::AudioCvOutCoupling::kAcCoupled;
+	cv_out_.set_coupling(brain::io::AudioCvOutChannel::kChannelA, coupling);
+	cv_out_.set_coupling(brain::io::AudioCvOutChannel::kChannelB, coupling);
+	dsp_calibration_active_ = calibration_active;
+}
+
+// Mode LED state is written by the sample tick on core 0. The reads here are
+// word-sized and display-only, so a stale value costs at most one LED frame.
+void CvUtils::render_leds(uint32_t now) {
+	if (led_controller_.is_startup_active(now)) {
+		led_controller_.render_startup(hal_leds_, now);
+		return;
+	}
 	if (led_controller_.is_mode_override_active(now)) {
 		led_controller_.render_mode_change(
-			leds_, static_cast<uint8_t>(current_mode_), kNumModes, now);
+			hal_leds_, static_cast<uint8_t>(current_mode_), kNumModes, now);
+		return;
+	}
+
+	switch (current_mode_) {
+		case Mode::kAttenuverter:
+			attenuverter_.render_leds(hal_leds_, led_controller_);
+			break;
+		case Mode::kPrecisionAdder:
+			precision_adder_.render_leds(hal_leds_, led_controller_);
+			break;
+		case Mode::kSlew:
+			slew_limiter_.render_leds(hal_leds_, led_controller_);
+			break;
+		case Mode::kAdEnvelope:
+			ad_envelope_.render_leds(hal_leds_, led_controller_);
+			break;
+		case Mode::kCvMixer:
+			cv_mixer_.render_leds(hal_leds_, led_controller_);
+			break;
+		case Mode::kNoise:
+			noise_.render_leds(hal_leds_, led_controller_);
+			break;
 	}
 }
 
 // ---------- Mode cycling ----------
 
-void CvUtils::next_mode() {
+void CvUtils::next_mode(uint32_t now) {
+	// Report tick headroom for the mode being left, then measure the next one fresh.
+	const SampleEngine::Stats stats = sample_engine_.stats();
+	trace::ui.write(now, trace::Event::kModeStats, static_cast<int32_t>(current_mode_),
+					static_cast<int32_t>(stats.ticks), static_cast<int32_t>(stats.deadline_misses),
+					static_cast<int32_t>(stats.worst_tick_us));
+	sample_engine_.reset_stats();
+
 	uint8_t next = (static_cast<uint8_t>(current_mode_) + 1) % kNumModes;
 	set_mode(static_cast<Mode>(next));
-	led_controller_.start_mode_change(time_us_32());
-	printf("Mode: %d\n", static_cast<int>(current_mode_));
+	led_controller_.start_mode_change(now);
+	trace::ui.write(now, trace::Event::kModeChange, static_cast<int32_t>(current_mode_));
+
+	// The outputs are changing function anyway, so a store erase (which stalls
+	// the DSP core for tens of ms) goes here, before the new mode is published.
+	if (settings_store_.maintenance_pending()) settings_store_.maintain();
 }
 
 void CvUtils::set_mode(Mode mode) {
@@ -161,23 +546,50 @@ void CvUtils::set_mode(Mode mode) {
 	leds_.off_all();
 }
 
+// ---------- Session persistence ----------
+
+Mode CvUtils::restore_session() {
+	SessionState state;
+	if (!session_.load(state) || state.mode >= kNumModes) return Mode::kAttenuverter;
+	slew_limiter_.set_linked(state.slew_linked != 0);
+	noise_.set_scale(state.noise_scale);
+	return static_cast<Mode>(state.mode);
+}
+
+SessionState CvUtils::session_state() const {
+	return SessionState{static_cast<uint8_t>(current_mode_),
+						static_cast<uint8_t>(slew_limiter_.linked() ? 1 : 0), noise_.scale(), 0};
+}
+
 // ---------- Calibration mode ----------
 
-void CvUtils::enter_calibration() {
+void CvUtils::enter_calibration(uint32_t now) {
+	// Output coupling follows on core 0 once it sees the new snapshot.
 	calibration_active_ = true;
 	button_a_release_event_ = false;
-	cv_out_.set_coupling(brain::io::AudioCvOutChannel::kChannelA, brain::io::AudioCvOutCoupling::kDcCoupled);
-	cv_out_.set_coupling(brain::io::AudioCvOutChannel::kChannelB, brain::io::AudioCvOutCoupling::kDcCoupled);
+	calibration_.begin(controls_);
 	leds_.off_all();
-	printf("Calibration mode entered\n");
+	trace::ui.write(now, trace::Event::kCalibrationEnter);
 }
 
-void CvUtils::exit_calibration() {
+void CvUtils::exit_calibration(uint32_t now) {
+	// Save while the outputs still hold the reference voltage, so a store
+	// erase (which stalls the DSP core) only holds a DC level.
+	const bool saved = calibration_.save();
+	if (settings_store_.maintenance_pending() && settings_store_.maintain() && !saved) {
+		calibration_.save();
+	}
+	// An unfinished loopback capture would resume on the next entry.
+	calibration_.cancel_input_capture();
 	calibration_active_ = false;
 	button_a_release_event_ = false;
-	cv_out_.set_coupling(brain::io::AudioCvOutChannel::kChannelA, brain::io::AudioCvOutCoupling::kAcCoupled);
-	cv_out_.set_coupling(brain::io::AudioCvOutChannel::kChannelB, brain::io::AudioCvOutCoupling::kAcCoupled);
-	calibration_.save();
+	publish_ui_snapshot();
 	leds_.off_all();
-	printf("Calibration saved, exiting\n");
+	const OutputCalibration& output_cal = calibration_.output();
+	for (uint8_t point = 0; point < OutputCalibration::kNumPoints; ++point) {
+		trace::ui.write(now, trace::Event::kCalibrationPoint, point,
+						output_cal.correction(OutputCalibration::kChannelA, point),
+						output_cal.correction(OutputCalibration::kChannelB, point));
+	}
+	trace::ui.write(now, trace::Event::kCalibrationExit);
 }
@@ -6,11 +6,28 @@
 #include "ad-envelope.h"
 #include "attenuverter.h"
 #include "calibration.h"
+#include "control-snapshot.h"
+#include "cv-in-capture.h"
+#include "cv-in-decimator.h"
 #include "cv-mixer.h"
+#include "edge-queue.h"
+#include "flash-store.h"
+#include "frame.h"
+#include "gate-comparator.h"
+#include "hal-pico.h"
 #include "led-controller.h"
 #include "noise.h"
 #include "precision-adder.h"
+#include "pot-scan-pacer.h"
+#include "profiler.h"
+#include "pulse-in-capture.h"
+#include "pulse-out.h"
+#include "sample-engine.h"
+#include "session.h"
+#include "sigma-delta.h"
 #include "slew-limiter.h"
+#include "snapshot-channel.h"
+#include "trace.h"
 #include "brain-io/audio-cv-in.h"
 #include "brain-io/audio-cv-out.h"
 #include "brain-io/pulse.h"
@@ -29,30 +46,119 @@ enum class Mode : uint8_t {
 	kNoise = 5
 };
 
+// Core 0 runs only CV in -> mode -> CV out from the sample tick.
+// Core 1 owns the UI side: buttons, pots, LEDs, mode switching, calibration UI
+// and stdio. UI state crosses to core 0 through a lock-free snapshot channel.
 class CvUtils {
 public:
 	CvUtils();
 
+	// Core 0: initialize hardware and start the sample tick.
 	void init();
+
+	// Core 1 entry: runs the UI loop forever.
+	void run_ui();
+
+	// One UI loop iteration (core 1).
 	void update();
 
 private:
+	static constexpr uint32_t kSampleRateHz = SampleEngine::kRate8kHz;
+
+	// CV input capture: ADC mux inputs of CV in A/B (GPIO 27/28, the pins
+	// AudioCvIn sets up) and the pair rate, oversampled by the decimation
+	// factor (16 x 8 kHz = 128k pairs/s, 256 kS/s of the ADC's 500).
+	static constexpr uint8_t kCvInAdcInputA = 1;
+	static constexpr uint8_t kCvInAdcInputB = 2;
+	static constexpr uint32_t kCvInCaptureRateHz = cv_in_decimator::kFactor * kSampleRateHz;
+
+	// Settings store: the last flash sectors, worn round-robin.
+	static constexpr uint32_t kSettingsSectors = 4;
+
+	// Everything the DSP core needs from the UI core.
+	struct UiSnapshot {
+		Mode mode;
+		bool calibration_active;
+		ControlSnapshot controls;
+		uint8_t calibration_point;
+	};
+
+	// Profiler stages. Mode stages follow the Mode enum order.
+	enum ProfileStage : uint8_t {
+		kStageButtons = 0,
+		kStagePotScan,
+		kStageCvOut,
+		kStageSnapshotRead,
+		kStageCvIn,
+		kStageModeFirst,
+		kStageCalibration = kStageModeFirst + kNumModes,
+		kNumProfileStages
+	};
+
+	void handle_console();
+
+	// Trace rings -> stdio as hex lines (core 1; decode with tests/trace_decode).
+	static constexpr uint32_t kMaxTraceLinesPerUpdate = 8;
+	void drain_trace();
+	template <typename Ring>
+	uint32_t drain_trace_ring(Ring& ring, uint8_t source, uint32_t& reported_dropped,
+							  uint32_t budget);
+	void write_trace_line(uint8_t source, const trace::Record& record);
+	void read_controls();
+	void publish_ui_snapshot();
+
+	// Sample tick: CV in -> active mode -> CV out. Core 0, interrupt context.
+	// The tick is a one-frame block: brain-sdk's DAC takes one write per sample.
+	// Its codes are staged and written at the start of the next tick. `now` is
+	// the tick's start time from the sample engine: the frame time, and the
+	// only clock read on this core.
+	void process_sample(uint32_t now);
+	void process_block(Mode mode, const BlockParams& params, const Frame* in, Frame* out,
+					   size_t n);
+	void apply_output_coupling(bool calibration_active);
+	// Gate comparator levels in raw codes for the current input calibration.
+	void set_gate_levels();
+	// Runs the gate comparators over the oversampled pairs not yet compared.
+	void scan_gates();
+	// Input edges up to `frame_us` -> the frame's pulse and gate fields.
+	void take_edges(uint32_t frame_us, Frame& in);
+	void render_leds(uint32_t now);
+
 	// Mode cycling
-	void next_mode();
+	void next_mode(uint32_t now);
 	void set_mode(Mode mode);
 
+	// Session persistence: mode and mode options across power cycles
+	Mode restore_session();
+	SessionState session_state() const;
+
 	// Calibration mode
-	void enter_calibration();
-	void exit_calibration();
+	void enter_calibration(uint32_t now);
+	void exit_calibration(uint32_t now);
 
 	// Hardware
 	brain::ui::Button button_a_;
 	brain::ui::Button button_b_;
 	brain::ui::Leds leds_;
 	brain::ui::Pots pots_;
-	brain::io::AudioCvIn cv_in_;
+	brain::io::AudioCvIn cv_in_;     // pin and ADC setup only; cv_capture_ does the sampling
+	CvInCapture cv_capture_;
+	PotScanPacer pot_scan_pacer_;    // UI core: when pots_ may pause cv_capture_
 	brain::io::AudioCvOut cv_out_;
 	brain::io::Pulse pulse_;
+	PulseInCapture pulse_in_;
+
+	// HAL views of the devices, handed to modes
+	hal::PicoCvOut hal_cv_out_;
+	hal::PicoPulse hal_pulse_;
+	PulseOut pulse_out_;  // pulse out jack, timed by a hardware alarm
+	hal::PicoLeds hal_leds_;
+	hal::PicoClock clock_;
+
+	// Persistent settings
+	hal::PicoFlash settings_flash_;
+	FlashStore settings_store_;
+	Session session_;
 
 	// Shared calibration
 	Calibration calibration_;
@@ -66,17 +172,46 @@ private:
 	CvMixer cv_mixer_;
 	Noise noise_;
 
-	// State
+	SampleEngine sample_engine_;
+	Profiler profiler_;
+
+	// Cross-core state
+	SnapshotChannel<UiSnapshot> ui_channel_;
+	UiSnapshot dsp_view_;             // core 0's copy of the latest UI snapshot
+	bool dsp_calibration_active_;     // core 0: coupling currently applied
+
+	// Core 0: input edges, folded into frames by the sample tick
+	EdgeInput pulse_in_edges_;
+	GateComparator gates_[InputCalibration::kNumChannels];
+	EdgeInput gate_edges_[InputCalibration::kNumChannels];
+	uint32_t gate_next_pair_;  // first oversampled pair not yet compared
+
+	// Core 0: dithers the modes' fractions of a code into the DAC codes
+	SigmaDelta output_dither_[OutputCalibration::kNumChannels];
+
+	// UI state (core 1)
+	ControlSnapshot controls_;
 	Mode current_mode_;
 	bool button_a_pressed_;
 	bool button_b_pressed_;
 	bool calibration_active_;
 	bool button_a_release_event_;
+	bool button_b_solo_;           // B is down and A has not been pressed with it
+	bool button_b_release_event_;  // B tapped on its own
 
 	// Long press detection for entering calibration
 	uint32_t both_pressed_since_;  // timestamp when both buttons pressed, 0 if not
 	static constexpr uint32_t kLongPressUs = 1500000;  // 1.5 seconds
 	bool long_press_triggered_;
+
+	// Trace output (core 1)
+	bool trace_output_enabled_;
+	uint32_t trace_dsp_dropped_;   // drop counts already reported
+	uint32_t trace_ui_dropped_;
+
+	// Boot timing, microseconds since reset
+	uint32_t boot_init_us_;
+	volatile uint32_t first_output_us_;  // written once by the first sample tick
 };
 
 #endif  // CV_UTILS_H_
@@ -0,0 +1,116 @@
+#ifndef EDGE_QUEUE_H_
+#define EDGE_QUEUE_H_
+
+#include <atomic>
+#include <cstdint>
+
+// Timestamped digital edges, from the interrupt that sees them to the sample
+// tick that hands them to the modes.
+
+struct Edge {
+	uint32_t time_us;
+	bool rising;
+};
+
+// Lock-free single-producer/single-consumer queue of edges, written from an
+// interrupt handler and read by the sample tick. The producer never waits:
+// when the queue is full the edge is dropped and counted. Only word-sized
+// atomic loads/stores are used (Cortex-M0+ has no exclusive load/store).
+class EdgeQueue {
+public:
+	// Power of two: 32 pulses between two sample ticks, far more than any
+	// clock or trigger input delivers.
+	static constexpr uint32_t kCapacity = 64;
+
+	// Producer side
+	bool push(uint32_t time_us, bool rising) {
+		const uint32_t head = head_.load(std::memory_order_relaxed);
+		if (head - tail_.load(std::memory_order_acquire) >= kCapacity) {
+			dropped_.store(dropped_.load(std::memory_order_relaxed) + 1,
+						   std::memory_order_relaxed);
+			return false;
+		}
+		edges_[head & (kCapacity - 1)] = {time_us, rising};
+		head_.store(head + 1, std::memory_order_release);
+		return true;
+	}
+
+	// Consumer side. Both return false when the queue is empty.
+	bool peek(Edge& out) const {
+		const uint32_t tail = tail_.load(std::memory_order_relaxed);
+		if (tail == head_.load(std::memory_order_acquire)) return false;
+		out = edges_[tail & (kCapacity - 1)];
+		return true;
+	}
+	bool pop(Edge& out) {
+		if (!peek(out)) return false;
+		tail_.store(tail_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+		return true;
+	}
+
+	// Edges dropped because the queue was full, since construction.
+	uint32_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+private:
+	static_assert((kCapacity & (kCapacity - 1)) == 0, "edge queue capacity must be a power of two");
+
+	Edge edges_[kCapacity] = {};
+	std::atomic<uint32_t> head_{0};
+	std::atomic<uint32_t> tail_{0};
+	std::atomic<uint32_t> dropped_{0};
+};
+
+// One input's edges folded into per-frame state: the level at the frame's
+// time, whether it rose since the previous frame (however short the pulse),
+// and how long before the frame the newest rising edge was.
+class EdgeInput {
+public:
+	struct State {
+		bool high;
+		bool rose;
+		uint16_t rise_age_us;
+	};
+
+	explicit EdgeInput(bool high = false) : high_(high) {}
+
+	void add(uint32_t time_us, bool rising) {
+		high_ = rising;
+		if (rising) {
+			rose_ = true;
+			rise_us_ = time_us;
+		}
+	}
+
+	// Moves every queued edge at or before `frame_us` in; later ones (seen
+	// after the tick read the clock) wait for the next frame.
+	void drain(EdgeQueue& queue, uint32_t frame_us) {
+		Edge edge;
+		while (queue.peek(edge) && static_cast<int32_t>(frame_us - edge.time_us) >= 0) {
+			add(edge.time_us, edge.rising);
+			queue.pop(edge);
+		}
+	}
+
+	// State at `frame_us`; clears the rising edge.
+	State take(uint32_t frame_us) {
+		State state{high_, rose_, 0};
+		if (rose_) {
+			// An edge timed just after the frame (a gate pair converted while
+			// the tick was starting) counts as at the frame.
+			const int32_t age = static_cast<int32_t>(frame_us - rise_us_);
+			state.rise_age_us = static_cast<uint16_t>(
+				age < 0 ? 0 : (age > static_cast<int32_t>(kMaxAgeUs) ? kMaxAgeUs : age));
+		}
+		rose_ = false;
+		return state;
+	}
+
+private:
+	static constexpr uint32_t kMaxAgeUs = 0xFFFF;
+
+	bool high_;
+	bool rose_ = false;
+	uint32_t rise_us_ = 0;
+};
+
+#endif  // EDGE_QUEUE_H_
@@ -0,0 +1,77 @@
+#ifndef EXP_TABLE_H_
+#define EXP_TABLE_H_
+
+#include <cstdint>
+
+// Compile-time exp(-x) lookup table with linear interpolation.
+// x is unsigned fixed point; the table covers 0 <= x < kXMax in steps of
+// 1/64, where linear interpolation adds at most 3e-5 (one Q15 step) of
+// error. Beyond the table exp(-x) is treated as 0.
+namespace exp_table {
+
+constexpr int32_t kQ15One = 32768;
+constexpr uint32_t kQ30One = 1u << 30;
+
+constexpr uint32_t kXMax = 8;
+constexpr uint8_t kStepBits = 10;  // table step 1/64 in Q16
+constexpr uint32_t kNumEntries = ((kXMax << 16) >> kStepBits) + 1;
+
+// exp(-x) for 0 <= x <= kXMax, usable in constant expressions: Taylor series
+// on x / 256, then squared back up eight times.
+constexpr double exp_neg(double x) {
+	const double y = -x / 256.0;
+	double term = 1.0;
+	double sum = 1.0;
+	for (int i = 1; i < 12; ++i) {
+		term *= y / i;
+		sum += term;
+	}
+	for (int i = 0; i < 8; ++i) sum *= sum;
+	return sum;
+}
+
+struct Table {
+	uint16_t values[kNumEntries];
+};
+
+constexpr Table make_exp_neg_table() {
+	Table table{};
+	for (uint32_t i = 0; i < kNumEntries; ++i) {
+		const double x = static_cast<double>(i << kStepBits) / 65536.0;
+		table.values[i] = static_cast<uint16_t>(exp_neg(x) * kQ15One + 0.5);
+	}
+	return table;
+}
+
+inline constexpr Table kExpNegQ15 = make_exp_neg_table();
+
+// exp(-x) in Q15 for x in Q16.
+inline constexpr uint16_t exp_neg_q15(uint32_t x_q16) {
+	if (x_q16 >= (kXMax << 16)) return 0;
+	constexpr uint32_t kFracMask = (1u << kStepBits) - 1;
+	const uint32_t index = x_q16 >> kStepBits;
+	const int32_t frac = static_cast<int32_t>(x_q16 & kFracMask);
+	const int32_t lo = kExpNegQ15.values[index];
+	const int32_t hi = kExpNegQ15.values[index + 1];
+	return static_cast<uint16_t>(lo + (((hi - lo) * frac) >> kStepBits));
+}
+
+// 1 - exp(-x) in Q30 for x in Q32: the fraction of the remaining distance an
+// RC (one-pole) stage covers in time x * tau. Below x = 1/64 a three-term
+// series keeps full relative precision for the tiny per-step values of long
+// time constants at high loop rates; above it the Q15 table is used.
+inline constexpr uint32_t one_minus_exp_neg_q30(uint64_t x_q32) {
+	constexpr uint64_t kSeriesLimit = 1ull << 26;  // 1/64 in Q32
+	if (x_q32 < kSeriesLimit) {
+		const uint64_t x2_q32 = (x_q32 * x_q32) >> 32;
+		const uint64_t x3_q32 = (x2_q32 * x_q32) >> 32;
+		return static_cast<uint32_t>((x_q32 - x2_q32 / 2 + x3_q32 / 6) >> 2);
+	}
+	if (x_q32 >= (static_cast<uint64_t>(kXMax) << 32)) return kQ30One;
+	const uint32_t e_q15 = exp_neg_q15(static_cast<uint32_t>(x_q32 >> 16));
+	return kQ30One - (e_q15 << 15);
+}
+
+}  // namespace exp_table
+
+#endif  // EXP_TABLE_H_
@@ -0,0 +1,116 @@
+#include "fixed-point-bench.h"
+
+#include "cv-units.h"
+#include "fixed-point.h"
+#include "pot-curves.h"
+
+namespace fixed_point_bench {
+namespace {
+constexpr uint32_t kSeed = 123456789;
+
+constexpr auto kStageTimeUs = pot_curves::make_table<uint32_t>(pot_curves::envelope_stage_us);
+constexpr auto kIntervalUs = pot_curves::make_table<uint32_t>(pot_curves::noise_interval_us);
+constexpr auto kSlewTimeUs = pot_curves::make_table<uint32_t>(pot_curves::slew_time_us);
+
+// Inputs are carved from one xorshift32 word per iteration: an int16 value,
+// a second int16 from the middle bits, a Q15 gain below 1.0, a pot value and
+// an output level of 0..8.2 V in Q16 mV.
+int32_t value(uint32_t r) { return static_cast<int16_t>(r); }
+int32_t value_b(uint32_t r) { return static_cast<int16_t>(r >> 8); }
+uint16_t gain(uint32_t r) { return static_cast<uint16_t>(r >> 17); }
+uint8_t pot(uint32_t r) { return static_cast<uint8_t>(r >> 24); }
+int32_t mv_q16(uint32_t r) { return static_cast<int32_t>(r >> 3); }
+
+// The precision adder's conversion as first written, one 64-bit multiply
+// (a libgcc call on the M0+), for comparison.
+uint32_t mv_q16_to_code_q8_i64(int32_t mv_q16) {
+	return static_cast<uint32_t>((mv_q16 * int64_t{6870270}) >> 32);
+}
+
+template <typename Op>
+uint32_t run_kernel(uint32_t iterations, Op op) {
+	uint32_t rng = kSeed;
+	uint32_t checksum = 0;
+	for (uint32_t i = 0; i < iterations; ++i) {
+		rng ^= rng << 13;
+		rng ^= rng >> 17;
+		rng ^= rng << 5;
+		checksum += static_cast<uint32_t>(op(rng));
+	}
+	return checksum;
+}
+
+uint32_t baseline(uint32_t n) {
+	return run_kernel(n, [](uint32_t r) { return r; });
+}
+uint32_t mul_q15(uint32_t n) {
+	return run_kernel(n, [](uint32_t r) { return fixed_point::mul_q15(value(r), gain(r)); });
+}
+uint32_t mul_q15_narrow(uint32_t n) {
+	return run_kernel(n, [](uint32_t r) { return fixed_point::mul_q15_narrow(value(r), gain(r)); });
+}
+uint32_t mul_q15_floor(uint32_t n) {
+	return run_kernel(n, [](uint32_t r) { return fixed_point::mul_q15_floor(value(r), gain(r)); });
+}
+uint32_t blend_q15(uint32_t n) {
+	return run_kernel(
+		n, [](uint32_t r) { return fixed_point::blend_q15(value(r), value_b(r), gain(r)); });
+}
+uint32_t blend_q15_narrow(uint32_t n) {
+	return run_kernel(
+		n, [](uint32_t r) { return fixed_point::blend_q15_narrow(value(r), value_b(r), gain(r)); });
+}
+uint32_t u8_to_q15(uint32_t n) {
+	return run_kernel(n, [](uint32_t r) { return fixed_point::u8_to_q15(pot(r)); });
+}
+uint32_t u8_to_q15_shift(uint32_t n) {
+	return run_kernel(n, [](uint32_t r) { return fixed_point::u8_to_q15_shift(pot(r)); });
+}
+uint32_t envelope_curve(uint32_t n) {
+	return run_kernel(n, [](uint32_t r) { return pot_curves::envelope_stage_us(pot(r)); });
+}
+uint32_t envelope_table(uint32_t n) {
+	return run_kernel(n, [](uint32_t r) { return kStageTimeUs[pot(r)]; });
+}
+uint32_t noise_curve(uint32_t n) {
+	return run_kernel(n, [](uint32_t r) { return pot_curves::noise_interval_us(pot(r)); });
+}
+uint32_t noise_table(uint32_t n) {
+	return run_kernel(n, [](uint32_t r) { return kIntervalUs[pot(r)]; });
+}
+uint32_t slew_curve(uint32_t n) {
+	return run_kernel(n, [](uint32_t r) { return pot_curves::slew_time_us(pot(r)); });
+}
+uint32_t slew_table(uint32_t n) {
+	return run_kernel(n, [](uint32_t r) { return kSlewTimeUs[pot(r)]; });
+}
+uint32_t mv_to_code_q8(uint32_t n) {
+	return run_kernel(n, [](uint32_t r) { return cv_units::mv_q16_to_code_q8(mv_q16(r)); });
+}
+uint32_t mv_to_code_q8_i64(uint32_t n) {
+	return run_kernel(n, [](uint32_t r) { return mv_q16_to_code_q8_i64(mv_q16(r)); });
+}
+}  // namespace
+
+const Kernel kKernels[] = {
+	{"baseline", baseline},
+	{"mul_q15", mul_q15},
+	{"mul_q15_narrow", mul_q15_narrow},
+	{"mul_q15_floor", mul_q15_floor},
+	{"blend_q15", blend_q15},
+	{"blend_q15_narrow", blend_q15_narrow},
+	{"u8_to_q15", u8_to_q15},
+	{"u8_to_q15_shift", u8_to_q15_shift},
+	{"envelope curve", envelope_curve},
+	{"envelope table", envelope_table},
+	{"noise curve", noise_curve},
+	{"noise table", noise_table},
+	{"slew curve", slew_curve},
+	{"slew table", slew_table},
+	{"mv_to_code_q8", mv_to_code_q8},
+	{"mv_to_code_q8_i64", mv_to_code_q8_i64},
+};
+
+const uint32_t kNumKernels = sizeof(kKernels) / sizeof(kKernels[0]);
+
+}  // namespace fixed_point_bench
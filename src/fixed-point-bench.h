@@ -0,0 +1,25 @@
+#ifndef FIXED_POINT_BENCH_H_
+#define FIXED_POINT_BENCH_H_
+
+#include <cstdint>
+
+// Microbenchmark kernels for the fixed_point primitives and the pot curves,
+// shared by the host runner (tests/fixed_point_benchmark) and the firmware
+// console ('b'), which times them in SysTick cycles.
+//
+// Each kernel applies one operation to `iterations` pseudo-random inputs and
+// returns a checksum of the results, so the work cannot be optimized away.
+// Kernel 0 is the input generator alone; subtract it from the others.
+namespace fixed_point_bench {
+
+struct Kernel {
+	const char* name;
+	uint32_t (*run)(uint32_t iterations);
+};
+
+extern const Kernel kKernels[];
+extern const uint32_t kNumKernels;
+
+}  // namespace fixed_point_bench
+
+#endif  // FIXED_POINT_BENCH_H_
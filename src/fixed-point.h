@@ -27,6 +27,43 @@ inline constexpr uint16_t u8_to_q15(uint8_t v) {
 	return static_cast<uint16_t>(scaled > kQ15One ? kQ15One : scaled);
 }
 
+// Shift-based variants. Cortex-M0+ has a single-cycle 32-bit multiply but no
+// 64-bit one (a library call), and no divider in the core. The variants below
+// stay in 32 bits and replace the divide with an arithmetic shift; each is
+// checked against its reference by tests/fixed_point_test.
+
+// p / 2^15 rounded toward zero, like the signed divide above: negative p is
+// biased by 2^15 - 1 first. Identical to p / kQ15One for every int32 p.
+inline constexpr int32_t shift_q15_trunc(int32_t p) {
+	return (p + ((p >> 31) & (kQ15One - 1))) >> 15;
+}
+
+// mul_q15 for |value| <= kNarrowMax, where the product fits in 32 bits.
+// Bit-identical to mul_q15 there (millivolts and Q15 values qualify).
+constexpr int32_t kNarrowMax = 65535;
+inline constexpr int32_t mul_q15_narrow(int32_t value, uint16_t gain_q15) {
+	return shift_q15_trunc(value * static_cast<int32_t>(gain_q15));
+}
+
+// mul_q15_narrow rounded toward minus infinity: a plain arithmetic shift.
+// Equal to mul_q15 when the product is >= 0 or a multiple of 2^15, one less
+// otherwise; for paths whose outputs are not pinned to mul_q15.
+inline constexpr int32_t mul_q15_floor(int32_t value, uint16_t gain_q15) {
+	return (value * static_cast<int32_t>(gain_q15)) >> 15;
+}
+
+// blend_q15 for |a|, |b| <= kNarrowMax: the weighted sum is at most
+// kNarrowMax * 2^15 in magnitude. Bit-identical to blend_q15 there.
+inline constexpr int32_t blend_q15_narrow(int32_t a, int32_t b, uint16_t t_q15) {
+	return shift_q15_trunc(a * (kQ15One - t_q15) + b * static_cast<int32_t>(t_q15));
+}
+
+// u8_to_q15 without the divide: v * 32768 / 255 rounded is (v * 257 + 1) / 2
+// for every 8-bit v.
+inline constexpr uint16_t u8_to_q15_shift(uint8_t v) {
+	return static_cast<uint16_t>((static_cast<uint32_t>(v) * 257 + 1) >> 1);
+}
+
 }  // namespace fixed_point
 
 #endif  // FIXED_POINT_H_
@@ -0,0 +1,182 @@
+#include "flash-store.h"
+
+#include <cstring>
+
+namespace {
+
+constexpr uint32_t kPageSize = hal::Flash::kPageSize;
+constexpr uint16_t kRecordMagic = 0x5352;  // "RS"
+
+struct RecordHeader {
+	uint16_t magic;
+	uint8_t key;
+	uint8_t size;
+	uint32_t sequence;
+	uint32_t crc;  // CRC-32 of the fields above and the payload
+};
+static_assert(sizeof(RecordHeader) + FlashStore::kMaxPayload == kPageSize,
+			  "a record header and the largest payload fill one page");
+
+constexpr uint32_t kCrcOffset = 8;
+
+// CRC-32 (IEEE, reflected), four bits at a time.
+constexpr uint32_t kCrcNibbles[16] = {
+	0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4,
+	0x4DB26158, 0x5005713C, 0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C,
+	0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+};
+
+uint32_t crc32(const uint8_t* data, uint32_t length, uint32_t crc = 0) {
+	crc = ~crc;
+	for (uint32_t i = 0; i < length; ++i) {
+		crc ^= data[i];
+		crc = (crc >> 4) ^ kCrcNibbles[crc & 0xF];
+		crc = (crc >> 4) ^ kCrcNibbles[crc & 0xF];
+	}
+	return ~crc;
+}
+
+uint32_t record_crc(const uint8_t* page, uint8_t size) {
+	const uint32_t crc = crc32(page, kCrcOffset);
+	return crc32(page + sizeof(RecordHeader), size, crc);
+}
+
+}  // namespace
+
+FlashStore::FlashStore(hal::Flash& flash)
+	: flash_(flash),
+	  num_sectors_(flash.size() / hal::Flash::kSectorSize),
+	  active_sector_(0),
+	  next_page_(0),
+	  sequence_(1),
+	  next_sector_erased_(false),
+	  newest_{} {}
+
+void FlashStore::init() {
+	for (Newest& n : newest_) n = Newest{};
+	bool any = false;
+	uint32_t newest_page = 0;
+	uint32_t newest_sequence = 0;
+	uint8_t buffer[kPageSize];
+	for (uint32_t page = 0; page < num_pages(); ++page) {
+		uint8_t key;
+		uint8_t size;
+		uint32_t sequence;
+		if (!read_record(page, buffer, key, size, sequence)) continue;
+		Newest& n = newest_[key];
+		if (!n.valid || sequence > n.sequence) n = Newest{true, page, sequence, size};
+		if (!any || sequence > newest_sequence) {
+			any = true;
+			newest_page = page;
+			newest_sequence = sequence;
+		}
+	}
+
+	// Carry on right after the newest record.
+	active_sector_ = any ? sector_of(newest_page) : 0;
+	next_page_ = any ? newest_page + 1 : 0;
+	sequence_ = newest_sequence + 1;
+	next_sector_erased_ = sector_erased(next_sector());
+}
+
+bool FlashStore::load(StoreKey key, void* data, uint32_t size) const {
+	const uint8_t k = static_cast<uint8_t>(key);
+	if (k >= kMaxKeys || !newest_[k].valid || newest_[k].size != size) return false;
+	flash_.read(newest_[k].page * kPageSize + sizeof(RecordHeader), data, size);
+	return true;
+}
+
+bool FlashStore::save(StoreKey key, const void* data, uint32_t size) {
+	const uint8_t k = static_cast<uint8_t>(key);
+	if (k >= kMaxKeys || size > kMaxPayload) return false;
+	return append(k, data, static_cast<uint8_t>(size), false);
+}
+
+bool FlashStore::maintain() {
+	if (next_sector_erased_) return true;
+	const uint32_t target = next_sector();
+
+	uint8_t payload[kMaxPayload];
+	for (uint8_t key = 0; key < kMaxKeys; ++key) {
+		const Newest& n = newest_[key];
+		if (!n.valid || sector_of(n.page) != target) continue;
+		flash_.read(n.page * kPageSize + sizeof(RecordHeader), payload, n.size);
+		if (!append(key, payload, n.size, true)) return false;
+	}
+
+	if (!flash_.erase_sector(target * hal::Flash::kSectorSize)) return false;
+	next_sector_erased_ = sector_erased(target);
+	return next_sector_erased_;
+}
+
+bool FlashStore::page_erased(uint32_t page) const {
+	uint32_t words[kPageSize / sizeof(uint32_t)];
+	flash_.read(page * kPageSize, words, kPageSize);
+	for (uint32_t word : words) {
+		if (word != 0xFFFFFFFFu) return false;
+	}
+	return true;
+}
+
+bool FlashStore::sector_erased(uint32_t sector) const {
+	for (uint32_t i = 0; i < kPagesPerSector; ++i) {
+		if (!page_erased(sector * kPagesPerSector + i)) return false;
+	}
+	return true;
+}
+
+bool FlashStore::read_record(uint32_t page, uint8_t* buffer, uint8_t& key, uint8_t& size,
+							 uint32_t& sequence) const {
+	RecordHeader header;
+	flash_.read(page * kPageSize, &header, sizeof(header));
+	if (header.magic != kRecordMagic || header.key >= kMaxKeys || header.size > kMaxPayload) {
+		return false;
+	}
+	flash_.read(page * kPageSize, buffer, sizeof(RecordHeader) + header.size);
+	if (record_crc(buffer, header.size) != header.crc) return false;
+	key = header.key;
+	size = header.size;
+	sequence = header.sequence;
+	return true;
+}
+
+bool FlashStore::append(uint8_t key, const void* data, uint8_t size, bool use_reserve) {
+	uint8_t page_buffer[kPageSize];
+	memset(page_buffer, 0xFF, sizeof(page_buffer));
+	RecordHeader header{kRecordMagic, key, size, sequence_, 0};
+	memcpy(page_buffer, &header, sizeof(header));
+	memcpy(page_buffer + sizeof(header), data, size);
+	header.crc = record_crc(page_buffer, size);
+	memcpy(page_buffer + kCrcOffset, &header.crc, sizeof(header.crc));
+
+	uint8_t verify[kPageSize];
+	while (true) {
+		if (next_page_ >= num_pages()) next_page_ = 0;
+		if (sector_of(next_page_) != active_sector_) {
+			// Current sector used up: move into the erased one after it.
+			if (!next_sector_erased_) return false;
+			active_sector_ = next_sector();
+			next_page_ = active_sector_ * kPagesPerSector;
+			next_sector_erased_ = sector_erased(next_sector());
+		}
+
+		const uint32_t pages_left = (active_sector_ + 1) * kPagesPerSector - next_page_;
+		if (!next_sector_erased_ && !use_reserve && pages_left <= kReservePages) return false;
+
+		// Pages torn by an earlier power loss are skipped.
+		const uint32_t page = next_page_++;
+		if (!page_erased(page)) continue;
+		if (!flash_.program_page(page * kPageSize, page_buffer)) return false;
+
+		uint8_t read_key;
+		uint8_t read_size;
+		uint32_t read_sequence;
+		if (!read_record(page, verify, read_key, read_size, read_sequence) ||
+			read_sequence != sequence_) {
+			continue;
+		}
+		newest_[key] = Newest{true, page, sequence_, size};
+		++sequence_;
+		return true;
+	}
+}
@@ -0,0 +1,94 @@
+#ifndef FLASH_STORE_H_
+#define FLASH_STORE_H_
+
+#include <cstdint>
+
+#include "hal.h"
+
+// Keys of the records the firmware keeps in the settings store.
+enum class StoreKey : uint8_t {
+	kCalibration = 0,
+	kSession = 1,
+	kInputCalibration = 2,
+};
+
+// Append-only record log over a few reserved flash sectors.
+// Every save programs one fresh page holding one record: key, payload, a
+// sequence number and a CRC-32. At boot the newest valid record of each key
+// wins; a page torn by power loss fails its CRC and is skipped, leaving the
+// previous record in charge.
+//
+// save() never erases. Sectors are filled round-robin, and the sector after
+// the one being filled is kept erased as the next to move into. Once the log
+// moves on, that next sector still holds old records and maintenance is
+// pending: maintain() copies forward any key whose newest record lives there,
+// then erases it. Erasing stalls both cores for tens of milliseconds, so the
+// caller runs maintain() when the outputs can be held. Until it does, saves
+// keep going into the current sector, minus a few pages held back for those
+// copies.
+//
+// Every save stalls both cores too, for the page program: on the order of a
+// millisecond, several sample ticks. Those ticks are dropped and the outputs
+// hold their last codes; SampleEngine counts them as a deadline miss and
+// stalled periods. Callers keep saves rare (see Session).
+//
+// UI core only.
+class FlashStore {
+public:
+	static constexpr uint8_t kMaxKeys = 4;
+	static constexpr uint32_t kMaxPayload = hal::Flash::kPageSize - 12;
+
+	// The region must be at least two sectors.
+	explicit FlashStore(hal::Flash& flash);
+
+	// Scans the region for the newest record of each key.
+	void init();
+
+	// Copies the newest payload of `key` into `data`. False if there is none
+	// or it was saved with a different size.
+	bool load(StoreKey key, void* data, uint32_t size) const;
+
+	// Appends a record; it replaces the previous one for `key` once this
+	// returns true. False if the current sector is full and maintenance is
+	// still pending, or programming failed.
+	bool save(StoreKey key, const void* data, uint32_t size);
+
+	bool maintenance_pending() const { return !next_sector_erased_; }
+
+	// Copies forward live records and erases the next sector. False if
+	// something failed; nothing live is erased and it can be retried.
+	bool maintain();
+
+private:
+	struct Newest {
+		bool valid;
+		uint32_t page;
+		uint32_t sequence;
+		uint8_t size;
+	};
+
+	uint32_t num_pages() const { return num_sectors_ * kPagesPerSector; }
+	uint32_t sector_of(uint32_t page) const { return page / kPagesPerSector; }
+	uint32_t next_sector() const { return (active_sector_ + 1) % num_sectors_; }
+
+	bool page_erased(uint32_t page) const;
+	bool sector_erased(uint32_t sector) const;
+	// Validates the record in `page`; fills `buffer` (one page) and the header fields.
+	bool read_record(uint32_t page, uint8_t* buffer, uint8_t& key, uint8_t& size,
+					 uint32_t& sequence) const;
+	bool append(uint8_t key, const void* data, uint8_t size, bool use_reserve);
+
+	static constexpr uint32_t kPagesPerSector = hal::Flash::kSectorSize / hal::Flash::kPageSize;
+	// Pages at the end of a sector held back for maintain() to copy into.
+	static constexpr uint32_t kReservePages = kMaxKeys;
+
+	hal::Flash& flash_;
+	uint32_t num_sectors_;
+	uint32_t active_sector_;
+	uint32_t next_page_;  // first page to try, over the whole region
+	uint32_t sequence_;   // of the next record
+	bool next_sector_erased_;
+	Newest newest_[kMaxKeys];
+};
+
+#endif  // FLASH_STORE_H_
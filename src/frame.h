@@ -0,0 +1,54 @@
+#ifndef FRAME_H_
+#define FRAME_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "control-snapshot.h"
+
+// One sample period of module I/O. In an input frame a/b are CV in A/B as
+// calibrated signal millivolts (-5000..+5000 nominal, see
+// input-calibration.h); in an output frame they are DAC codes
+// (0..4095 == 0..10V).
+struct Frame {
+	// Input only: pulse input level.
+	static constexpr uint8_t kPulseHigh = 1u << 0;
+	// Input: rising edge on the pulse input since the previous frame, even a
+	// pulse that ended before the frame.
+	// Output: a pulse of pulse_us starting at the frame's time. Output pulses
+	// are timed by the pulse scheduler (pulse-scheduler.h), which restarts a
+	// pulse still running.
+	static constexpr uint8_t kPulseRise = 1u << 1;
+
+	// Input only: gate comparators on CV in A/B (gate-comparator.h), level
+	// and rising edge since the previous frame.
+	static constexpr uint8_t kGateHighA = 1u << 0;
+	static constexpr uint8_t kGateHighB = 1u << 1;
+	static constexpr uint8_t kGateRiseA = 1u << 2;
+	static constexpr uint8_t kGateRiseB = 1u << 3;
+
+	int16_t a;
+	int16_t b;
+	uint8_t pulse;
+	uint8_t gate = 0;
+	// Input: microseconds from the newest pulse rising edge to the frame's
+	// time, so a trigger can start between frames. Output: width of the
+	// pulse requested with kPulseRise.
+	uint16_t pulse_us = 0;
+	// Input only: the same age for each gate rising edge.
+	uint16_t gate_rise_age_us[2] = {};
+	// Output only: the fraction of a DAC code above a/b, in 1/256 codes. The
+	// output stage dithers it in over successive frames (sigma-delta.h); at 0
+	// the DAC gets exactly a/b.
+	uint8_t code_frac[2] = {};
+};
+
+// Parameters held constant across one process() block. Frame i of the block
+// is at start_us + i * period_us.
+struct BlockParams {
+	ControlSnapshot controls;
+	uint32_t start_us;
+	uint32_t period_us;
+};
+
+#endif  // FRAME_H_
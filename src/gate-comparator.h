@@ -0,0 +1,52 @@
+#ifndef GATE_COMPARATOR_H_
+#define GATE_COMPARATOR_H_
+
+#include <cstdint>
+
+// Schmitt trigger that turns a CV input into a gate. On target it runs on
+// every oversampled ADC pair, with the thresholds converted to raw codes for
+// the channel's calibration (InputCalibration::raw_at_mv), so a gate edge is
+// placed to within one pair period. Host harnesses run it on millivolts.
+class GateComparator {
+public:
+	// The gate opens at 1 V and closes below 0.9 V; the hysteresis is well
+	// above the ADC's noise at the pair rate, so a slow edge gives one trigger.
+	static constexpr int32_t kRiseMv = 1000;
+	static constexpr int32_t kFallMv = 900;
+
+	enum class Transition : uint8_t {
+		kNone = 0,
+		kRise,
+		kFall
+	};
+
+	constexpr GateComparator() : GateComparator(kRiseMv, kFallMv) {}
+	constexpr GateComparator(int32_t rise_level, int32_t fall_level)
+		: rise_level_(rise_level), fall_level_(fall_level) {}
+
+	// Opens at or above rise_level, closes below fall_level.
+	void set_levels(int32_t rise_level, int32_t fall_level) {
+		rise_level_ = rise_level;
+		fall_level_ = fall_level;
+	}
+
+	Transition update(int32_t level) {
+		if (high_) {
+			if (level >= fall_level_) return Transition::kNone;
+			high_ = false;
+			return Transition::kFall;
+		}
+		if (level < rise_level_) return Transition::kNone;
+		high_ = true;
+		return Transition::kRise;
+	}
+
+	bool high() const { return high_; }
+
+private:
+	int32_t rise_level_;
+	int32_t fall_level_;
+	bool high_ = false;
+};
+
+#endif  // GATE_COMPARATOR_H_
@@ -0,0 +1,136 @@
+#ifndef HAL_PICO_H_
+#define HAL_PICO_H_
+
+#include <cstring>
+#include <utility>
+
+#include "hal.h"
+#include "brain-io/audio-cv-out.h"
+#include "brain-io/pulse.h"
+#include "brain-ui/leds.h"
+#include "hardware/flash.h"
+#include "hardware/regs/addressmap.h"
+#include "pico/flash.h"
+#include "pico/time.h"
+
+// brain-sdk backed implementations of the HAL interfaces.
+namespace hal {
+
+class PicoCvOut final : public CvOut {
+public:
+	explicit PicoCvOut(brain::io::AudioCvOut& device) : device_(device) {}
+
+	// brain-sdk only accepts volts, so the code is converted once here with a
+	// single multiply instead of each mode doing its own float math. The
+	// conversion happens on staging, so latch() is just the two DAC writes.
+	// They are separate blocking SPI transfers, one per channel, so B changes
+	// one transfer after A: brain-sdk's AudioCvOut owns the bus and has no
+	// two-channel write, LDAC or DMA path.
+	void stage(CvOutChannel channel, uint16_t code) override {
+		staged_volts_[static_cast<uint8_t>(channel)] = static_cast<float>(code) * kVoltsPerCode;
+		staged_ = true;
+	}
+
+	bool latch() override {
+		if (!staged_) return false;
+		staged_ = false;
+		device_.set_voltage(brain::io::AudioCvOutChannel::kChannelA, staged_volts_[0]);
+		device_.set_voltage(brain::io::AudioCvOutChannel::kChannelB, staged_volts_[1]);
+		return true;
+	}
+
+private:
+	static constexpr float kVoltsPerCode = 10.0f / 4095.0f;
+
+	brain::io::AudioCvOut& device_;
+	float staged_volts_[2] = {};
+	bool staged_ = false;
+};
+
+class PicoPulse final : public Pulse {
+public:
+	explicit PicoPulse(brain::io::Pulse& device) : device_(device) {}
+	void on_rise(std::function<void()> callback) override { device_.on_rise(std::move(callback)); }
+	void poll() override { device_.poll(); }
+	bool read() override { return device_.read(); }
+	void set(bool high) override { device_.set(high); }
+
+private:
+	brain::io::Pulse& device_;
+};
+
+class PicoLeds final : public Leds {
+public:
+	explicit PicoLeds(brain::ui::Leds& device) : device_(device) {}
+	void on(uint8_t index) override { device_.on(index); }
+	void off(uint8_t index) override { device_.off(index); }
+	void off_all() override { device_.off_all(); }
+	void set_brightness(uint8_t index, uint8_t brightness) override {
+		device_.set_brightness(index, brightness);
+	}
+
+private:
+	brain::ui::Leds& device_;
+};
+
+class PicoClock final : public Clock {
+public:
+	uint32_t now_us() const override { return time_us_32(); }
+};
+
+// The last `num_sectors` sectors of the program flash. Both cores execute
+// from flash, so program and erase run through flash_safe_execute: interrupts
+// off here and, once the other core has called flash_safe_execute_core_init(),
+// that core parked in RAM until the operation is done. Its interrupts are off
+// while parked, so sample ticks are dropped for a page program as well as for
+// an erase.
+class PicoFlash final : public Flash {
+public:
+	static_assert(kPageSize == FLASH_PAGE_SIZE && kSectorSize == FLASH_SECTOR_SIZE,
+				  "hal::Flash geometry must match the flash chip");
+
+	explicit PicoFlash(uint32_t num_sectors)
+		: size_(num_sectors * kSectorSize), base_(PICO_FLASH_SIZE_BYTES - size_) {}
+
+	uint32_t size() const override { return size_; }
+
+	void read(uint32_t offset, void* out, uint32_t size) const override {
+		memcpy(out, reinterpret_cast<const void*>(XIP_BASE + base_ + offset), size);
+	}
+
+	bool program_page(uint32_t offset, const uint8_t* data) override {
+		Operation op{base_ + offset, data};
+		return flash_safe_execute(program_operation, &op, kLockoutTimeoutMs) == PICO_OK;
+	}
+
+	bool erase_sector(uint32_t offset) override {
+		Operation op{base_ + offset, nullptr};
+		return flash_safe_execute(erase_operation, &op, kLockoutTimeoutMs) == PICO_OK;
+	}
+
+private:
+	// How long to wait for the other core to reach its lockout handler
+	static constexpr uint32_t kLockoutTimeoutMs = 100;
+
+	struct Operation {
+		uint32_t flash_offset;
+		const uint8_t* data;
+	};
+
+	static void program_operation(void* param) {
+		const auto* op = static_cast<const Operation*>(param);
+		flash_range_program(op->flash_offset, op->data, kPageSize);
+	}
+
+	static void erase_operation(void* param) {
+		const auto* op = static_cast<const Operation*>(param);
+		flash_range_erase(op->flash_offset, kSectorSize);
+	}
+
+	uint32_t size_;
+	uint32_t base_;
+};
+
+}  // namespace hal
+
+#endif  // HAL_PICO_H_
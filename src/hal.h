@@ -0,0 +1,80 @@
+#ifndef HAL_H_
+#define HAL_H_
+
+#include <cstdint>
+#include <functional>
+
+// Thin hardware abstraction for the mode classes. On target these forward to
+// the brain-sdk devices (hal-pico.h); host builds drive them with in-memory
+// fakes so the real mode code can be tested and benchmarked off-target.
+namespace hal {
+
+enum class CvOutChannel : uint8_t {
+	kChannelA = 0,
+	kChannelB = 1
+};
+
+class CvIn {
+public:
+	virtual ~CvIn() = default;
+	virtual uint16_t get_raw_channel_a() const = 0;
+	virtual uint16_t get_raw_channel_b() const = 0;
+	virtual float get_voltage_channel_a() const = 0;
+	virtual float get_voltage_channel_b() const = 0;
+};
+
+// Outputs take DAC codes (0..4095 == 0..10V) so modes stay in integer math.
+// Codes are staged per channel and written out on latch(), at a fixed point
+// in the tick rather than wherever the mode finished. How close together the
+// two channels change is up to the implementation. latch() returns false if
+// nothing was staged since the last one.
+class CvOut {
+public:
+	virtual ~CvOut() = default;
+	virtual void stage(CvOutChannel channel, uint16_t code) = 0;
+	virtual bool latch() = 0;
+};
+
+class Pulse {
+public:
+	virtual ~Pulse() = default;
+	virtual void on_rise(std::function<void()> callback) = 0;
+	virtual void poll() = 0;
+	virtual bool read() = 0;
+	virtual void set(bool high) = 0;
+};
+
+class Leds {
+public:
+	virtual ~Leds() = default;
+	virtual void on(uint8_t index) = 0;
+	virtual void off(uint8_t index) = 0;
+	virtual void off_all() = 0;
+	virtual void set_brightness(uint8_t index, uint8_t brightness) = 0;
+};
+
+class Clock {
+public:
+	virtual ~Clock() = default;
+	virtual uint32_t now_us() const = 0;
+};
+
+// A reserved region of NOR flash, addressed from its start. Programming
+// writes one whole page and can only clear bits, so it goes to erased (0xFF)
+// pages; erasing returns a whole sector to 0xFF. Both return false if the
+// operation could not be run.
+class Flash {
+public:
+	static constexpr uint32_t kPageSize = 256;
+	static constexpr uint32_t kSectorSize = 4096;
+
+	virtual ~Flash() = default;
+	virtual uint32_t size() const = 0;
+	virtual void read(uint32_t offset, void* out, uint32_t size) const = 0;
+	virtual bool program_page(uint32_t offset, const uint8_t* data) = 0;
+	virtual bool erase_sector(uint32_t offset) = 0;
+};
+
+}  // namespace hal
+
+#endif  // HAL_H_
@@ -0,0 +1,72 @@
+#include "input-calibration.h"
+
+namespace {
+bool near_nominal(int32_t value_q4, int32_t nominal_q4) {
+	const int32_t error = value_q4 - nominal_q4;
+	return error <= InputCalibration::kMaxEndpointErrorQ4 &&
+		   error >= -InputCalibration::kMaxEndpointErrorQ4;
+}
+}  // namespace
+
+InputCalibration::InputCalibration() {
+	for (uint8_t channel = 0; channel < kNumChannels; ++channel) {
+		endpoints_[channel] = kNominal;
+		update_slope(channel);
+	}
+}
+
+bool InputCalibration::fit(int32_t low_mv, int32_t low_q4, int32_t high_mv, int32_t high_q4,
+						   Endpoints& out) {
+	if (high_mv <= low_mv || high_q4 <= low_q4) return false;
+	// Extend the line to +-kEndpointMv, rounding to nearest.
+	const int64_t span_q4 = high_q4 - low_q4;
+	const int64_t span_mv = high_mv - low_mv;
+	auto at = [&](int32_t mv) {
+		const int64_t scaled = static_cast<int64_t>(mv - low_mv) * span_q4;
+		const int64_t rounded =
+			scaled >= 0 ? (scaled + span_mv / 2) / span_mv : -((-scaled + span_mv / 2) / span_mv);
+		return static_cast<int32_t>(low_q4 + rounded);
+	};
+	out.minus_q4 = at(-kEndpointMv);
+	out.plus_q4 = at(kEndpointMv);
+	return true;
+}
+
+bool InputCalibration::plausible(const Endpoints& endpoints) {
+	return near_nominal(endpoints.minus_q4, kNominal.minus_q4) &&
+		   near_nominal(endpoints.plus_q4, kNominal.plus_q4);
+}
+
+bool InputCalibration::set_endpoints(uint8_t channel, const Endpoints& endpoints) {
+	if (channel >= kNumChannels || !plausible(endpoints)) return false;
+	endpoints_[channel] = endpoints;
+	update_slope(channel);
+	return true;
+}
+
+uint32_t InputCalibration::raw_at_mv(uint8_t channel, int32_t mv) const {
+	// Readings rise with the code, so bisect.
+	uint32_t low = 0;
+	uint32_t high = kNumCodes;
+	while (low < high) {
+		const uint32_t mid = (low + high) / 2;
+		if (to_signal_mv(channel, static_cast<uint16_t>(mid)) >= mv) {
+			high = mid;
+		} else {
+			low = mid + 1;
+		}
+	}
+	return low;
+}
+
+void InputCalibration::update_slope(uint8_t channel) {
+	// 64-bit only here, on the UI core when the endpoints change.
+	const Endpoints& e = endpoints_[channel];
+	const int64_t span_q4 = e.plus_q4 - e.minus_q4;
+	const int64_t full_scale_q18 = static_cast<int64_t>(2 * kEndpointMv) << kSlopeShift;
+	center_q4_[channel] = e.minus_q4 + static_cast<int32_t>(span_q4 / 2);
+	slope_q18_[channel] = static_cast<int32_t>((full_scale_q18 + span_q4 / 2) / span_q4);
+	offset_q18_[channel] = static_cast<int32_t>(
+		((span_q4 / 2) * full_scale_q18 + span_q4 / 2) / span_q4 -
+		(static_cast<int64_t>(kEndpointMv) << kSlopeShift) + (1 << (kSlopeShift - 1)));
+}
@@ -0,0 +1,108 @@
+#ifndef INPUT_CALIBRATION_H_
+#define INPUT_CALIBRATION_H_
+
+#include <cstdint>
+
+// ADC reading -> calibrated input signal in millivolts, per channel.
+// Each channel is calibrated by its readings at -5V and +5V. Readings are
+// first straightened with a model of the ADC's differential non-linearity,
+// then mapped linearly between the endpoints. The input stage straightens
+// every oversampled reading and averages them (cv-in-decimator.h), so only
+// the line is applied per sample tick, and modes only ever see millivolts.
+//
+// Endpoints change on the UI core at boot and at the end of a capture in
+// calibration mode, when the sample tick is not converting inputs.
+class InputCalibration {
+public:
+	static constexpr uint8_t kChannelA = 0;
+	static constexpr uint8_t kChannelB = 1;
+	static constexpr uint8_t kNumChannels = 2;
+	static constexpr uint32_t kNumCodes = 4096;
+	static constexpr int32_t kEndpointMv = 5000;
+
+	// Linearized readings at -5V and +5V, in 1/16 codes so averaged captures
+	// keep their sub-code precision.
+	struct Endpoints {
+		int32_t minus_q4;
+		int32_t plus_q4;
+	};
+
+	// RP2040 ADC (erratum RP2040-E11): codes 512, 1536, 2560 and 3584 are
+	// several LSB wide instead of one, so every code above each of them reads
+	// low by that extra width. A wide code maps to its centre.
+	static constexpr uint16_t kDnlFirstSpike = 512;
+	static constexpr uint16_t kDnlSpikePeriod = 1024;
+	static constexpr int32_t kDnlExtraWidthQ4 = 8 << 4;
+
+	// ADC code straightened for DNL, in 1/16 codes.
+	static constexpr int32_t linearize_q4(uint16_t raw) {
+		raw &= kNumCodes - 1;
+		const int32_t spikes_passed = (raw + kDnlSpikePeriod - kDnlFirstSpike) / kDnlSpikePeriod;
+		const bool on_spike = raw % kDnlSpikePeriod == kDnlFirstSpike;
+		return static_cast<int32_t>(raw) * 16 + spikes_passed * kDnlExtraWidthQ4 -
+			   (on_spike ? kDnlExtraWidthQ4 / 2 : 0);
+	}
+
+	// Typical unit: raw 298 at -5V and 3723 at +5V.
+	static const Endpoints kNominal;
+	// Endpoints further than this from nominal are rejected as a bad capture.
+	static constexpr int32_t kMaxEndpointErrorQ4 = 256 << 4;
+
+	// Nominal endpoints on both channels.
+	InputCalibration();
+
+	// Line through two measurements: signal millivolts and the mean linearized
+	// reading there. False if the points cannot define a rising line.
+	static bool fit(int32_t low_mv, int32_t low_q4, int32_t high_mv, int32_t high_q4,
+					Endpoints& out);
+
+	// True if both endpoints are within kMaxEndpointErrorQ4 of nominal.
+	static bool plausible(const Endpoints& endpoints);
+
+	const Endpoints& endpoints(uint8_t channel) const { return endpoints_[channel]; }
+
+	// Applies and rebuilds the channel's table; false (and nothing changed) if
+	// the endpoints are implausible.
+	bool set_endpoints(uint8_t channel, const Endpoints& endpoints);
+
+	// Straightened reading (1/16 codes, e.g. a decimated mean, within the
+	// ADC's range) -> millivolts. One 32-bit multiply: measured from the
+	// middle of the line, the reading times the Q18 slope fits in 31 bits for
+	// any plausible endpoints.
+	int16_t linear_to_signal_mv(uint8_t channel, int32_t linear_q4) const {
+		return clamp_mv(((linear_q4 - center_q4_[channel]) * slope_q18_[channel] +
+						 offset_q18_[channel]) >>
+						kSlopeShift);
+	}
+
+	// Single raw ADC code -> millivolts.
+	int16_t to_signal_mv(uint8_t channel, uint16_t raw) const {
+		return linear_to_signal_mv(channel, linearize_q4(raw));
+	}
+
+	// Lowest raw code that reads at or above `mv` (kNumCodes if none does), so
+	// a threshold can be compared against raw readings directly.
+	uint32_t raw_at_mv(uint8_t channel, int32_t mv) const;
+
+private:
+	static constexpr uint32_t kSlopeShift = 18;
+
+	static int16_t clamp_mv(int32_t mv) {
+		return static_cast<int16_t>(mv < -32768 ? -32768 : (mv > 32767 ? 32767 : mv));
+	}
+
+	void update_slope(uint8_t channel);
+
+	Endpoints endpoints_[kNumChannels];
+	// The line, rebuilt with the endpoints: a reading near its middle,
+	// millivolts per 1/16 code in Q18, and the signal at that reading in Q18
+	// millivolts plus the rounding half.
+	int32_t center_q4_[kNumChannels];
+	int32_t slope_q18_[kNumChannels];
+	int32_t offset_q18_[kNumChannels];
+};
+
+inline constexpr InputCalibration::Endpoints InputCalibration::kNominal = {
+	InputCalibration::linearize_q4(298), InputCalibration::linearize_q4(3723)};
+
+#endif  // INPUT_CALIBRATION_H_
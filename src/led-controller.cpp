@@ -1,16 +1,50 @@
 #include "led-controller.h"
 
+#include "cv-units.h"
+
 namespace {
-float clampf(float v, float lo, float hi) {
-	return v < lo ? lo : (v > hi ? hi : v);
+constexpr int32_t kDacCenter = cv_units::kDacCenter;
+constexpr int32_t kZones = 3;
+constexpr int32_t kMaxBrightness = 255;
+
+// magnitude3 is 3x the distance from center, so each zone spans kDacCenter.
+uint8_t vu_brightness(int32_t magnitude3, int32_t zone_index) {
+	const int32_t level = magnitude3 - zone_index * kDacCenter;
+	if (level <= 0) return 0;
+	if (level >= kDacCenter) return kMaxBrightness;
+	return static_cast<uint8_t>((level * kMaxBrightness) / kDacCenter);
 }
 
-uint8_t vu_brightness(float magnitude, float zone_index, float zone_size) {
-	return static_cast<uint8_t>(
-		clampf((magnitude - zone_index * zone_size) * 255.0f / zone_size, 0.0f, 255.0f));
+int32_t magnitude3(uint16_t code) {
+	int32_t mag = static_cast<int32_t>(code) - kDacCenter;
+	if (mag < 0) mag = -mag;
+	if (mag > kDacCenter) mag = kDacCenter;
+	return mag * kZones;
 }
 }  // namespace
 
+void LedController::start_startup(uint32_t now_us) {
+	startup_started_us_ = now_us;
+	startup_active_ = true;
+}
+
+bool LedController::is_startup_active(uint32_t now_us) const {
+	return startup_active_ && now_us - startup_started_us_ < kStartupUs;
+}
+
+void LedController::render_startup(hal::Leds& leds, uint32_t now_us) const {
+	// One LED lit, stepping up the row and back down.
+	const uint32_t step = (now_us - startup_started_us_) / kStartupStepUs;
+	const uint32_t lit = step < kNumLeds ? step : 2 * kNumLeds - 1 - step;
+	for (uint8_t i = 0; i < kNumLeds; i++) {
+		if (i == lit) {
+			leds.on(i);
+		} else {
+			leds.off(i);
+		}
+	}
+}
+
 void LedController::start_mode_change(uint32_t now_us) {
 	mode_led_override_started_us_ = now_us;
 	mode_led_override_until_us_ = now_us + kModeLedHoldUs;
@@ -20,7 +54,7 @@ bool LedController::is_mode_override_active(uint32_t now_us) const {
 	return static_cast<int32_t>(now_us - mode_led_override_until_us_) < 0;
 }
 
-void LedController::render_mode_change(brain::ui::Leds& leds, uint8_t mode_index,
+void LedController::render_mode_change(hal::Leds& leds, uint8_t mode_index,
 									   uint8_t num_modes, uint32_t now_us) const {
 	const uint32_t elapsed = now_us - mode_led_override_started_us_;
 	const uint32_t phase = elapsed / kModeLedBlinkHalfPeriodUs;
@@ -40,18 +74,17 @@ void LedController::render_mode_change(brain::ui::Leds& leds, uint8_t mode_index
 	}
 }
 
-void LedController::render_output_vu(brain::ui::Leds& leds, float out_a_voltage,
-									 float out_b_voltage) const {
-	// Output domain is 0..10V with 5V as bipolar center.
-	const float mag_a = clampf(out_a_voltage >= 5.0f ? out_a_voltage - 5.0f : 5.0f - out_a_voltage, 0.0f, 5.0f);
-	const float mag_b = clampf(out_b_voltage >= 5.0f ? out_b_voltage - 5.0f : 5.0f - out_b_voltage, 0.0f, 5.0f);
-	const float kZone = 5.0f / 3.0f;
+void LedController::render_output_vu(hal::Leds& leds, uint16_t out_a_code,
+									 uint16_t out_b_code) const {
+	// Output domain is 0..10V (DAC 0..4095) with 5V as bipolar center.
+	const int32_t mag_a = magnitude3(out_a_code);
+	const int32_t mag_b = magnitude3(out_b_code);
 
-	leds.set_brightness(0, vu_brightness(mag_a, 0.0f, kZone));
-	leds.set_brightness(1, vu_brightness(mag_a, 1.0f, kZone));
-	leds.set_brightness(2, vu_brightness(mag_a, 2.0f, kZone));
+	leds.set_brightness(0, vu_brightness(mag_a, 0));
+	leds.set_brightness(1, vu_brightness(mag_a, 1));
+	leds.set_brightness(2, vu_brightness(mag_a, 2));
 
-	leds.set_brightness(3, vu_brightness(mag_b, 0.0f, kZone));
-	leds.set_brightness(4, vu_brightness(mag_b, 1.0f, kZone));
-	leds.set_brightness(5, vu_brightness(mag_b, 2.0f, kZone));
+	leds.set_brightness(3, vu_brightness(mag_b, 0));
+	leds.set_brightness(4, vu_brightness(mag_b, 1));
+	leds.set_brightness(5, vu_brightness(mag_b, 2));
 }
@@ -3,18 +3,29 @@
 
 #include <cstdint>
 
-#include "brain-ui/leds.h"
+#include "hal.h"
 
 class LedController {
 public:
+	// Power-on sweep across the LEDs, drawn by render_startup() from the UI
+	// loop while the DSP core is already running.
+	void start_startup(uint32_t now_us);
+	bool is_startup_active(uint32_t now_us) const;
+	void render_startup(hal::Leds& leds, uint32_t now_us) const;
+
 	void start_mode_change(uint32_t now_us);
 	bool is_mode_override_active(uint32_t now_us) const;
-	void render_mode_change(brain::ui::Leds& leds, uint8_t mode_index,
+	void render_mode_change(hal::Leds& leds, uint8_t mode_index,
 							uint8_t num_modes, uint32_t now_us) const;
-	void render_output_vu(brain::ui::Leds& leds, float out_a_voltage,
-						  float out_b_voltage) const;
+	// VU of each output's distance from the 5V center, from DAC codes.
+	void render_output_vu(hal::Leds& leds, uint16_t out_a_code,
+						  uint16_t out_b_code) const;
 
 private:
+	static constexpr uint8_t kNumLeds = 6;
+	static constexpr uint32_t kStartupStepUs = 60000;  // 60ms per LED
+	static constexpr uint32_t kStartupUs = kStartupStepUs * kNumLeds * 2;  // up and back
+
 	static constexpr uint32_t kModeLedBlinkHalfPeriodUs = 100000;  // 100ms
 	static constexpr uint32_t kModeLedBlinkCount = 3;
 	static constexpr uint32_t kModeLedHoldUs =
@@ -22,6 +33,8 @@ private:
 
 	uint32_t mode_led_override_started_us_ = 0;
 	uint32_t mode_led_override_until_us_ = 0;
+	uint32_t startup_started_us_ = 0;
+	bool startup_active_ = false;
 };
 
 #endif  // LED_CONTROLLER_H_
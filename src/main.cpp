@@ -1,16 +1,26 @@
+#include <pico/multicore.h>
 #include <pico/stdlib.h>
 #include <stdio.h>
 
 #include "cv-utils.h"
 
-int main() {
+namespace {
+CvUtils cv_utils;
+
+// Core 1: UI side and stdio
+void core1_main() {
 	stdio_init_all();
+	cv_utils.run_ui();
+}
+}  // namespace
 
-	CvUtils cv_utils;
+int main() {
+	// Core 0: CV in -> mode -> CV out, driven by the sample tick
 	cv_utils.init();
+	multicore_launch_core1(core1_main);
 
 	while (true) {
-		cv_utils.update();
+		__wfi();
 	}
 
 	return 0;
@@ -3,33 +3,34 @@
 
 #include <cstdint>
 
+#include "frame.h"
+#include "hal.h"
 #include "led-controller.h"
-#include "brain-io/audio-cv-out.h"
-#include "brain-io/pulse.h"
-#include "brain-ui/leds.h"
-#include "brain-ui/pots.h"
+#include "quantizer.h"
 
 class Noise {
 public:
 	Noise();
 
-	void update(brain::ui::Pots& pots, brain::io::AudioCvOut& cv_out,
-				brain::io::Pulse& pulse, bool button_b_pressed, brain::ui::Leds& leds,
-				LedController& led_controller);
+	// Ignores the CV inputs; reads and drives the pulse bits of the frames.
+	void process(const BlockParams& params, const Frame* in, Frame* out, size_t n);
+	void render_leds(hal::Leds& leds, const LedController& led_controller) const;
+
+	// Quantizer scale index (chosen with button B + pot 3 by process()),
+	// persisted per session. Out-of-range indices select the last scale.
+	uint8_t scale() const { return static_cast<uint8_t>(active_scale_); }
+	void set_scale(uint8_t scale_index);
+
+	// Random step value (0..4095) -> DAC code within center +- range_half,
+	// clamped to the DAC range.
+	static uint16_t scale_step(uint16_t raw, uint16_t range_half);
 
 private:
 	// PRNG (xorshift32)
 	static uint32_t next_random(uint32_t seed);
 
-	// Convert pot value (0-255) to interval in microseconds (logarithmic)
-	static uint32_t pot_to_interval_us(uint8_t pot_value);
-
-	// Quantize a DAC value (0-4095) to the nearest note in the active scale
-	// Returns quantized DAC value
-	uint16_t quantize(uint16_t dac_value) const;
-
 	// Show active scale on LEDs (one LED lit per scale)
-	static void render_scale_select(brain::ui::Leds& leds, uint8_t scale_index);
+	static void render_scale_select(hal::Leds& leds, uint8_t scale_index);
 
 	// Scale definitions
 	enum class Scale : uint8_t {
@@ -42,23 +43,8 @@ private:
 	};
 	static constexpr uint8_t kNumScales = 6;
 
-	// Note tables: intervals in semitones from root (within one octave)
-	// Stored as {note_count, semitone[]}
-	static const uint8_t kMajorNotes[];
-	static const uint8_t kMinorNotes[];
-	static const uint8_t kPentatonicNotes[];
-	static const uint8_t kWholeToneNotes[];
-
-	static constexpr uint8_t kMajorCount = 7;
-	static constexpr uint8_t kMinorCount = 7;
-	static constexpr uint8_t kPentatonicCount = 5;
-	static constexpr uint8_t kWholeToneCount = 6;
-
-	// 1V/oct: one semitone in DAC units
-	// Full range 0-4095 = 0-10V = 10 octaves, 120 semitones
-	// 1 semitone = 4095 / 120 ≈ 34.125 DAC units
-	// Use fixed-point: semitone_dac * 256 for precision
-	static constexpr uint32_t kSemitoneDac256 = 8736;  // 34.125 * 256
+	// Quantizer table per scale, nullptr for unquantized
+	static const quantizer::Table* const kScaleTables[kNumScales];
 
 	static constexpr uint8_t kPotSpeedA = 0;
 	static constexpr uint8_t kPotSpeedB = 1;
@@ -66,24 +52,31 @@ private:
 	static constexpr uint16_t kDacMax = 4095;
 	static constexpr uint16_t kDacCenter = 2048;
 
-	// Timing range
-	static constexpr uint32_t kMinIntervalUs = 1000;
-	static constexpr uint32_t kMaxIntervalUs = 2000000;
-	static constexpr uint32_t kPulseWidthUs = 10000;
+	static constexpr uint16_t kPulseWidthUs = 10000;
 
 	// State per channel
 	struct ChannelState {
 		uint32_t last_update_us;
 		uint16_t current_value;
+		uint8_t current_frac;  // quantized notes' fraction of a code, 1/256
 	};
 
 	ChannelState ch_a_;
 	ChannelState ch_b_;
 	uint32_t rng_state_;
-	uint32_t pulse_off_at_us_;
-	bool pulse_active_;
-	bool pulse_in_prev_high_;
 	Scale active_scale_;
+	quantizer::Quantizer quantizer_;
+
+	// LED feedback, rendered from the UI loop
+	static constexpr int8_t kNoLed = -1;
+	int8_t step_led_index_;
+	bool scale_select_active_;
+
+	// Pot-derived parameters
+	PotWatch pot_watch_;
+	uint32_t interval_a_us_;
+	uint32_t interval_b_us_;
+	uint16_t range_half_;
 };
 
 #endif  // NOISE_H_
@@ -0,0 +1,40 @@
+#include "output-calibration.h"
+
+#include "cv-units.h"
+
+OutputCalibration::OutputCalibration() : corrections_{} {
+	for (uint8_t channel = 0; channel < kNumChannels; ++channel) {
+		rebuild(channel);
+	}
+}
+
+uint16_t OutputCalibration::point_code(uint8_t point) {
+	return cv_units::mv_to_dac(static_cast<int32_t>(point) * 1000);
+}
+
+void OutputCalibration::set_correction(uint8_t channel, uint8_t point, int16_t correction_codes) {
+	if (channel >= kNumChannels || point >= kNumPoints) return;
+	corrections_[channel][point] = correction_codes;
+}
+
+void OutputCalibration::rebuild(uint8_t channel) {
+	if (channel >= kNumChannels) return;
+	const int16_t* corrections = corrections_[channel];
+	uint16_t* table = tables_[channel];
+	for (uint8_t point = 0; point + 1 < kNumPoints; ++point) {
+		const int32_t code_lo = point_code(point);
+		const int32_t code_hi = point_code(static_cast<uint8_t>(point + 1));
+		const int32_t span = code_hi - code_lo;
+		const int32_t corr_lo = corrections[point];
+		const int32_t delta = corrections[point + 1] - corr_lo;
+		// The last segment also covers its end point.
+		const int32_t end = point + 2 == kNumPoints ? code_hi + 1 : code_hi;
+		for (int32_t code = code_lo; code < end; ++code) {
+			const int32_t offset = code - code_lo;
+			const int32_t scaled = delta * offset;
+			const int32_t correction = corr_lo + (scaled >= 0 ? (scaled + span / 2) / span
+															 : -((-scaled + span / 2) / span));
+			table[code] = cv_units::clamp_dac(code + correction);
+		}
+	}
+}
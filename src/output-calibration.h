@@ -0,0 +1,59 @@
+#ifndef OUTPUT_CALIBRATION_H_
+#define OUTPUT_CALIBRATION_H_
+
+#include <cstdint>
+
+// Piecewise-linear output calibration: a correction in DAC codes at every
+// volt from 0V to 10V per channel, expanded into a DAC code -> DAC code table.
+// Modes write ideal codes; the output stage sends each one through apply(),
+// a single table load, so every mode gets the same 1V/oct correction.
+//
+// Tables are rebuilt by the UI core (at boot and while calibrating) and read
+// by the sample tick. Entries are rewritten one halfword at a time, so a
+// rebuild during playback can mix old and new entries for the few hundred
+// microseconds it takes, never tear one.
+class OutputCalibration {
+public:
+	static constexpr uint8_t kChannelA = 0;
+	static constexpr uint8_t kChannelB = 1;
+	static constexpr uint8_t kNumChannels = 2;
+	static constexpr uint8_t kNumPoints = 11;  // 0V, 1V, ... 10V
+	static constexpr uint32_t kNumCodes = 4096;
+
+	// Identity tables (all corrections zero).
+	OutputCalibration();
+
+	// Ideal DAC code of calibration point `point` (point volts).
+	static uint16_t point_code(uint8_t point);
+
+	int16_t correction(uint8_t channel, uint8_t point) const {
+		return corrections_[channel][point];
+	}
+	// Sets one point; call rebuild() afterwards to apply.
+	void set_correction(uint8_t channel, uint8_t point, int16_t correction_codes);
+
+	// Re-expands the channel's points into its table.
+	void rebuild(uint8_t channel);
+
+	// Codes past the DAC range get the top code's correction.
+	uint16_t apply(uint8_t channel, uint16_t code) const {
+		return tables_[channel][code < kNumCodes ? code : kNumCodes - 1];
+	}
+
+	// apply() for code + frac_q8 / 256, interpolated between the two table
+	// entries, in 1/256 codes. The top code has no entry above it to
+	// interpolate towards, so it and anything past it ignore the fraction.
+	uint32_t apply_q8(uint8_t channel, uint16_t code, uint8_t frac_q8) const {
+		const uint32_t lo = apply(channel, code);
+		if (frac_q8 == 0 || code >= kNumCodes - 1) return lo << 8;
+		const uint16_t hi = apply(channel, static_cast<uint16_t>(code + 1));
+		const int32_t step = static_cast<int32_t>(hi) - static_cast<int32_t>(lo);
+		return static_cast<uint32_t>(static_cast<int32_t>(lo << 8) + step * frac_q8);
+	}
+
+private:
+	int16_t corrections_[kNumChannels][kNumPoints];
+	uint16_t tables_[kNumChannels][kNumCodes];
+};
+
+#endif  // OUTPUT_CALIBRATION_H_
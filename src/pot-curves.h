@@ -0,0 +1,80 @@
+#ifndef POT_CURVES_H_
+#define POT_CURVES_H_
+
+#include <cstdint>
+
+// Compile-time lookup tables for pot (0-255) response curves. Build one with
+//   constexpr auto kTable = pot_curves::make_table<uint32_t>(curve);
+// where curve is a constexpr function of the 8-bit pot value.
+namespace pot_curves {
+
+constexpr uint32_t kNumPotValues = 256;
+
+template <typename T>
+struct Table {
+	T values[kNumPotValues];
+
+	constexpr T operator[](uint8_t pot_value) const { return values[pot_value]; }
+};
+
+template <typename T, typename Curve>
+constexpr Table<T> make_table(Curve curve) {
+	Table<T> table{};
+	for (uint32_t i = 0; i < kNumPotValues; ++i) {
+		table.values[i] = curve(static_cast<uint8_t>(i));
+	}
+	return table;
+}
+
+// The modes' curves. Each mode builds its table from one of these; they live
+// here so they can also be timed and checked on their own.
+
+// AD envelope stage time: x^3 mapped to 1 ms..5 s.
+constexpr uint32_t kEnvelopeMinUs = 1000;
+constexpr uint32_t kEnvelopeMaxUs = 5000000;
+constexpr uint32_t envelope_stage_us(uint8_t pot_value) {
+	if (pot_value == 0) return kEnvelopeMinUs;
+	// Use 64-bit to avoid overflow: (x*x*x) can be up to 255^3 = 16581375
+	const uint64_t x = pot_value;
+	const uint64_t cubed = x * x * x;
+	const uint64_t max_cubed = 255ULL * 255 * 255;
+	return static_cast<uint32_t>(kEnvelopeMinUs +
+								 (cubed * (kEnvelopeMaxUs - kEnvelopeMinUs)) / max_cubed);
+}
+
+// Noise step interval (cubic taper): 1 ms..2 s.
+constexpr uint32_t kNoiseMinIntervalUs = 1000;
+constexpr uint32_t kNoiseMaxIntervalUs = 2000000;
+constexpr uint32_t noise_interval_us(uint8_t pot_value) {
+	if (pot_value == 0) return kNoiseMinIntervalUs;
+	const uint32_t pot32 = static_cast<uint32_t>(pot_value);
+	const uint32_t range = kNoiseMaxIntervalUs - kNoiseMinIntervalUs;
+	const uint32_t t = (pot32 * pot32 * pot32) / (255UL * 255UL);
+	const uint32_t interval = kNoiseMinIntervalUs + (t * range) / 255UL;
+	return interval > kNoiseMaxIntervalUs ? kNoiseMaxIntervalUs : interval;
+}
+
+// Slew limiter rate: cubic taper keeps more knob travel in the slower slew
+// region. Q15, 0..1.
+constexpr uint16_t slew_rate_q15(uint8_t pot_value) {
+	constexpr uint32_t kPotCubeMax = 255UL * 255 * 255;
+	constexpr uint32_t kQ15One = 32768;
+	if (pot_value == 0) return 0;
+	const uint32_t p = pot_value;
+	const uint32_t p3 = p * p * p;
+	const uint64_t scaled = (static_cast<uint64_t>(p3) * kQ15One + (kPotCubeMax / 2)) / kPotCubeMax;
+	return static_cast<uint16_t>(scaled > kQ15One ? kQ15One : scaled);
+}
+
+// Slew limiter full-scale time: up to ~2 s; 0 means no slew (coefficient 1).
+constexpr uint32_t kSlewMaxUs = 2000000;
+constexpr uint32_t kSlewMinDenominatorUs = 2000;  // Mirrors old 0.001f threshold.
+constexpr uint32_t slew_time_us(uint8_t pot_value) {
+	const uint32_t time_us =
+		static_cast<uint32_t>((static_cast<uint64_t>(slew_rate_q15(pot_value)) * kSlewMaxUs) / 32768);
+	return time_us <= kSlewMinDenominatorUs ? 0 : time_us;
+}
+
+}  // namespace pot_curves
+
+#endif  // POT_CURVES_H_
@@ -0,0 +1,34 @@
+#ifndef POT_SCAN_PACER_H_
+#define POT_SCAN_PACER_H_
+
+#include <cstdint>
+
+// Paces the UI core's pot scans. The pots share the ADC with CV input
+// capture, so every scan pauses capture and leaves a gap of unconverted
+// pairs. A scan is due kIntervalUs after the previous one started, and a
+// slow scan pushes the next one out further, so capture is paused for at
+// most kMaxPausedPercent of the time however long scans take.
+class PotScanPacer {
+public:
+	static constexpr uint32_t kIntervalUs = 4000;  // 250 Hz, well above knob speed
+	static constexpr uint32_t kMaxPausedPercent = 5;
+
+	bool due(uint32_t now_us) const {
+		return !scanned_ || static_cast<int32_t>(now_us - next_us_) >= 0;
+	}
+
+	// The scan ran from start_us to end_us.
+	void scanned(uint32_t start_us, uint32_t end_us) {
+		const uint32_t spacing_us = (end_us - start_us) * (100 / kMaxPausedPercent);
+		next_us_ = start_us + (spacing_us > kIntervalUs ? spacing_us : kIntervalUs);
+		scanned_ = true;
+	}
+
+private:
+	static_assert(100 % kMaxPausedPercent == 0, "scan spacing must be a whole multiple");
+
+	uint32_t next_us_ = 0;
+	bool scanned_ = false;
+};
+
+#endif  // POT_SCAN_PACER_H_
@@ -1,60 +1,76 @@
 #include "precision-adder.h"
 
+#include "cv-units.h"
+
 namespace {
-int32_t clamp32(int32_t v, int32_t lo, int32_t hi) {
-	return v < lo ? lo : (v > hi ? hi : v);
+constexpr int32_t kFullScaleMvQ16 = cv_units::kDacFullScaleMv << 16;
+
+int32_t clamp_output_q16(int32_t mv_q16) {
+	return mv_q16 < 0 ? 0 : (mv_q16 > kFullScaleMvQ16 ? kFullScaleMvQ16 : mv_q16);
+}
+
+void write_code(uint32_t code_q8, int16_t& code, uint8_t& frac) {
+	code = static_cast<int16_t>(code_q8 >> 8);
+	frac = static_cast<uint8_t>(code_q8 & 0xFF);
 }
+}  // namespace
+
+void PrecisionAdder::process(const BlockParams& params, const Frame* in, Frame* out,
+							 size_t n) {
+	update_offsets(params.controls);
+	smoother_ch1_.set_period_us(params.period_us);
+	smoother_ch2_.set_period_us(params.period_us);
+	// Input millivolts to the output domain (-5V = 0 mV = code 0), plus offset
+	const int32_t offset_ch1 = (cv_units::kCenterMv << 16) + offset_ch1_q16_;
+	const int32_t offset_ch2 = (cv_units::kCenterMv << 16) + offset_ch2_q16_;
+
+	for (size_t i = 0; i < n; ++i) {
+		// Clamped before smoothing, so leaving the rails is not delayed, and
+		// the smoother never leaves the range of its targets.
+		const int32_t target_a_q16 =
+			clamp_output_q16((static_cast<int32_t>(in[i].a) << 16) + offset_ch1);
+		const int32_t target_b_q16 =
+			clamp_output_q16((static_cast<int32_t>(in[i].b) << 16) + offset_ch2);
+		write_code(cv_units::mv_q16_to_code_q8(smoother_ch1_.process_q16(target_a_q16)),
+				   out[i].a, out[i].code_frac[0]);
+		write_code(cv_units::mv_q16_to_code_q8(smoother_ch2_.process_q16(target_b_q16)),
+				   out[i].b, out[i].code_frac[1]);
+		out[i].pulse = 0;
+	}
+
+	if (n > 0) {
+		out_a_code_ = out[n - 1].a;
+		out_b_code_ = out[n - 1].b;
+	}
 }
 
-void PrecisionAdder::update(brain::ui::Pots& pots, brain::io::AudioCvIn& cv_in,
-							brain::io::AudioCvOut& cv_out,
-							Calibration& calibration, bool button_b_pressed,
-							brain::ui::Leds& leds, LedController& led_controller) {
-	(void)button_b_pressed;
-	constexpr int32_t kMaxMillivolts = 10000;
+void PrecisionAdder::update_offsets(const ControlSnapshot& controls) {
+	const bool octave_ch1_changed = pot_watch_.changed(controls, kPotOctaveCh1);
+	const bool octave_ch2_changed = pot_watch_.changed(controls, kPotOctaveCh2);
+	const bool fine_changed = pot_watch_.changed(controls, kPotFineTune);
+	if (!octave_ch1_changed && !octave_ch2_changed && !fine_changed) return;
+
 	// Pot 1/2: octave offset — map 0-255 to -4..+4 (9 steps)
-	int8_t octave_ch1 = static_cast<int8_t>(pots.get(kPotOctaveCh1) * 9 / 256) - 4;
-	int8_t octave_ch2 = static_cast<int8_t>(pots.get(kPotOctaveCh2) * 9 / 256) - 4;
+	int8_t octave_ch1 = static_cast<int8_t>(controls.pots[kPotOctaveCh1] * 9 / 256) - 4;
+	int8_t octave_ch2 = static_cast<int8_t>(controls.pots[kPotOctaveCh2] * 9 / 256) - 4;
 
 	// Pot 3: fine tune bipolar
-	const uint8_t fine_raw = pots.get(kPotFineTune);
-	int16_t fine_tune = 0;
+	const uint8_t fine_raw = controls.pots[kPotFineTune];
+	int32_t fine_tune = 0;
 	if (fine_raw > 128) {
-		fine_tune = static_cast<int16_t>(
-			(static_cast<int32_t>(fine_raw - 128) * kFineTuneMax + 63) / 127);
+		fine_tune = static_cast<int32_t>(
+			(static_cast<int64_t>(fine_raw - 128) * kFineTuneMaxQ16 + 63) / 127);
 	} else if (fine_raw < 128) {
-		fine_tune = static_cast<int16_t>(
-			-((static_cast<int32_t>(128 - fine_raw) * kFineTuneMax + 64) / 128));
+		fine_tune = static_cast<int32_t>(
+			-((static_cast<int64_t>(128 - fine_raw) * kFineTuneMaxQ16 + 64) / 128));
 	}
 
-	// Offsets in DAC units
-	int16_t offset_ch1 = static_cast<int16_t>(octave_ch1) * kDacPerVolt + fine_tune;
-	int16_t offset_ch2 = static_cast<int16_t>(octave_ch2) * kDacPerVolt + fine_tune;
-
-	// Read raw ADC and map to DAC domain
-	int32_t dac_ch1 = static_cast<int32_t>(cv_in.get_raw_channel_a() - kAdcAtMinus5V) *
-					  kDacMax / kAdcSpan;
-	int32_t dac_ch2 = static_cast<int32_t>(cv_in.get_raw_channel_b() - kAdcAtMinus5V) *
-					  kDacMax / kAdcSpan;
-
-	// Apply calibration: gain trim + offset trim
-	dac_ch1 = dac_ch1 * (Calibration::kCalibScale + calibration.gain_trim_a()) / Calibration::kCalibScale;
-	dac_ch2 = dac_ch2 * (Calibration::kCalibScale + calibration.gain_trim_b()) / Calibration::kCalibScale;
-	dac_ch1 += calibration.offset_trim_a();
-	dac_ch2 += calibration.offset_trim_b();
-
-	// Add offset and clamp
-	dac_ch1 = clamp32(dac_ch1 + offset_ch1, 0, kDacMax);
-	dac_ch2 = clamp32(dac_ch2 + offset_ch2, 0, kDacMax);
-
-	const int32_t target_a_mv = (dac_ch1 * kMaxMillivolts + (kDacMax / 2)) / kDacMax;
-	const int32_t target_b_mv = (dac_ch2 * kMaxMillivolts + (kDacMax / 2)) / kDacMax;
-	const int32_t smooth_a_mv = smoother_ch1_.process(target_a_mv);
-	const int32_t smooth_b_mv = smoother_ch2_.process(target_b_mv);
-
-	const float out_a_voltage = static_cast<float>(smooth_a_mv) / 1000.0f;
-	const float out_b_voltage = static_cast<float>(smooth_b_mv) / 1000.0f;
-	cv_out.set_voltage(brain::io::AudioCvOutChannel::kChannelA, out_a_voltage);
-	cv_out.set_voltage(brain::io::AudioCvOutChannel::kChannelB, out_b_voltage);
-	led_controller.render_output_vu(leds, out_a_voltage, out_b_voltage);
+	// Offsets in millivolts, Q16
+	offset_ch1_q16_ = octave_ch1 * kOctaveMvQ16 + fine_tune;
+	offset_ch2_q16_ = octave_ch2 * kOctaveMvQ16 + fine_tune;
+}
+
+void PrecisionAdder::render_leds(hal::Leds& leds,
+								 const LedController& led_controller) const {
+	led_controller.render_output_vu(leds, out_a_code_, out_b_code_);
 }
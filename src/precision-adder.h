@@ -3,45 +3,51 @@
 
 #include <cstdint>
 
-#include "calibration.h"
-#include "brain-io/audio-cv-in.h"
-#include "brain-io/audio-cv-out.h"
-#include "brain-ui/leds.h"
-#include "brain-ui/pots.h"
+#include "adaptive-smoother.h"
+#include "frame.h"
+#include "hal.h"
 #include "led-controller.h"
-#include "voltage-smoother.h"
 
 class PrecisionAdder {
 public:
-	void update(brain::ui::Pots& pots, brain::io::AudioCvIn& cv_in,
-				brain::io::AudioCvOut& cv_out,
-				Calibration& calibration, bool button_b_pressed,
-				brain::ui::Leds& leds, LedController& led_controller);
+	void process(const BlockParams& params, const Frame* in, Frame* out, size_t n);
+	void render_leds(hal::Leds& leds, const LedController& led_controller) const;
 
 private:
 	static constexpr uint8_t kPotOctaveCh1 = 0;
 	static constexpr uint8_t kPotOctaveCh2 = 1;
 	static constexpr uint8_t kPotFineTune = 2;
 
-	static constexpr uint16_t kDacMax = 4095;
+	// Recompute the pot-derived channel offsets if any pot moved.
+	void update_offsets(const ControlSnapshot& controls);
 
-	// 1V/oct: 4095 DAC units / 10V = ~410 DAC units per volt
-	static constexpr int16_t kDacPerVolt = 410;
+	// Offsets are millivolts in Q16, so a semitone (83.3 mV, 34.125 DAC codes)
+	// is exact to well under a cent; the output carries the fraction of a code
+	// for the output stage to dither in.
+	static constexpr int32_t kOctaveMvQ16 = 1000 << 16;
+	static constexpr int32_t kSemitoneMvQ16 = (kOctaveMvQ16 + 6) / 12;
 
-	// Fine tune: ±5 semitones ≈ ±170 DAC units
-	static constexpr int16_t kFineTuneMax = 34 * 5;
+	// Fine tune: ±5 semitones
+	static constexpr int32_t kFineTuneMaxQ16 = 5 * kSemitoneMvQ16;
 
-	// ADC raw values at calibration points
-	static constexpr uint16_t kAdcAtMinus5V = 298;
-	static constexpr uint16_t kAdcAtPlus5V = 3723;
-	static constexpr uint16_t kAdcSpan = kAdcAtPlus5V - kAdcAtMinus5V;
+	// Output smoothing: held pitch steady to well under a DAC code, note and
+	// octave jumps through in about a millisecond.
+	static constexpr uint32_t kSmoothingMinCutoffMilliHz = 1000;
+	static constexpr uint32_t kSmoothingSpeedGain = 10;  // mHz per mV/s
+	static constexpr uint32_t kSmoothingDerivativeCutoffMilliHz = 20000;
 
-	// Anti-jitter smoothing (small deadband, no extra lag by default).
-	static constexpr int32_t kSmoothingDeadbandMv = 7;
-	static constexpr uint16_t kSmoothingAlphaQ15 = 16384;	// 0.5
+	AdaptiveSmoother smoother_ch1_{kSmoothingMinCutoffMilliHz, kSmoothingSpeedGain,
+								   kSmoothingDerivativeCutoffMilliHz};
+	AdaptiveSmoother smoother_ch2_{kSmoothingMinCutoffMilliHz, kSmoothingSpeedGain,
+								   kSmoothingDerivativeCutoffMilliHz};
 
-	VoltageSmoother smoother_ch1_{kSmoothingDeadbandMv, kSmoothingAlphaQ15};
-	VoltageSmoother smoother_ch2_{kSmoothingDeadbandMv, kSmoothingAlphaQ15};
+	// Pot-derived offsets in millivolts, Q16
+	PotWatch pot_watch_;
+	int32_t offset_ch1_q16_ = 0;
+	int32_t offset_ch2_q16_ = 0;
+
+	uint16_t out_a_code_ = 2048;
+	uint16_t out_b_code_ = 2048;
 };
 
 #endif  // PRECISION_ADDER_H_
@@ -0,0 +1,72 @@
+#include "profiler.h"
+
+#include <stdio.h>
+
+#include "hardware/clocks.h"
+
+namespace {
+// SysTick CSR: ENABLE (bit 0) | CLKSOURCE = processor clock (bit 2)
+constexpr uint32_t kSysTickEnableProcessorClock = 0x5;
+constexpr uint8_t kFirstBucketLog2 = 6;
+}  // namespace
+
+void Profiler::init_core() {
+	systick_hw->csr = 0;
+	systick_hw->rvr = kCounterMask;
+	systick_hw->cvr = 0;
+	systick_hw->csr = kSysTickEnableProcessorClock;
+}
+
+uint8_t Profiler::bucket_for(uint32_t cycles) {
+	uint8_t bucket = 0;
+	cycles >>= kFirstBucketLog2;
+	while (cycles != 0 && bucket < kNumBuckets - 1) {
+		cycles >>= 1;
+		bucket++;
+	}
+	return bucket;
+}
+
+uint32_t Profiler::lap(uint8_t stage, uint32_t start) {
+	const uint32_t end = now();
+	const uint32_t cycles = (start - end) & kCounterMask;
+	if (stage >= kMaxStages) return end;
+
+	StageStats& s = stages_[stage];
+	const uint32_t generation = generation_;
+	if (s.generation != generation) {
+		s = StageStats{};
+		s.generation = generation;
+		s.min_cycles = UINT32_MAX;
+	}
+
+	s.count++;
+	s.total_cycles += cycles;
+	if (cycles < s.min_cycles) s.min_cycles = cycles;
+	if (cycles > s.max_cycles) s.max_cycles = cycles;
+	s.histogram[bucket_for(cycles)]++;
+	return end;
+}
+
+void Profiler::dump(const char* const* names, uint8_t num_stages) const {
+	const uint32_t cycles_per_us = clock_get_hz(clk_sys) / 1000000;
+	const uint32_t generation = generation_;
+
+	printf("\n--- profile (%lu cycles/us) ---\n", static_cast<unsigned long>(cycles_per_us));
+	printf("%-16s %8s %8s %8s %8s %9s  histogram (<64, <128, ... cycles)\n", "stage", "count",
+		   "min", "avg", "max", "max_us");
+	for (uint8_t i = 0; i < num_stages && i < kMaxStages; i++) {
+		const StageStats s = stages_[i];
+		if (s.generation != generation || s.count == 0) continue;
+
+		const uint32_t avg = static_cast<uint32_t>(s.total_cycles / s.count);
+		printf("%-16s %8lu %8lu %8lu %8lu %9lu ", names[i], static_cast<unsigned long>(s.count),
+			   static_cast<unsigned long>(s.min_cycles), static_cast<unsigned long>(avg),
+			   static_cast<unsigned long>(s.max_cycles),
+			   static_cast<unsigned long>(s.max_cycles / cycles_per_us));
+		for (uint8_t b = 0; b < kNumBuckets; b++) {
+			printf(" %lu", static_cast<unsigned long>(s.histogram[b]));
+		}
+		printf("\n");
+	}
+}
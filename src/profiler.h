@@ -0,0 +1,57 @@
+#ifndef PROFILER_H_
+#define PROFILER_H_
+
+#include <cstdint>
+
+#include "hardware/structs/systick.h"
+
+// Always-on stage profiler built on the per-core SysTick cycle counter.
+// Each stage keeps count/min/avg/max and a log2 histogram of cycle counts in a
+// fixed RAM block. Recording costs two counter reads and a handful of adds, so
+// it stays enabled in production builds.
+//
+// A stage must only be recorded from one core. Reset and dump may run on the
+// other core: reset bumps a generation that each stage applies lazily on its
+// next record, so the recording side never takes a lock.
+class Profiler {
+public:
+	static constexpr uint8_t kMaxStages = 16;
+	// Bucket 0: < 64 cycles, bucket i: [2^(i+5), 2^(i+6)), last bucket open-ended.
+	static constexpr uint8_t kNumBuckets = 12;
+
+	// Enable SysTick as a free-running 24-bit cycle counter. Call once on each
+	// core that records stages.
+	static void init_core();
+
+	// Current SysTick value. SysTick counts down.
+	static uint32_t now() { return systick_hw->cvr; }
+
+	// Record the cycles since `start` against `stage` and return the current
+	// counter value, so consecutive stages can be chained.
+	uint32_t lap(uint8_t stage, uint32_t start);
+
+	// Request a reset of every stage (applied lazily by the recording core).
+	void reset() { generation_ = generation_ + 1; }
+
+	// Print all recorded stages over stdio. `names` has one entry per stage.
+	void dump(const char* const* names, uint8_t num_stages) const;
+
+private:
+	static constexpr uint32_t kCounterMask = 0x00FFFFFF;
+
+	struct StageStats {
+		uint32_t generation;
+		uint32_t count;
+		uint32_t min_cycles;
+		uint32_t max_cycles;
+		uint64_t total_cycles;
+		uint32_t histogram[kNumBuckets];
+	};
+
+	static uint8_t bucket_for(uint32_t cycles);
+
+	StageStats stages_[kMaxStages] = {};
+	volatile uint32_t generation_ = 1;
+};
+
+#endif  // PROFILER_H_
@@ -0,0 +1,41 @@
+#include "pulse-in-capture.h"
+
+#include "hardware/gpio.h"
+#include "hardware/irq.h"
+#include "pico/time.h"
+
+PulseInCapture* PulseInCapture::instance_ = nullptr;
+
+void PulseInCapture::start(uint32_t gpio, bool inverted) {
+	gpio_ = gpio;
+	inverted_ = inverted;
+	instance_ = this;
+	gpio_add_raw_irq_handler(gpio, on_irq);
+	gpio_set_irq_enabled(gpio, GPIO_IRQ_EDGE_RISE | GPIO_IRQ_EDGE_FALL, true);
+	irq_set_priority(IO_IRQ_BANK0, PICO_HIGHEST_IRQ_PRIORITY);
+	irq_set_enabled(IO_IRQ_BANK0, true);
+}
+
+bool PulseInCapture::read() const {
+	return gpio_get(gpio_) != inverted_;
+}
+
+void PulseInCapture::on_irq() {
+	PulseInCapture* const self = instance_;
+	const uint32_t now = time_us_32();
+	const uint32_t events = gpio_get_irq_event_mask(self->gpio_);
+	const uint32_t both = GPIO_IRQ_EDGE_RISE | GPIO_IRQ_EDGE_FALL;
+	if ((events & both) == 0) return;
+	gpio_acknowledge_irq(self->gpio_, events & both);
+
+	const uint32_t jack_rise = self->inverted_ ? GPIO_IRQ_EDGE_FALL : GPIO_IRQ_EDGE_RISE;
+	if ((events & both) != both) {
+		self->edges_.push(now, (events & jack_rise) != 0);
+		return;
+	}
+	// Both edges latched before the handler ran: a pulse (or a gap) shorter
+	// than the interrupt latency. The level now tells which came last.
+	const bool high = self->read();
+	self->edges_.push(now, !high);
+	self->edges_.push(now, high);
+}
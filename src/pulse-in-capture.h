@@ -0,0 +1,37 @@
+#ifndef PULSE_IN_CAPTURE_H_
+#define PULSE_IN_CAPTURE_H_
+
+#include <cstdint>
+
+#include "edge-queue.h"
+
+// Interrupt-driven capture of the pulse input. Every rising and falling edge
+// is timestamped in the GPIO interrupt and queued for the sample tick, so
+// triggers keep their exact time and a pulse shorter than a tick is never
+// missed. The interrupt runs at the highest priority on the core that calls
+// start(), ahead of the sample tick, and only reads the clock and queues.
+class PulseInCapture {
+public:
+	// gpio: the pulse input pin, already set up as an input. inverted: the pin
+	// reads low while the jack is high.
+	void start(uint32_t gpio, bool inverted);
+
+	// Jack level now.
+	bool read() const;
+
+	// Consumer side, for the sample tick.
+	EdgeQueue& edges() { return edges_; }
+	const EdgeQueue& edges() const { return edges_; }
+
+private:
+	static void on_irq();
+
+	// The GPIO interrupt is shared by all pins; only one capture is installed.
+	static PulseInCapture* instance_;
+
+	EdgeQueue edges_;
+	uint32_t gpio_ = 0;
+	bool inverted_ = false;
+};
+
+#endif  // PULSE_IN_CAPTURE_H_
@@ -0,0 +1,43 @@
+#include "pulse-out.h"
+
+#include "hardware/timer.h"
+#include "pico/time.h"
+
+PulseOut* PulseOut::instance_ = nullptr;
+
+void PulseOut::start() {
+	instance_ = this;
+	pin_.set(false);
+	alarm_ = hardware_alarm_claim_unused(true);
+	hardware_alarm_set_callback(static_cast<unsigned>(alarm_), on_alarm);
+}
+
+void PulseOut::request(uint32_t start_us, uint32_t width_us) {
+	scheduler_.request(start_us, width_us);
+	service();
+}
+
+void PulseOut::on_alarm(unsigned alarm_num) {
+	(void)alarm_num;
+	instance_->service();
+}
+
+void PulseOut::service() {
+	while (true) {
+		const uint64_t now_64 = time_us_64();
+		const uint32_t now = static_cast<uint32_t>(now_64);
+		const bool level = scheduler_.update(now);
+		if (level != level_) {
+			pin_.set(level);
+			level_ = level;
+		}
+		uint32_t at_us;
+		if (!scheduler_.next_transition(at_us) || alarm_ < 0) return;
+		// 32-bit target -> absolute time; the delay is at most a pulse width.
+		const int32_t delay_us = static_cast<int32_t>(at_us - now);
+		if (delay_us <= 0) continue;
+		const absolute_time_t target = from_us_since_boot(now_64 + static_cast<uint32_t>(delay_us));
+		// True if the target passed while arming: apply it now instead.
+		if (!hardware_alarm_set_target(static_cast<unsigned>(alarm_), target)) return;
+	}
+}
@@ -0,0 +1,45 @@
+#ifndef PULSE_OUT_H_
+#define PULSE_OUT_H_
+
+#include <cstdint>
+
+#include "hal.h"
+#include "pulse-scheduler.h"
+
+// Pulse output driven by a dedicated hardware alarm. The sample tick requests
+// pulses; the alarm interrupt moves the jack at each scheduled transition, so
+// widths are exact to the alarm's latency and independent of the tick rate.
+//
+// request() runs in the sample tick and the alarm handler in its own
+// interrupt, both on core 0 at the default priority, so neither preempts the
+// other and the scheduler needs no lock.
+class PulseOut {
+public:
+	// Outputs rest low at least this long between pulses.
+	static constexpr uint32_t kMinGapUs = 500;
+
+	explicit PulseOut(hal::Pulse& pin)
+		: pin_(pin), scheduler_(kMinGapUs, PulseScheduler::Retrigger::kRestart) {}
+
+	// Claims a hardware alarm, with its interrupt on the calling core.
+	void start();
+
+	// A pulse of width_us starting at start_us (time_us_32 timebase).
+	void request(uint32_t start_us, uint32_t width_us);
+
+private:
+	static void on_alarm(unsigned alarm_num);
+
+	// Applies due transitions and arms the alarm for the next one.
+	void service();
+
+	// One pulse output per module; the alarm callback finds it here.
+	static PulseOut* instance_;
+
+	hal::Pulse& pin_;
+	PulseScheduler scheduler_;
+	int alarm_ = -1;
+	bool level_ = false;
+};
+
+#endif  // PULSE_OUT_H_
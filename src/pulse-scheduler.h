@@ -0,0 +1,106 @@
+#ifndef PULSE_SCHEDULER_H_
+#define PULSE_SCHEDULER_H_
+
+#include <cstdint>
+
+// Pulse output timing: turns "a pulse of N us at time T" requests into level
+// transitions. The owner applies the transitions with update() at the times
+// next_transition() asks for; on target a hardware alarm (pulse-out.h), so
+// widths are exact and nothing polls for deadlines.
+//
+// Rules:
+// - Widths run from the moment the output actually goes high.
+// - The output stays low for at least min_gap_us between pulses, so every
+//   pulse is a separate edge downstream; a pulse due sooner is delayed.
+// - Retrigger while high: kRestart ends the pulse and starts a new one after
+//   the gap; kExtend keeps it high until the later of the two ends.
+// Requests that arrive before an earlier one has started merge into it.
+class PulseScheduler {
+public:
+	enum class Retrigger : uint8_t {
+		kRestart = 0,
+		kExtend
+	};
+
+	constexpr PulseScheduler(uint32_t min_gap_us, Retrigger retrigger)
+		: min_gap_us_(min_gap_us), retrigger_(retrigger) {}
+
+	void request(uint32_t start_us, uint32_t width_us) {
+		if (rise_pending_) {
+			// Not started yet: one pulse, at the earlier start and longer width.
+			if (before(start_us, rise_at_us_)) rise_at_us_ = earliest_rise(start_us);
+			if (width_us > width_us_) width_us_ = width_us;
+			return;
+		}
+		if (!high_) {
+			rise_at_us_ = earliest_rise(start_us);
+			rise_pending_ = true;
+			width_us_ = width_us;
+			return;
+		}
+		if (retrigger_ == Retrigger::kExtend) {
+			if (before(fall_at_us_, start_us + width_us)) fall_at_us_ = start_us + width_us;
+			return;
+		}
+		// Restart: end the running pulse at the new start (or now, if that
+		// is sooner) and rise again after the gap.
+		if (before(start_us, fall_at_us_)) fall_at_us_ = start_us;
+		rise_at_us_ = fall_at_us_ + min_gap_us_;
+		rise_pending_ = true;
+		width_us_ = width_us;
+	}
+
+	// Applies every transition due at `now_us`, stamping each with now_us
+	// (when the output really moved); returns the output level.
+	bool update(uint32_t now_us) {
+		if (high_ && !before(now_us, fall_at_us_)) {
+			high_ = false;
+			last_fall_us_ = now_us;
+			has_fallen_ = true;
+			// A restart's rise keeps its gap from the real fall.
+			if (rise_pending_) rise_at_us_ = earliest_rise(rise_at_us_);
+		}
+		if (!high_ && rise_pending_ && !before(now_us, rise_at_us_)) {
+			high_ = true;
+			rise_pending_ = false;
+			fall_at_us_ = now_us + width_us_;
+		}
+		return high_;
+	}
+
+	// Time of the next transition; false when nothing is pending.
+	bool next_transition(uint32_t& at_us) const {
+		if (high_) {
+			at_us = fall_at_us_;
+			return true;
+		}
+		if (rise_pending_) {
+			at_us = rise_at_us_;
+			return true;
+		}
+		return false;
+	}
+
+	bool high() const { return high_; }
+
+private:
+	static bool before(uint32_t a, uint32_t b) { return static_cast<int32_t>(a - b) < 0; }
+
+	uint32_t earliest_rise(uint32_t start_us) const {
+		if (!has_fallen_) return start_us;
+		const uint32_t gap_end = last_fall_us_ + min_gap_us_;
+		return before(start_us, gap_end) ? gap_end : start_us;
+	}
+
+	uint32_t min_gap_us_;
+	Retrigger retrigger_;
+	bool high_ = false;
+	bool rise_pending_ = false;
+	bool has_fallen_ = false;
+	uint32_t rise_at_us_ = 0;
+	uint32_t fall_at_us_ = 0;
+	uint32_t last_fall_us_ = 0;
+	uint32_t width_us_ = 0;
+};
+
+#endif  // PULSE_SCHEDULER_H_
@@ -0,0 +1,139 @@
+#ifndef QUANTIZER_H_
+#define QUANTIZER_H_
+
+#include <cstdint>
+
+// Pitch quantizer on 1V/oct DAC codes (0-4095 = 0-10V = 120 semitones).
+// A scale is a 12-bit note mask: bit n set means n semitones above C is in
+// the scale. Each scale expands into a DAC code -> DAC code table, so
+// quantizing is one indexed load. Built-in scales are generated at compile
+// time and live in flash; tables for user masks are built once into RAM with
+// the same generator.
+namespace quantizer {
+
+constexpr uint32_t kNumCodes = 4096;
+constexpr uint16_t kDacMax = 4095;
+
+// 1 semitone = 4095 / 120 = 34.125 DAC codes, kept as codes * 256.
+constexpr uint32_t kSemitoneDac256 = 8736;
+constexpr uint32_t kNumSemitones = 120;
+
+// Note masks
+constexpr uint16_t kChromatic = 0x0FFF;
+constexpr uint16_t kMajor = 0x0AB5;       // 0 2 4 5 7 9 11
+constexpr uint16_t kMinor = 0x05AD;       // 0 2 3 5 7 8 10
+constexpr uint16_t kPentatonic = 0x04A9;  // 0 3 5 7 10 (minor pentatonic)
+constexpr uint16_t kWholeTone = 0x0555;   // 0 2 4 6 8 10
+
+struct Table {
+	uint16_t codes[kNumCodes];
+
+	// Codes past the DAC range quantize as its top code.
+	constexpr uint16_t operator[](uint16_t code) const {
+		return codes[code > kDacMax ? kDacMax : code];
+	}
+};
+
+constexpr uint16_t semitone_to_code(uint32_t semitone) {
+	const uint32_t code = (semitone * kSemitoneDac256) / 256;
+	return static_cast<uint16_t>(code > kDacMax ? kDacMax : code);
+}
+
+// Exact pitch of a note code, in 1/256 codes. Table entries are
+// semitone_to_code(), rounded down to whole codes; this recovers the fraction.
+constexpr uint32_t note_code_q8(uint16_t note_code) {
+	const uint32_t semitone = (note_code * 256u + kSemitoneDac256 / 2) / kSemitoneDac256;
+	return semitone * kSemitoneDac256;
+}
+
+// Fills `table` for `note_mask`: each code maps to the nearest semitone, then
+// to the nearest scale note (lower note on a tie), across octave boundaries.
+// Only notes within the DAC range count, so above the highest scale note the
+// table holds that note. An empty mask gives the identity table.
+constexpr void build_table(uint16_t note_mask, Table& table) {
+	note_mask &= 0x0FFF;
+	for (uint32_t code = 0; code < kNumCodes; ++code) {
+		if (note_mask == 0) {
+			table.codes[code] = static_cast<uint16_t>(code);
+			continue;
+		}
+		const uint32_t semitone = (code * 256 + kSemitoneDac256 / 2) / kSemitoneDac256;
+		// Search outward; a non-empty mask always has a note within 6 semitones
+		// in one direction or the other, and one within 12 below the top.
+		uint32_t best = semitone;
+		for (uint32_t distance = 0; distance <= 12; ++distance) {
+			if (semitone >= distance && (note_mask >> ((semitone - distance) % 12)) & 1u) {
+				best = semitone - distance;
+				break;
+			}
+			if (semitone + distance <= kNumSemitones &&
+				(note_mask >> ((semitone + distance) % 12)) & 1u) {
+				best = semitone + distance;
+				break;
+			}
+		}
+		table.codes[code] = semitone_to_code(best);
+	}
+}
+
+constexpr Table make_table(uint16_t note_mask) {
+	Table table{};
+	build_table(note_mask, table);
+	return table;
+}
+
+// Built-in scales (flash)
+inline constexpr Table kChromaticTable = make_table(kChromatic);
+inline constexpr Table kMajorTable = make_table(kMajor);
+inline constexpr Table kMinorTable = make_table(kMinor);
+inline constexpr Table kPentatonicTable = make_table(kPentatonic);
+inline constexpr Table kWholeToneTable = make_table(kWholeTone);
+
+// Quantizer with optional hysteresis for continuous inputs: once a note is
+// output, the input has to move `hysteresis` codes past the boundary to the
+// next note before the output changes, so inputs near a boundary don't chatter.
+class Quantizer {
+public:
+	// nullptr passes codes through unchanged. The table must outlive this.
+	void set_table(const Table* table) {
+		table_ = table;
+		has_last_ = false;
+	}
+	const Table* table() const { return table_; }
+
+	void set_hysteresis(uint16_t codes) { hysteresis_ = codes; }
+
+	uint16_t process(uint16_t code) {
+		if (table_ == nullptr) return code;
+		const Table& table = *table_;
+		uint16_t note = table[code];
+		if (hysteresis_ != 0 && has_last_ && note != last_) {
+			// Probe back toward the held note; still inside it means hold.
+			const int32_t probe = note > last_ ? static_cast<int32_t>(code) - hysteresis_
+											   : static_cast<int32_t>(code) + hysteresis_;
+			const uint16_t clamped =
+				static_cast<uint16_t>(probe < 0 ? 0 : (probe > kDacMax ? kDacMax : probe));
+			if (table[clamped] == last_) note = last_;
+		}
+		last_ = note;
+		has_last_ = true;
+		return note;
+	}
+
+	// process() with the note's exact pitch, in 1/256 codes (see
+	// note_code_q8()). Unquantized codes come back whole.
+	uint32_t process_q8(uint16_t code) {
+		const uint16_t note = process(code);
+		return table_ == nullptr ? static_cast<uint32_t>(note) << 8 : note_code_q8(note);
+	}
+
+private:
+	const Table* table_ = nullptr;
+	uint16_t hysteresis_ = 0;
+	uint16_t last_ = 0;
+	bool has_last_ = false;
+};
+
+}  // namespace quantizer
+
+#endif  // QUANTIZER_H_
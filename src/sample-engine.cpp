@@ -0,0 +1,83 @@
+#include "sample-engine.h"
+
+namespace {
+constexpr uint32_t kMicrosPerSecond = 1000000;
+}
+
+bool SampleEngine::start(uint32_t sample_rate_hz, TickHandler handler, void* context) {
+	if (running_ || handler == nullptr || sample_rate_hz == 0 ||
+		sample_rate_hz > kMicrosPerSecond) {
+		return false;
+	}
+
+	handler_ = handler;
+	context_ = context;
+	sample_rate_hz_ = sample_rate_hz;
+	period_us_ = kMicrosPerSecond / sample_rate_hz;
+	reset_requested_ = true;
+	expected_start_us_ = time_us_32() + period_us_;
+
+	// Negative delay: period is measured start-to-start, so handler run time
+	// does not stretch the sample period.
+	running_ = add_repeating_timer_us(-static_cast<int64_t>(period_us_), &SampleEngine::on_timer,
+									  this, &timer_);
+	return running_;
+}
+
+void SampleEngine::stop() {
+	if (!running_) return;
+	cancel_repeating_timer(&timer_);
+	running_ = false;
+}
+
+SampleEngine::Stats SampleEngine::stats() const {
+	Stats s;
+	s.sample_rate_hz = sample_rate_hz_;
+	s.period_us = period_us_;
+	s.ticks = ticks_;
+	s.deadline_misses = deadline_misses_;
+	s.worst_tick_us = worst_tick_us_;
+	s.stalled_periods = stalled_periods_;
+	return s;
+}
+
+bool SampleEngine::on_timer(repeating_timer_t* timer) {
+	static_cast<SampleEngine*>(timer->user_data)->tick();
+	return true;
+}
+
+void SampleEngine::tick() {
+	const uint32_t start_us = time_us_32();
+	handler_(context_, start_us);
+	const uint32_t end_us = time_us_32();
+
+	if (reset_requested_) {
+		reset_requested_ = false;
+		ticks_ = 0;
+		deadline_misses_ = 0;
+		worst_tick_us_ = 0;
+		stalled_periods_ = 0;
+	}
+
+	const uint32_t duration_us = end_us - start_us;
+	ticks_ = ticks_ + 1;
+	if (duration_us > worst_tick_us_) {
+		worst_tick_us_ = duration_us;
+	}
+
+	// A tick that starts a whole period late stands in for the ones that never
+	// ran while core 0 was held. Rare, so the division stays off the usual path.
+	const uint32_t late_us = start_us - expected_start_us_;
+	if (static_cast<int32_t>(late_us) >= static_cast<int32_t>(period_us_)) {
+		stalled_periods_ = stalled_periods_ + late_us / period_us_;
+	}
+
+	// A tick misses its deadline when it completes after the next tick was due,
+	// either because it started late or because the handler overran the period.
+	if (static_cast<int32_t>(end_us - (expected_start_us_ + period_us_)) > 0) {
+		deadline_misses_ = deadline_misses_ + 1;
+		expected_start_us_ = start_us + period_us_;
+	} else {
+		expected_start_us_ += period_us_;
+	}
+}
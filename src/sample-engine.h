@@ -0,0 +1,67 @@
+#ifndef SAMPLE_ENGINE_H_
+#define SAMPLE_ENGINE_H_
+
+#include <cstdint>
+
+#include "pico/time.h"
+
+// Fixed-rate sample tick driven by a repeating hardware alarm.
+// The tick handler runs in interrupt context with a guaranteed period; UI work
+// stays in the main loop. The handler gets the tick's start time, read once,
+// as the one timestamp for everything the tick does. The engine tracks
+// deadline misses and the worst-case tick duration so each mode's headroom
+// can be measured on target.
+class SampleEngine {
+public:
+	using TickHandler = void (*)(void* context, uint32_t tick_us);
+
+	struct Stats {
+		uint32_t sample_rate_hz;
+		uint32_t period_us;
+		uint32_t ticks;
+		uint32_t deadline_misses;
+		uint32_t worst_tick_us;
+		// Whole periods by which ticks started late. These ticks never ran:
+		// core 0 was held, mostly by a flash write parking it (every settings
+		// save does), and the outputs kept their last codes meanwhile.
+		uint32_t stalled_periods;
+	};
+
+	// Common rates. Any rate that divides 1 MHz evenly works.
+	static constexpr uint32_t kRate2kHz = 2000;
+	static constexpr uint32_t kRate8kHz = 8000;
+	static constexpr uint32_t kRate16kHz = 16000;
+
+	bool start(uint32_t sample_rate_hz, TickHandler handler, void* context);
+	void stop();
+
+	bool running() const { return running_; }
+	uint32_t sample_rate_hz() const { return sample_rate_hz_; }
+	uint32_t period_us() const { return period_us_; }
+
+	// Snapshot of the tick statistics. Safe to call from the main loop.
+	Stats stats() const;
+
+	// Clear counters on the next tick (applied from interrupt context).
+	void reset_stats() { reset_requested_ = true; }
+
+private:
+	static bool on_timer(repeating_timer_t* timer);
+	void tick();
+
+	repeating_timer_t timer_{};
+	TickHandler handler_ = nullptr;
+	void* context_ = nullptr;
+	uint32_t sample_rate_hz_ = 0;
+	uint32_t period_us_ = 0;
+	uint32_t expected_start_us_ = 0;
+	bool running_ = false;
+
+	volatile bool reset_requested_ = false;
+	volatile uint32_t ticks_ = 0;
+	volatile uint32_t deadline_misses_ = 0;
+	volatile uint32_t worst_tick_us_ = 0;
+	volatile uint32_t stalled_periods_ = 0;
+};
+
+#endif  // SAMPLE_ENGINE_H_
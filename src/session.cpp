@@ -0,0 +1,23 @@
+#include "session.h"
+
+Session::Session(FlashStore& store)
+	: store_(store), saved_{}, latest_{}, changed_at_us_(0) {}
+
+bool Session::load(SessionState& state) {
+	SessionState stored;
+	if (!store_.load(StoreKey::kSession, &stored, sizeof(stored))) return false;
+	state = stored;
+	saved_ = stored;
+	latest_ = stored;
+	return true;
+}
+
+void Session::update(const SessionState& state, uint32_t now_us) {
+	if (state != latest_) {
+		latest_ = state;
+		changed_at_us_ = now_us;
+	}
+	if (!save_pending() || now_us - changed_at_us_ < kSettleUs) return;
+	// A full store refuses without touching flash; retried on later passes.
+	if (store_.save(StoreKey::kSession, &latest_, sizeof(latest_))) saved_ = latest_;
+}
@@ -0,0 +1,51 @@
+#ifndef SESSION_H_
+#define SESSION_H_
+
+#include <cstdint>
+
+#include "flash-store.h"
+
+// Front-panel state that survives a power cycle: the mode and each mode's
+// button-set options. Pot positions are read live and need no saving.
+struct SessionState {
+	uint8_t mode;
+	uint8_t slew_linked;
+	uint8_t noise_scale;
+	uint8_t reserved;
+
+	bool operator==(const SessionState& other) const {
+		return mode == other.mode && slew_linked == other.slew_linked &&
+			   noise_scale == other.noise_scale;
+	}
+	bool operator!=(const SessionState& other) const { return !(*this == other); }
+};
+
+// Debounced, coalesced session saves into the settings store. The UI loop
+// hands in the live state every pass; a save happens once the state has held
+// still for kSettleUs after a change, so scrolling through scales or cycling
+// modes costs one record, not one per step. Each record parks the DSP core for
+// its page program (see FlashStore), which drops a few sample ticks; the
+// settle time keeps that to once per deliberate change. UI core only.
+class Session {
+public:
+	static constexpr uint32_t kSettleUs = 2000000;
+
+	explicit Session(FlashStore& store);
+
+	// Restores the saved state into `state`; false (and `state` untouched) if
+	// there is none. What is loaded counts as already saved.
+	bool load(SessionState& state);
+
+	void update(const SessionState& state, uint32_t now_us);
+
+	// A change is waiting to be written.
+	bool save_pending() const { return saved_ != latest_; }
+
+private:
+	FlashStore& store_;
+	SessionState saved_;
+	SessionState latest_;
+	uint32_t changed_at_us_;
+};
+
+#endif  // SESSION_H_
@@ -0,0 +1,28 @@
+#ifndef SIGMA_DELTA_H_
+#define SIGMA_DELTA_H_
+
+#include <cstdint>
+
+// First-order sigma-delta from 1/256-code targets down to whole DAC codes.
+// The part of each target the DAC cannot show is carried into the next
+// frame, so over any run of frames the codes sent sum to within one code of
+// the targets' sum: their average resolves 1/256 of a code. A steady target
+// toggles only between the two codes either side of it, and the error is
+// pushed up toward half the frame rate, where the output stage and whatever
+// the CV drives average it out. A whole-code target goes out unchanged.
+//
+// One per output channel, run once per frame on the sample tick.
+class SigmaDelta {
+public:
+	// target_q8: 0..4095 * 256.
+	uint16_t process(uint32_t target_q8) {
+		const uint32_t sum = target_q8 + residue_;
+		residue_ = sum & 0xFF;
+		return static_cast<uint16_t>(sum >> 8);
+	}
+
+private:
+	uint32_t residue_ = 0;
+};
+
+#endif  // SIGMA_DELTA_H_
@@ -1,169 +1,163 @@
 #include "slew-limiter.h"
+#include "cv-units.h"
+#include "exp-table.h"
 #include "fixed-point.h"
-
-#include <pico/time.h>
-#include <cstdio>
+#include "pot-curves.h"
+#include "trace.h"
 
 namespace {
 // Internal fixed-point format:
-// - Voltages are represented as signed millivolts (mV).
-// - Fractions are represented as Q15 (0..32768 == 0.0..1.0).
-constexpr int32_t kMillivoltsPerVolt = 1000;
-constexpr int32_t kDacMax = 4095;
-constexpr uint32_t kPotMax = 255;
-constexpr uint32_t kPotCubeMax = kPotMax * kPotMax * kPotMax;
-constexpr uint32_t kMinSlewDenominatorUs = 2000;  // Mirrors old 0.001f threshold.
-constexpr bool kEnableSlewDebug = true;
-constexpr uint32_t kSlewDebugPeriodUs = 100000;  // 10 Hz
-
-uint16_t pot_to_slew_rate_q15(uint8_t pot_value) {
-	if (pot_value == 0) return 0;
-	const uint32_t p = pot_value;
-	const uint32_t p3 = p * p * p;
-	// Cubic taper keeps more knob travel in slower slew region.
-	const uint64_t scaled =
-		(static_cast<uint64_t>(p3) * fixed_point::kQ15One + (kPotCubeMax / 2)) / kPotCubeMax;
-	return static_cast<uint16_t>(scaled > fixed_point::kQ15One ? fixed_point::kQ15One : scaled);
-}
-
-uint16_t pot_to_shape_q15(uint8_t pot_value) {
-	return fixed_point::u8_to_q15(pot_value);
-}
+// - Voltages are represented as signed millivolts (mV); the slew state keeps
+//   16 fractional bits so small per-frame steps at high loop rates add up.
+// - Fractions are represented as Q15 (0..32768 == 0.0..1.0), per-frame
+//   exponential coefficients as Q30.
+// Per-channel state records in the DSP trace ring (trace::Event::kSlewChannel).
+constexpr bool kTraceSlewState = true;
+constexpr uint32_t kSlewTracePeriodUs = 100000;  // 10 Hz
+
+// Full-scale slew time for a pot position; 0 means no slew (coefficient 1).
+constexpr auto kSlewTimeUs = pot_curves::make_table<uint32_t>(pot_curves::slew_time_us);
+
+constexpr int32_t kFullScaleQ16 = 10000 << 16;  // 10 V in mV, Q16
+
+// A gap longer than this many frame periods is not a slow frame but time the
+// mode did not run (boot, or another mode was active); it counts as one frame.
+constexpr uint32_t kMaxGapPeriods = 4;
 }
 
 SlewLimiter::SlewLimiter()
-	: current_ch1_mv_(0),
-	  current_ch2_mv_(0),
-	  output_smoother_ch1_(kOutputDeadbandMv, kOutputSmoothingAlphaQ15),
-	  output_smoother_ch2_(kOutputDeadbandMv, kOutputSmoothingAlphaQ15),
+	: current_ch1_q16_(0),
+	  current_ch2_q16_(0),
 	  last_time_us_(0),
 	  linked_(false),
-	  button_b_prev_(false) {}
+	  button_b_prev_(false),
+	  shape_q15_(0),
+	  rise_{exp_table::kQ30One, kFullScaleQ16},
+	  fall_{exp_table::kQ30One, kFullScaleQ16},
+	  coeff_dt_us_(0),
+	  coeff_linked_(false),
+	  coeff_valid_(false),
+	  out_a_code_(cv_units::kDacCenter),
+	  out_b_code_(cv_units::kDacCenter),
+	  last_trace_us_(0) {}
+
+void SlewLimiter::process(const BlockParams& params, const Frame* in, Frame* out, size_t n) {
+	const ControlSnapshot& controls = params.controls;
 
-void SlewLimiter::update(brain::ui::Pots& pots, brain::io::AudioCvIn& cv_in,
-						  brain::io::AudioCvOut& cv_out,
-						  Calibration& calibration, bool button_b_pressed,
-						  brain::ui::Leds& leds, LedController& led_controller) {
 	// Button B release: toggle linked mode
-	if (button_b_prev_ && !button_b_pressed) {
+	if (button_b_prev_ && !controls.button_b_pressed) {
 		linked_ = !linked_;
 	}
-	button_b_prev_ = button_b_pressed;
-
-	// Delta time
-	uint32_t now_us = time_us_32();
-	uint32_t dt_us = now_us - last_time_us_;
-	last_time_us_ = now_us;
-	if (dt_us > 100000) dt_us = 100000;
-
-	// Pots
-	const uint16_t rise_rate_q15 = pot_to_slew_rate_q15(pots.get(kPotRise));
-	const uint16_t fall_rate_q15 = linked_ ? rise_rate_q15 : pot_to_slew_rate_q15(pots.get(kPotFall));
-	const uint16_t shape_q15 = pot_to_shape_q15(pots.get(kPotShape));
-	const auto compute_coeff_q15 = [dt_us](uint16_t rate_q15, uint32_t max_slew_us) -> uint16_t {
-		if (rate_q15 == 0) return fixed_point::kQ15One;
-		// coeff ~= dt / (rate * max_slew_time), clamped to [0, 1] in Q15.
-		const uint64_t denominator =
-			(static_cast<uint64_t>(rate_q15) * max_slew_us) / fixed_point::kQ15One;
-		if (denominator <= kMinSlewDenominatorUs) return fixed_point::kQ15One;
-		const uint64_t numerator = static_cast<uint64_t>(dt_us) * fixed_point::kQ15One;
-		const uint64_t scaled = (numerator + (denominator / 2)) / denominator;
-		return static_cast<uint16_t>(scaled >= fixed_point::kQ15One ? fixed_point::kQ15One : scaled);
-	};
-
-	// Slew coefficients
-	const uint16_t rise_coeff_q15 = compute_coeff_q15(rise_rate_q15, kMaxSlewUs);
-	const uint16_t fall_coeff_q15 = compute_coeff_q15(fall_rate_q15, kMaxSlewUs);
-
-	// Read inputs and apply slew
-	const float in_ch1_v = cv_in.get_voltage_channel_a();
-	const float in_ch2_v = cv_in.get_voltage_channel_b();
-	const int32_t in_ch1_mv_unclamped =
-		static_cast<int32_t>(in_ch1_v * static_cast<float>(kMillivoltsPerVolt));
-	const int32_t in_ch2_mv_unclamped =
-		static_cast<int32_t>(in_ch2_v * static_cast<float>(kMillivoltsPerVolt));
-	const int32_t in_ch1_mv = fixed_point::clamp_i32(
-		in_ch1_mv_unclamped,
-		kMinSignalMillivolts, kMaxSignalMillivolts);
-	const int32_t in_ch2_mv = fixed_point::clamp_i32(
-		in_ch2_mv_unclamped,
-		kMinSignalMillivolts, kMaxSignalMillivolts);
-	current_ch1_mv_ =
-		slew_channel_mv(in_ch1_mv, current_ch1_mv_, rise_coeff_q15, fall_coeff_q15, shape_q15);
-	current_ch2_mv_ =
-		slew_channel_mv(in_ch2_mv, current_ch2_mv_, rise_coeff_q15, fall_coeff_q15, shape_q15);
-
-	// Map bipolar signal (-5V..+5V) into DAC domain (0V..10V) around 5V center.
-	const int32_t target_a_mv =
-		fixed_point::clamp_i32(current_ch1_mv_ + kCenterMillivolts, 0, kMaxMillivolts);
-	const int32_t target_b_mv =
-		fixed_point::clamp_i32(current_ch2_mv_ + kCenterMillivolts, 0, kMaxMillivolts);
-
-	// Apply output calibration in DAC domain to match other CV passthrough-like modes.
-	int32_t dac_a = (target_a_mv * kDacMax + (kMaxMillivolts / 2)) / kMaxMillivolts;
-	int32_t dac_b = (target_b_mv * kDacMax + (kMaxMillivolts / 2)) / kMaxMillivolts;
-	dac_a = dac_a * (Calibration::kCalibScale + calibration.gain_trim_a()) / Calibration::kCalibScale;
-	dac_b = dac_b * (Calibration::kCalibScale + calibration.gain_trim_b()) / Calibration::kCalibScale;
-	dac_a += calibration.offset_trim_a();
-	dac_b += calibration.offset_trim_b();
-	dac_a = fixed_point::clamp_i32(dac_a, 0, kDacMax);
-	dac_b = fixed_point::clamp_i32(dac_b, 0, kDacMax);
-
-	const int32_t calibrated_target_a_mv = (dac_a * kMaxMillivolts + (kDacMax / 2)) / kDacMax;
-	const int32_t calibrated_target_b_mv = (dac_b * kMaxMillivolts + (kDacMax / 2)) / kDacMax;
-	const int32_t out_a_mv = output_smoother_ch1_.process(calibrated_target_a_mv);
-	const int32_t out_b_mv = output_smoother_ch2_.process(calibrated_target_b_mv);
-	const float target_a_voltage =
-		static_cast<float>(calibrated_target_a_mv) / static_cast<float>(kMillivoltsPerVolt);
-	const float target_b_voltage =
-		static_cast<float>(calibrated_target_b_mv) / static_cast<float>(kMillivoltsPerVolt);
-	const float out_a_voltage = static_cast<float>(out_a_mv) / static_cast<float>(kMillivoltsPerVolt);
-	const float out_b_voltage = static_cast<float>(out_b_mv) / static_cast<float>(kMillivoltsPerVolt);
-	cv_out.set_voltage(brain::io::AudioCvOutChannel::kChannelA, out_a_voltage);
-	cv_out.set_voltage(brain::io::AudioCvOutChannel::kChannelB, out_b_voltage);
-	led_controller.render_output_vu(leds, out_a_voltage, out_b_voltage);
-
-	if (kEnableSlewDebug) {
-		static uint32_t last_debug_us = 0;
-		if ((now_us - last_debug_us) >= kSlewDebugPeriodUs) {
-			last_debug_us = now_us;
-			printf(
-				"\r\033[2K[slew A] raw=%4u in_v=%+7.3f in_mv=%+6ld cur_mv=%+6ld target_v=%+7.3f smooth_v=%+7.3f\n"
-				"\r\033[2K[slew B] raw=%4u in_v=%+7.3f in_mv=%+6ld cur_mv=%+6ld target_v=%+7.3f smooth_v=%+7.3f\033[1A\r",
-				cv_in.get_raw_channel_a(), in_ch1_v, static_cast<long>(in_ch1_mv),
-				static_cast<long>(current_ch1_mv_), target_a_voltage, out_a_voltage,
-				cv_in.get_raw_channel_b(), in_ch2_v, static_cast<long>(in_ch2_mv),
-				static_cast<long>(current_ch2_mv_), target_b_voltage, out_b_voltage);
-			fflush(stdout);
+	button_b_prev_ = controls.button_b_pressed;
+
+	// Pots. Slew coefficients only change with the rise/fall pots, the link
+	// state or the frame interval, which is constant under the sample engine.
+	const bool rise_changed = pot_watch_.changed(controls, kPotRise);
+	const bool fall_changed = pot_watch_.changed(controls, kPotFall);
+	if (pot_watch_.changed(controls, kPotShape)) {
+		shape_q15_ = fixed_point::u8_to_q15_shift(controls.pots[kPotShape]);
+	}
+	if (rise_changed || fall_changed || linked_ != coeff_linked_) {
+		coeff_valid_ = false;
+		coeff_linked_ = linked_;
+	}
+	const uint16_t shape_q15 = shape_q15_;
+
+	for (size_t i = 0; i < n; ++i) {
+		// Delta time: measured against the previous block for the first frame,
+		// the block's frame period after that.
+		const uint32_t now_us = params.start_us + static_cast<uint32_t>(i) * params.period_us;
+		uint32_t dt_us = now_us - last_time_us_;
+		if (dt_us > kMaxGapPeriods * params.period_us) dt_us = params.period_us;
+		last_time_us_ = now_us;
+		if (!coeff_valid_ || dt_us != coeff_dt_us_) {
+			const uint32_t rise_time_us = kSlewTimeUs[controls.pots[kPotRise]];
+			const uint32_t fall_time_us =
+				linked_ ? rise_time_us : kSlewTimeUs[controls.pots[kPotFall]];
+			rise_ = compute_step_coeffs(dt_us, rise_time_us);
+			fall_ = compute_step_coeffs(dt_us, fall_time_us);
+			coeff_dt_us_ = dt_us;
+			coeff_valid_ = true;
 		}
+
+		// Read inputs and apply slew
+		const int32_t in_ch1_mv =
+			fixed_point::clamp_i32(in[i].a, kMinSignalMillivolts, kMaxSignalMillivolts);
+		const int32_t in_ch2_mv =
+			fixed_point::clamp_i32(in[i].b, kMinSignalMillivolts, kMaxSignalMillivolts);
+		current_ch1_q16_ =
+			slew_channel_q16(in_ch1_mv << 16, current_ch1_q16_, rise_, fall_, shape_q15);
+		current_ch2_q16_ =
+			slew_channel_q16(in_ch2_mv << 16, current_ch2_q16_, rise_, fall_, shape_q15);
+		const int32_t current_ch1_mv = (current_ch1_q16_ + (1 << 15)) >> 16;
+		const int32_t current_ch2_mv = (current_ch2_q16_ + (1 << 15)) >> 16;
+
+		// Map bipolar signal (-5V..+5V) into DAC domain (0V..10V) around 5V center.
+		const int32_t target_a_mv =
+			fixed_point::clamp_i32(current_ch1_mv + kCenterMillivolts, 0, kMaxMillivolts);
+		const int32_t target_b_mv =
+			fixed_point::clamp_i32(current_ch2_mv + kCenterMillivolts, 0, kMaxMillivolts);
+
+		out[i].a = cv_units::mv_to_dac(target_a_mv);
+		out[i].b = cv_units::mv_to_dac(target_b_mv);
+		out[i].pulse = 0;
+
+		if (kTraceSlewState && (now_us - last_trace_us_) >= kSlewTracePeriodUs) {
+			last_trace_us_ = now_us;
+			trace::dsp.write(now_us, trace::Event::kSlewChannel, 0, in_ch1_mv,
+							 target_a_mv, cv_units::dac_to_mv(out[i].a));
+			trace::dsp.write(now_us, trace::Event::kSlewChannel, 1, in_ch2_mv,
+							 target_b_mv, cv_units::dac_to_mv(out[i].b));
+		}
+	}
+	if (n > 0) {
+		out_a_code_ = out[n - 1].a;
+		out_b_code_ = out[n - 1].b;
 	}
 }
 
-int32_t SlewLimiter::slew_channel_mv(int32_t input_mv, int32_t current_mv,
-									 uint16_t rise_coeff_q15,
-									 uint16_t fall_coeff_q15,
-									 uint16_t shape_q15) {
-	const int32_t diff_mv = input_mv - current_mv;
-	if (diff_mv == 0) return current_mv;
+void SlewLimiter::render_leds(hal::Leds& leds, const LedController& led_controller) const {
+	led_controller.render_output_vu(leds, out_a_code_, out_b_code_);
+}
+
+SlewLimiter::StepCoeffs SlewLimiter::compute_step_coeffs(uint32_t dt_us,
+														 uint32_t slew_time_us) {
+	if (slew_time_us == 0) return {exp_table::kQ30One, kFullScaleQ16};
+	// Only on a pot or interval change, so the 64-bit divides stay off the
+	// per-frame path. A long frame just covers more distance; process() only
+	// caps the gaps where the mode was not running.
+	const uint64_t x_q32 = (static_cast<uint64_t>(dt_us) << 32) / slew_time_us;
+	const uint64_t linear_q16 =
+		(static_cast<uint64_t>(kFullScaleQ16) * dt_us + (slew_time_us / 2)) / slew_time_us;
+	return {exp_table::one_minus_exp_neg_q30(x_q32),
+			linear_q16 > static_cast<uint64_t>(kFullScaleQ16) ? kFullScaleQ16
+															  : static_cast<int32_t>(linear_q16)};
+}
+
+int32_t SlewLimiter::slew_channel_q16(int32_t input_q16, int32_t current_q16,
+									  const StepCoeffs& rise, const StepCoeffs& fall,
+									  uint16_t shape_q15) {
+	const int32_t diff_q16 = input_q16 - current_q16;
+	if (diff_q16 == 0) return current_q16;
 
-	const uint16_t coeff_q15 = diff_mv > 0 ? rise_coeff_q15 : fall_coeff_q15;
+	const StepCoeffs& coeffs = diff_q16 > 0 ? rise : fall;
 
 	// Exponential: fraction of remaining distance.
-	const int32_t exp_step_mv = fixed_point::mul_q15(diff_mv, coeff_q15);
-
-	// Linear: constant rate in millivolts.
-	// kMaxMillivolts scales the "constant-rate" branch to full-range per coeff=1.
-	int32_t linear_move_mv = fixed_point::mul_q15(kMaxMillivolts, coeff_q15);
-	if (diff_mv < 0) linear_move_mv = -linear_move_mv;
-	if ((diff_mv > 0 && linear_move_mv > diff_mv) || (diff_mv < 0 && linear_move_mv < diff_mv)) {
-		linear_move_mv = diff_mv;
+	const int32_t exp_step_q16 =
+		static_cast<int32_t>((static_cast<int64_t>(diff_q16) * coeffs.exp_q30) >> 30);
+
+	// Linear: constant rate, never past the target.
+	int32_t linear_move_q16 = diff_q16 > 0 ? coeffs.linear_q16 : -coeffs.linear_q16;
+	if ((diff_q16 > 0 && linear_move_q16 > diff_q16) ||
+		(diff_q16 < 0 && linear_move_q16 < diff_q16)) {
+		linear_move_q16 = diff_q16;
 	}
 
 	// Blend: shape=0 -> linear, shape=1 -> exponential.
-	int32_t step_mv = fixed_point::blend_q15(linear_move_mv, exp_step_mv, shape_q15);
-	// Avoid coefficient-dependent deadband from integer truncation at very small diffs.
-	if (step_mv == 0) {
-		step_mv = diff_mv > 0 ? 1 : -1;
+	int32_t step_q16 = fixed_point::blend_q15(linear_move_q16, exp_step_q16, shape_q15);
+	// Avoid a coefficient-dependent deadband from truncation at very small diffs.
+	if (step_q16 == 0) {
+		step_q16 = diff_q16 > 0 ? 1 : -1;
 	}
-	return current_mv + step_mv;
+	return current_q16 + step_q16;
 }
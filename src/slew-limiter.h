@@ -3,22 +3,20 @@
 
 #include <cstdint>
 
-#include "calibration.h"
+#include "frame.h"
+#include "hal.h"
 #include "led-controller.h"
-#include "brain-io/audio-cv-in.h"
-#include "brain-io/audio-cv-out.h"
-#include "brain-ui/leds.h"
-#include "brain-ui/pots.h"
-#include "voltage-smoother.h"
 
 class SlewLimiter {
 public:
 	SlewLimiter();
 
-	void update(brain::ui::Pots& pots, brain::io::AudioCvIn& cv_in,
-				brain::io::AudioCvOut& cv_out,
-				Calibration& calibration, bool button_b_pressed,
-				brain::ui::Leds& leds, LedController& led_controller);
+	void process(const BlockParams& params, const Frame* in, Frame* out, size_t n);
+	void render_leds(hal::Leds& leds, const LedController& led_controller) const;
+
+	// Linked channels (toggled with button B by process()), persisted per session.
+	bool linked() const { return linked_; }
+	void set_linked(bool linked) { linked_ = linked; }
 
 private:
 	static constexpr uint8_t kPotRise = 0;
@@ -28,23 +26,40 @@ private:
 	static constexpr int32_t kMaxSignalMillivolts = 5000;
 	static constexpr int32_t kCenterMillivolts = 5000;
 	static constexpr int32_t kMaxMillivolts = 10000;
-	static constexpr uint32_t kMaxSlewUs = 2000000;  // ~2 seconds
-	static constexpr int32_t kOutputDeadbandMv = 5;
-	static constexpr uint16_t kOutputSmoothingAlphaQ15 = 8192;	// 0.25
 
-	static int32_t slew_channel_mv(int32_t input_mv, int32_t current_mv,
-								   uint16_t rise_coeff_q15,
-								   uint16_t fall_coeff_q15,
-								   uint16_t shape_q15);
+	// Per-frame movement for one direction, exact for the frame interval:
+	// exponential covers 1 - exp(-dt/tau) of the remaining distance, linear
+	// moves full scale in one slew time.
+	struct StepCoeffs {
+		uint32_t exp_q30;
+		int32_t linear_q16;  // millivolts, Q16
+	};
+
+	static StepCoeffs compute_step_coeffs(uint32_t dt_us, uint32_t slew_time_us);
+	// Values in millivolts, Q16.
+	static int32_t slew_channel_q16(int32_t input_q16, int32_t current_q16,
+									const StepCoeffs& rise, const StepCoeffs& fall,
+									uint16_t shape_q15);
 
 	// State
-	int32_t current_ch1_mv_;
-	int32_t current_ch2_mv_;
-	VoltageSmoother output_smoother_ch1_;
-	VoltageSmoother output_smoother_ch2_;
+	int32_t current_ch1_q16_;
+	int32_t current_ch2_q16_;
 	uint32_t last_time_us_;
 	bool linked_;
 	bool button_b_prev_;
+
+	// Pot-derived parameters, recomputed only when their inputs change
+	PotWatch pot_watch_;
+	uint16_t shape_q15_;
+	StepCoeffs rise_;
+	StepCoeffs fall_;
+	uint32_t coeff_dt_us_;
+	bool coeff_linked_;
+	bool coeff_valid_;
+	// Last output codes, for LEDs
+	uint16_t out_a_code_;
+	uint16_t out_b_code_;
+	uint32_t last_trace_us_;
 };
 
 #endif  // SLEW_LIMITER_H_
@@ -0,0 +1,51 @@
+#ifndef SNAPSHOT_CHANNEL_H_
+#define SNAPSHOT_CHANNEL_H_
+
+#include <atomic>
+#include <cstdint>
+#include <type_traits>
+
+// Lock-free single-producer/single-consumer snapshot channel (sequence lock).
+// The producer overwrites the latest snapshot and never waits. The consumer
+// never waits either: if a read races with a publish, try_read() fails and the
+// consumer keeps its previous copy until the next attempt.
+// Only word-sized atomic loads/stores and fences are used, so this is safe
+// across RP2040 cores (Cortex-M0+ has no exclusive load/store).
+template <typename T>
+class SnapshotChannel {
+	static_assert(std::is_trivially_copyable<T>::value,
+				  "SnapshotChannel requires a trivially copyable type");
+
+public:
+	// Producer side
+	void publish(const T& value) {
+		const uint32_t seq = sequence_.load(std::memory_order_relaxed);
+		sequence_.store(seq + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		value_ = value;
+		sequence_.store(seq + 2, std::memory_order_release);
+	}
+
+	// Consumer side. Returns false if nothing has been published yet or a
+	// publish was in progress; `out` is left untouched in that case.
+	bool try_read(T& out) const {
+		const uint32_t before = sequence_.load(std::memory_order_acquire);
+		if (before == 0 || (before & 1u) != 0) return false;
+		const T copy = value_;
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if (sequence_.load(std::memory_order_relaxed) != before) return false;
+		out = copy;
+		return true;
+	}
+
+	// Number of completed publishes.
+	uint32_t publish_count() const {
+		return sequence_.load(std::memory_order_acquire) / 2;
+	}
+
+private:
+	std::atomic<uint32_t> sequence_{0};
+	T value_{};
+};
+
+#endif  // SNAPSHOT_CHANNEL_H_
@@ -0,0 +1,111 @@
+#include "trace.h"
+
+namespace trace {
+
+Ring<kDspCapacity> dsp;
+Ring<kUiCapacity> ui;
+
+namespace {
+struct EventInfo {
+	const char* name;
+	const char* args[Record::kNumArgs];
+};
+
+constexpr EventInfo kEventInfo[] = {
+	{"none", {nullptr, nullptr, nullptr, nullptr}},
+	{"dropped", {"source", "count", nullptr, nullptr}},
+	{"mode_stats", {"mode", "ticks", "deadline_misses", "worst_tick_us"}},
+	{"mode_change", {"mode", nullptr, nullptr, nullptr}},
+	{"calibration_enter", {nullptr, nullptr, nullptr, nullptr}},
+	{"calibration_exit", {nullptr, nullptr, nullptr, nullptr}},
+	{"slew_channel", {"channel", "in_mv", "target_mv", "out_mv"}},
+	{"calibration_point", {"point", "correction_a", "correction_b", nullptr}},
+	{"boot", {"init_us", "first_output_us", nullptr, nullptr}},
+	{"input_calibration", {"channel", "minus_q4", "plus_q4", "accepted"}},
+};
+static_assert(sizeof(kEventInfo) / sizeof(kEventInfo[0]) ==
+				  static_cast<size_t>(Event::kNumEvents),
+			  "one info entry per trace event");
+
+constexpr char kHexDigits[] = "0123456789abcdef";
+
+char* put_hex(char* out, uint32_t value, uint8_t digits) {
+	for (int8_t i = static_cast<int8_t>(digits - 1); i >= 0; --i) {
+		out[i] = kHexDigits[value & 0xF];
+		value >>= 4;
+	}
+	return out + digits;
+}
+
+bool get_hex(const char*& in, uint8_t digits, uint32_t& value) {
+	value = 0;
+	for (uint8_t i = 0; i < digits; ++i) {
+		const char c = in[i];
+		uint32_t nibble;
+		if (c >= '0' && c <= '9') {
+			nibble = static_cast<uint32_t>(c - '0');
+		} else if (c >= 'a' && c <= 'f') {
+			nibble = static_cast<uint32_t>(c - 'a' + 10);
+		} else if (c >= 'A' && c <= 'F') {
+			nibble = static_cast<uint32_t>(c - 'A' + 10);
+		} else {
+			return false;
+		}
+		value = (value << 4) | nibble;
+	}
+	in += digits;
+	return true;
+}
+}  // namespace
+
+void encode_line(uint8_t source, const Record& record, char* out) {
+	*out++ = 'T';
+	*out++ = kHexDigits[source & 0xF];
+	*out++ = ':';
+	out = put_hex(out, record.timestamp_us, 8);
+	out = put_hex(out, record.event, 4);
+	out = put_hex(out, record.sequence, 4);
+	for (uint8_t i = 0; i < Record::kNumArgs; ++i) {
+		out = put_hex(out, static_cast<uint32_t>(record.args[i]), 8);
+	}
+	*out++ = '\n';
+	*out = '\0';
+}
+
+bool decode_line(const char* line, uint8_t& source, Record& record) {
+	if (line[0] != 'T' || line[1] == '\0' || line[2] != ':') return false;
+	const char* in = line + 1;
+	uint32_t value;
+	if (!get_hex(in, 1, value)) return false;
+	source = static_cast<uint8_t>(value);
+	++in;  // ':'
+
+	Record r;
+	if (!get_hex(in, 8, value)) return false;
+	r.timestamp_us = value;
+	if (!get_hex(in, 4, value)) return false;
+	r.event = static_cast<uint16_t>(value);
+	if (!get_hex(in, 4, value)) return false;
+	r.sequence = static_cast<uint16_t>(value);
+	for (uint8_t i = 0; i < Record::kNumArgs; ++i) {
+		if (!get_hex(in, 8, value)) return false;
+		r.args[i] = static_cast<int32_t>(value);
+	}
+	if (*in != '\0' && *in != '\n' && *in != '\r') return false;
+	record = r;
+	return true;
+}
+
+const char* event_name(uint16_t event) {
+	if (event >= static_cast<uint16_t>(Event::kNumEvents)) return nullptr;
+	return kEventInfo[event].name;
+}
+
+const char* arg_name(uint16_t event, uint8_t arg) {
+	if (event >= static_cast<uint16_t>(Event::kNumEvents) || arg >= Record::kNumArgs) {
+		return nullptr;
+	}
+	return kEventInfo[event].args[arg];
+}
+
+}  // namespace trace
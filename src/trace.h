@@ -0,0 +1,120 @@
+#ifndef TRACE_H_
+#define TRACE_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Binary trace buffer for the hot path.
+// A trace record is a fixed-size binary event: timestamp, event id and up to
+// four int32 payloads. Writing one is a bounds check, a 24-byte store and a
+// release store of the head index, so modes can trace from the sample tick
+// without stdio. Records are drained and formatted off the hot path: the UI
+// core encodes them as hex lines on stdio, and the host tool trace_decode
+// turns those lines into text or CSV.
+namespace trace {
+
+enum class Event : uint16_t {
+	kNone = 0,
+	kDropped = 1,           // source, records lost since the last drain
+	kModeStats = 2,         // mode, ticks, deadline misses, worst tick us
+	kModeChange = 3,        // mode
+	kCalibrationEnter = 4,  //
+	kCalibrationExit = 5,   // (after one kCalibrationPoint per point)
+	kSlewChannel = 6,       // channel, in mV, target mV, out mV
+	kCalibrationPoint = 7,  // point (volts), correction A, correction B (DAC codes)
+	kBoot = 8,              // init start us, first output us (since reset)
+	kInputCalibration = 9,  // channel, -5V reading, +5V reading (1/16 codes), accepted
+	kNumEvents
+};
+
+struct Record {
+	static constexpr uint8_t kNumArgs = 4;
+
+	uint32_t timestamp_us;
+	uint16_t event;
+	uint16_t sequence;  // low bits of the write index, to spot gaps
+	int32_t args[kNumArgs];
+};
+
+// Lock-free single-producer/single-consumer ring of trace records.
+// The producer never waits: when the ring is full the record is dropped and
+// counted. Only word-sized atomic loads/stores are used, so one core may write
+// while the other drains (Cortex-M0+ has no exclusive load/store).
+template <uint32_t kCapacity>
+class Ring {
+	static_assert(kCapacity != 0 && (kCapacity & (kCapacity - 1)) == 0,
+				  "trace ring capacity must be a power of two");
+
+public:
+	// Producer side
+	bool write(uint32_t timestamp_us, Event event, int32_t a = 0, int32_t b = 0,
+			   int32_t c = 0, int32_t d = 0) {
+		const uint32_t head = head_.load(std::memory_order_relaxed);
+		if (head - tail_.load(std::memory_order_acquire) >= kCapacity) {
+			dropped_.store(dropped_.load(std::memory_order_relaxed) + 1,
+						   std::memory_order_relaxed);
+			return false;
+		}
+		Record& r = records_[head & (kCapacity - 1)];
+		r.timestamp_us = timestamp_us;
+		r.event = static_cast<uint16_t>(event);
+		r.sequence = static_cast<uint16_t>(head);
+		r.args[0] = a;
+		r.args[1] = b;
+		r.args[2] = c;
+		r.args[3] = d;
+		head_.store(head + 1, std::memory_order_release);
+		return true;
+	}
+
+	// Consumer side. Returns false when the ring is empty.
+	bool read(Record& out) {
+		const uint32_t tail = tail_.load(std::memory_order_relaxed);
+		if (tail == head_.load(std::memory_order_acquire)) return false;
+		out = records_[tail & (kCapacity - 1)];
+		tail_.store(tail + 1, std::memory_order_release);
+		return true;
+	}
+
+	// Records dropped because the ring was full, since construction.
+	uint32_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+private:
+	Record records_[kCapacity] = {};
+	std::atomic<uint32_t> head_{0};
+	std::atomic<uint32_t> tail_{0};
+	std::atomic<uint32_t> dropped_{0};
+};
+
+// Core 0: written by the sample tick. Core 1: written by the UI loop.
+// Both are drained by the UI loop.
+constexpr uint32_t kDspCapacity = 256;
+constexpr uint32_t kUiCapacity = 32;
+extern Ring<kDspCapacity> dsp;
+extern Ring<kUiCapacity> ui;
+
+enum Source : uint8_t {
+	kSourceDsp = 0,
+	kSourceUi = 1,
+};
+
+// Text line for one record: "T<source>:" then fixed-width hex fields
+// (timestamp, event, sequence, args), newline-terminated. Other stdio output
+// can be interleaved; the decoder skips lines that are not trace lines.
+constexpr size_t kLineChars = 3 + 8 + 4 + 4 + 8 * Record::kNumArgs + 1;
+constexpr size_t kLineBufferSize = kLineChars + 1;
+
+// Writes the line and its terminator into `out` (kLineBufferSize bytes).
+void encode_line(uint8_t source, const Record& record, char* out);
+
+// Parses one line from encode_line (trailing CR/LF allowed).
+bool decode_line(const char* line, uint8_t& source, Record& record);
+
+// Name of an event and of its used payloads; nullptr for unused payloads.
+const char* event_name(uint16_t event);
+const char* arg_name(uint16_t event, uint8_t arg);
+
+}  // namespace trace
+
+#endif  // TRACE_H_
@@ -0,0 +1,99 @@
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+
+#include "../src/ad-envelope.h"
+#include "../src/fixed-point.h"
+
+// AD envelope segments against a double-precision model: linear ramps blended
+// with RC charge/discharge curves (five time constants, normalized to span
+// 0..peak), sampled at the same frame times. Every output frame must land
+// within one DAC code of the model, and end-of-cycle must fire on the frame
+// the decay ends.
+namespace {
+constexpr uint32_t kTickUs = 125;  // 8 kHz
+constexpr double kCurveTimeConstants = 5.0;
+constexpr int kPeakCodes = 4095 - 2048;
+
+// Stage time for a pot, mirroring the firmware's cubic taper.
+uint32_t stage_time_us(uint8_t pot) {
+	const uint64_t x = pot;
+	return static_cast<uint32_t>(1000 + (x * x * x * (5000000 - 1000)) / (255ULL * 255 * 255));
+}
+
+double rc_attack(double p) {
+	return (1.0 - std::exp(-kCurveTimeConstants * p)) / (1.0 - std::exp(-kCurveTimeConstants));
+}
+
+double rc_decay(double p) {
+	return (std::exp(-kCurveTimeConstants * p) - std::exp(-kCurveTimeConstants)) /
+		   (1.0 - std::exp(-kCurveTimeConstants));
+}
+
+int level_to_code(double level) {
+	return 2048 + static_cast<int>(std::floor(level * kPeakCodes));
+}
+
+void check_segments(uint8_t attack_pot, uint8_t decay_pot, uint8_t shape_pot) {
+	AdEnvelope env;
+	ControlSnapshot controls{};
+	controls.set_pot(0, attack_pot, 0);
+	controls.set_pot(1, decay_pot, 0);
+	controls.set_pot(2, shape_pot, 0);
+	const double shape = fixed_point::u8_to_q15(shape_pot) / 32768.0;
+	const double attack_us = stage_time_us(attack_pot);
+	const double decay_us = stage_time_us(decay_pot);
+
+	// Input below the gate threshold; the pulse rise triggers frame 0.
+	const Frame idle{0, 0, 0};
+	const Frame trigger{0, 0, Frame::kPulseRise};
+
+	int worst = 0;
+	bool in_decay = false;
+	uint32_t decay_start = 0;
+	for (uint32_t k = 0;; ++k) {
+		Frame out;
+		env.process(BlockParams{controls, k * kTickUs, kTickUs}, k == 0 ? &trigger : &idle,
+					&out, 1);
+
+		const double t_us = static_cast<double>(k) * kTickUs;
+		if (!in_decay && t_us >= attack_us) {
+			in_decay = true;
+			decay_start = k;
+		}
+		double level;
+		bool eoc = false;
+		if (!in_decay) {
+			const double p = t_us / attack_us;
+			level = (1.0 - shape) * p + shape * rc_attack(p);
+		} else {
+			const double dt_us = static_cast<double>(k - decay_start) * kTickUs;
+			const double p = dt_us / decay_us;
+			eoc = dt_us >= decay_us;
+			level = eoc ? 0.0 : (1.0 - shape) * (1.0 - p) + shape * rc_decay(p);
+		}
+
+		const int error = std::abs(static_cast<int>(out.a) - level_to_code(level));
+		if (error > worst) worst = error;
+		assert(out.a == out.b);
+		assert(((out.pulse & Frame::kPulseRise) != 0) == eoc);
+		if (eoc) break;
+	}
+	std::printf("attack %3u decay %3u shape %3u: max error %d code(s)\n", attack_pot, decay_pot,
+				shape_pot, worst);
+	assert(worst <= 1);
+}
+}  // namespace
+
+int main() {
+	const uint8_t kShapes[] = {0, 64, 128, 255};
+	for (uint8_t shape : kShapes) {
+		check_segments(40, 60, shape);
+		check_segments(120, 90, shape);
+		check_segments(200, 170, shape);
+	}
+
+	std::puts("ad_envelope_shape_test: PASS");
+	return 0;
+}
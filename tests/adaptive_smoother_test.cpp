@@ -0,0 +1,112 @@
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+#include "../src/adaptive-smoother.h"
+#include "../src/cv-units.h"
+
+namespace {
+// The PrecisionAdder settings.
+AdaptiveSmoother make_smoother(uint32_t period_us) {
+	AdaptiveSmoother s(1000, 10, 20000);
+	s.set_period_us(period_us);
+	return s;
+}
+
+// Deterministic approximately-normal noise (sum of four uniforms).
+uint32_t rng = 2024;
+double noise(double rms) {
+	double sum = 0.0;
+	for (int i = 0; i < 4; ++i) {
+		rng = rng * 1664525u + 1013904223u;
+		sum += static_cast<double>(rng >> 8) / (1u << 24) - 0.5;
+	}
+	return sum * std::sqrt(3.0) * rms;
+}
+
+// Frames until the output stays within 1 mV of `target` for good.
+uint32_t settle_frames(AdaptiveSmoother& s, int32_t target, uint32_t max_frames) {
+	uint32_t settled_at = 0;
+	for (uint32_t i = 1; i <= max_frames; ++i) {
+		const int32_t out = s.process(target);
+		if (std::abs(out - target) > 1) settled_at = i;
+	}
+	return settled_at;
+}
+}  // namespace
+
+int main() {
+	// First value passes straight through.
+	{
+		AdaptiveSmoother s = make_smoother(125);
+		assert(s.process(3210) == 3210);
+	}
+
+	// Step latency: octave jumps settle within 1 mV in under a millisecond and
+	// a semitone within two, at 8 kHz and at 32 kHz. A fixed one-pole steady
+	// enough for the held-note case below (1 Hz) would take about a second.
+	struct Step {
+		int32_t mv;
+		uint32_t max_us;
+	};
+	const uint32_t periods_us[] = {125, 31};
+	const Step steps[] = {{1000, 1000}, {-1000, 1000}, {4000, 1000}, {83, 2000}, {-83, 2000}};
+	for (uint32_t period_us : periods_us) {
+		for (const Step& step : steps) {
+			AdaptiveSmoother s = make_smoother(period_us);
+			s.reset(5000);
+			for (int i = 0; i < 100; ++i) s.process(5000);
+			const uint32_t frames = settle_frames(s, 5000 + step.mv, 20000);
+			assert(frames * period_us <= step.max_us);
+		}
+	}
+
+	// Steady-state jitter: a held 2.5 V input carrying 0.7 mV rms of noise
+	// (the decimated ADC) comes out within 0.1 mV rms, and the DAC code never
+	// moves.
+	{
+		AdaptiveSmoother s = make_smoother(125);
+		const double held = 2500.0;
+		s.reset(static_cast<int32_t>(held));
+		double sum_sq = 0.0;
+		uint32_t count = 0;
+		const uint16_t code = cv_units::mv_to_dac(static_cast<int32_t>(held));
+		for (uint32_t i = 0; i < 80000; ++i) {
+			const int32_t in = static_cast<int32_t>(std::lround(held + noise(0.7)));
+			const int32_t out = s.process(in);
+			if (i < 8000) continue;
+			sum_sq += (out - held) * (out - held);
+			++count;
+			assert(cv_units::mv_to_dac(out) == code);
+		}
+		assert(std::sqrt(sum_sq / count) < 0.1);
+	}
+
+	// No deadband: a 1 mV change is reached exactly.
+	{
+		AdaptiveSmoother s = make_smoother(125);
+		s.reset(1000);
+		int32_t out = 0;
+		for (uint32_t i = 0; i < 40000; ++i) out = s.process(1001);
+		assert(out == 1001);
+		for (uint32_t i = 0; i < 40000; ++i) out = s.process(1000);
+		assert(out == 1000);
+	}
+
+	// Moving CV (2 Hz, +-1 V vibrato) is followed within a couple of codes.
+	{
+		AdaptiveSmoother s = make_smoother(125);
+		double worst = 0.0;
+		for (uint32_t i = 0; i < 16000; ++i) {
+			const double in = 5000.0 + 1000.0 * std::sin(2.0 * M_PI * 2.0 * i / 8000.0);
+			const int32_t out = s.process(static_cast<int32_t>(std::lround(in)));
+			if (i > 4000 && std::fabs(out - in) > worst) worst = std::fabs(out - in);
+		}
+		assert(worst < 6.0);
+	}
+
+	std::puts("adaptive_smoother_test: PASS");
+	return 0;
+}
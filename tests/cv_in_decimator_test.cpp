@@ -0,0 +1,184 @@
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+
+#include "../src/cv-in-decimator.h"
+#include "../src/gate-comparator.h"
+#include "../src/input-calibration.h"
+#include "fake-hal.h"
+
+namespace {
+constexpr uint32_t kFactor = cv_in_decimator::kFactor;
+
+// Deterministic approximately-normal noise (sum of four uniforms), in volts.
+uint32_t rng = 12345;
+float noise_v(float rms_v) {
+	float sum = 0.0f;
+	for (int i = 0; i < 4; ++i) {
+		rng = rng * 1664525u + 1013904223u;
+		sum += static_cast<float>(rng >> 8) / static_cast<float>(1u << 24) - 0.5f;
+	}
+	// Four uniforms of variance 1/12 sum to variance 1/3.
+	return sum * 1.7320508f * rms_v;
+}
+}  // namespace
+
+int main() {
+	// A steady input reads back exactly.
+	{
+		CvInCapture::Sample pairs[kFactor];
+		for (CvInCapture::Sample& p : pairs) p = {1000, 3000};
+		const cv_in_decimator::Reading r = cv_in_decimator::decimate(pairs);
+		assert(r.a_q4 == InputCalibration::linearize_q4(1000));
+		assert(r.b_q4 == InputCalibration::linearize_q4(3000));
+	}
+
+	// Fixed group delay: on a ramp the reading lags the newest pair by exactly
+	// (kFactor - 1) / 2 pairs, wherever the window sits.
+	for (uint16_t first = 0; first < 400; ++first) {
+		CvInCapture::Sample pairs[kFactor];
+		for (uint32_t i = 0; i < kFactor; ++i) {
+			pairs[i].raw_a = static_cast<uint16_t>(first + i);
+			pairs[i].raw_b = static_cast<uint16_t>(4000 - first - i);
+		}
+		const cv_in_decimator::Reading r = cv_in_decimator::decimate(pairs);
+		const int32_t delay_q4 = (kFactor - 1) * 16 / 2;
+		assert(r.a_q4 == InputCalibration::linearize_q4(first + kFactor - 1) - delay_q4);
+		assert(r.b_q4 == InputCalibration::linearize_q4(4000 - first - kFactor + 1) + delay_q4);
+	}
+	assert(cv_in_decimator::group_delay_ns(16 * 8000) == 58593);
+
+	// A pot scan pauses capture mid-window. The pairs due meanwhile are never
+	// converted and their ring slots keep stale data. Ticks, one per kFactor
+	// pairs, never get a window holding one: every reading keeps the fixed
+	// delay on a ramp, and a gate edge during the pause is seen at the first
+	// window after it.
+	{
+		constexpr uint32_t kRingPairs = CvInCapture::kRingPairs;
+		constexpr uint16_t kStale = 4095;
+		constexpr uint32_t kPauseStart = 32 * kFactor + 7;
+		constexpr uint32_t kPauseEnd = kPauseStart + 40;
+		constexpr uint32_t kEdgePair = kPauseStart + 20;
+		// The ramp stays between two DNL spikes, where the code steps are even.
+		constexpr uint32_t kRampStart = InputCalibration::kDnlFirstSpike + 16;
+		static CvInCapture::Sample ring[kRingPairs];
+		for (CvInCapture::Sample& p : ring) p = {kStale, kStale};
+		GateComparator gate(2000, 1800);
+		CvInCapture::Progress progress{0, 0};
+		uint32_t gate_next_pair = 0;
+		uint32_t rise_pair = 0;
+		uint32_t held_ticks = 0;
+		for (uint32_t pair = 0; pair < 60 * kFactor; ++pair) {
+			const bool paused = pair >= kPauseStart && pair < kPauseEnd;
+			if (pair == kPauseEnd) progress.run_start_pair = pair;
+			if (!paused) {
+				// A ramp on A, and on B a gate that opens during the pause.
+				ring[pair % kRingPairs] = {static_cast<uint16_t>(kRampStart + pair),
+										   static_cast<uint16_t>(pair < kEdgePair ? 100 : 3000)};
+				progress.pairs = pair + 1;
+			}
+			if ((pair + 1) % kFactor != 0) continue;
+
+			uint32_t first = 0;
+			if (!CvInCapture::newest_window(progress, first)) {
+				++held_ticks;
+				continue;
+			}
+			assert(CvInCapture::window_intact(progress, progress, first));
+			CvInCapture::Sample window[kFactor];
+			for (uint32_t i = 0; i < kFactor; ++i) {
+				assert(first + i < kPauseStart || first + i >= kPauseEnd);
+				window[i] = ring[(first + i) % kRingPairs];
+				assert(window[i].raw_a != kStale);
+			}
+			const cv_in_decimator::Reading r = cv_in_decimator::decimate(window);
+			const uint16_t newest = static_cast<uint16_t>(kRampStart + first + kFactor - 1);
+			const int32_t delay_q4 = (kFactor - 1) * 16 / 2;
+			assert(r.a_q4 == InputCalibration::linearize_q4(newest) - delay_q4);
+
+			// As the gate scan does: each pair once, from the window.
+			for (uint32_t i = 0; i < kFactor; ++i) {
+				if (static_cast<int32_t>(first + i - gate_next_pair) < 0) continue;
+				if (gate.update(window[i].raw_b) == GateComparator::Transition::kRise) {
+					rise_pair = first + i;
+				}
+			}
+			gate_next_pair = first + kFactor;
+		}
+		// The first tick of the new run is held; every other tick reads.
+		assert(held_ticks == 1);
+		assert(rise_pair >= kPauseEnd && rise_pair < kPauseEnd + kFactor);
+	}
+
+	// Block reads after a pause and resume: a run from pair 100 to 200, then a
+	// gap, then a run from pair 240. Only ranges inside the newest run read.
+	{
+		const CvInCapture::Progress paused{200, 100};
+		assert(CvInCapture::range_in_run(paused, 150, 50));
+		assert(!CvInCapture::range_in_run(paused, 150, 51));  // not captured yet
+
+		CvInCapture::Progress resumed{240, 240};
+		assert(!CvInCapture::range_in_run(resumed, 239, 1));  // the latest pair is a gap pair
+		resumed.pairs = 250;
+		assert(CvInCapture::range_in_run(resumed, 240, 10));
+		assert(CvInCapture::range_in_run(resumed, 249, 1));
+		assert(!CvInCapture::range_in_run(resumed, 230, 20));  // crosses the run start
+		assert(!CvInCapture::range_in_run(resumed, 150, 10));  // an earlier run
+		assert(!CvInCapture::range_in_run(resumed, 240, 0));
+
+		// The ring keeps one pair of slack behind the newest.
+		const CvInCapture::Progress long_run{240 + CvInCapture::kRingPairs, 240};
+		assert(!CvInCapture::range_in_run(long_run, 240, 1));
+		assert(CvInCapture::range_in_run(long_run, 241, 1));
+	}
+
+	// Resolution: with an LSB of ADC noise as dither, a single reading is off
+	// by about a code rms and the decimated one by a quarter of that, sub-code
+	// steps included. Within the wider DNL codes the noise no longer dithers,
+	// so the gain there is smaller.
+	{
+		const InputCalibration::Endpoints& nominal = InputCalibration::kNominal;
+		const double volts_per_q4 = 10.0 / (nominal.plus_q4 - nominal.minus_q4);
+		const float volts_per_code = static_cast<float>(16.0 * volts_per_q4);
+		const InputCalibration cal;
+		double single_sq = 0.0;
+		double decimated_sq = 0.0;
+		double mv_sq = 0.0;
+		double off_spike_sq = 0.0;
+		uint32_t count = 0;
+		uint32_t off_spike_count = 0;
+		for (float v = -4.9f; v < 4.9f; v += 0.0031f) {
+			CvInCapture::Sample pairs[kFactor];
+			for (CvInCapture::Sample& p : pairs) {
+				p.raw_a = fake::voltage_to_raw(v + noise_v(volts_per_code));
+				p.raw_b = p.raw_a;
+			}
+			const cv_in_decimator::Reading r = cv_in_decimator::decimate(pairs);
+			const double single_codes = (fake::raw_to_voltage(pairs[0].raw_a) - v) / volts_per_code;
+			const double decimated_codes =
+				(-5.0 + (r.a_q4 - nominal.minus_q4) * volts_per_q4 - v) / volts_per_code;
+			const double mv = cal.linear_to_signal_mv(InputCalibration::kChannelA, r.a_q4) - v * 1000.0;
+			single_sq += single_codes * single_codes;
+			decimated_sq += decimated_codes * decimated_codes;
+			mv_sq += mv * mv;
+			++count;
+			const uint16_t phase = fake::voltage_to_raw(v) % InputCalibration::kDnlSpikePeriod;
+			if (phase < InputCalibration::kDnlFirstSpike - 12 ||
+				phase > InputCalibration::kDnlFirstSpike + 12) {
+				off_spike_sq += decimated_codes * decimated_codes;
+				++off_spike_count;
+			}
+		}
+		const double single_rms = std::sqrt(single_sq / count);
+		const double decimated_rms = std::sqrt(decimated_sq / count);
+		const double off_spike_rms = std::sqrt(off_spike_sq / off_spike_count);
+		assert(single_rms > 1.0);
+		assert(off_spike_rms < 0.28 && off_spike_rms < single_rms / 3.8);
+		assert(decimated_rms < single_rms / 3.0);
+		assert(std::sqrt(mv_sq / count) < 1.1);
+	}
+
+	std::puts("cv_in_decimator_test: PASS");
+	return 0;
+}
@@ -0,0 +1,35 @@
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+
+#include "../src/cv-units.h"
+
+int main() {
+	// mv_to_dac matches round-to-nearest of the exact ratio over the full range.
+	for (int32_t mv = 0; mv <= cv_units::kDacFullScaleMv; ++mv) {
+		const long expected = std::lround(mv * 4095.0 / 10000.0);
+		assert(cv_units::mv_to_dac(mv) == expected);
+	}
+	assert(cv_units::mv_to_dac(-100) == 0);
+	assert(cv_units::mv_to_dac(12000) == cv_units::kDacMax);
+
+	// Every DAC code survives a round trip through millivolts.
+	for (uint16_t code = 0; code <= cv_units::kDacMax; ++code) {
+		assert(cv_units::mv_to_dac(cv_units::dac_to_mv(code)) == code);
+	}
+
+	// The 32-bit Q16 mV -> 1/256 code conversion stays within one step of the
+	// exact ratio, and lands exactly on both ends of the range.
+	for (int64_t mv_q16 = 0; mv_q16 <= (cv_units::kDacFullScaleMv << 16); mv_q16 += 997) {
+		const double exact = static_cast<double>(mv_q16) * 4095.0 * 256.0 / (10000.0 * 65536.0);
+		const double got = cv_units::mv_q16_to_code_q8(static_cast<int32_t>(mv_q16));
+		assert(std::fabs(got - exact) < 1.0);
+	}
+	static_assert(cv_units::mv_q16_to_code_q8(0) == 0, "0 mV is code 0");
+	static_assert(cv_units::mv_q16_to_code_q8(cv_units::kDacFullScaleMv << 16) ==
+					  static_cast<uint32_t>(cv_units::kDacMax) << 8,
+				  "10 V is the top code");
+
+	std::puts("cv_units_test: PASS");
+	return 0;
+}
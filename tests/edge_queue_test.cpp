@@ -0,0 +1,164 @@
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+
+#include "../src/ad-envelope.h"
+#include "../src/edge-queue.h"
+#include "../src/gate-comparator.h"
+#include "../src/input-calibration.h"
+
+namespace {
+constexpr uint32_t kTickUs = 125;
+}  // namespace
+
+int main() {
+	// Queue: FIFO, peek does not consume, a full queue drops and counts.
+	{
+		EdgeQueue queue;
+		Edge edge;
+		assert(!queue.peek(edge) && !queue.pop(edge));
+		for (uint32_t i = 0; i < EdgeQueue::kCapacity; ++i) assert(queue.push(i, (i & 1) == 0));
+		assert(!queue.push(999, true));
+		assert(queue.dropped() == 1);
+		assert(queue.peek(edge) && edge.time_us == 0);
+		for (uint32_t i = 0; i < EdgeQueue::kCapacity; ++i) {
+			assert(queue.pop(edge));
+			assert(edge.time_us == i && edge.rising == ((i & 1) == 0));
+		}
+		assert(!queue.pop(edge));
+	}
+
+	// Concurrent producer (the interrupt) and consumer (the tick): every edge
+	// arrives once, in order, as long as the consumer keeps up.
+	{
+		EdgeQueue queue;
+		constexpr uint32_t kEdges = 200000;
+		std::thread producer([&]() {
+			for (uint32_t i = 0; i < kEdges;) {
+				if (queue.push(i, (i & 1) == 0)) {
+					++i;
+				} else {
+					std::this_thread::yield();
+				}
+			}
+		});
+		uint32_t expected = 0;
+		Edge edge;
+		while (expected < kEdges) {
+			if (!queue.pop(edge)) {
+				std::this_thread::yield();
+				continue;
+			}
+			assert(edge.time_us == expected && edge.rising == ((expected & 1) == 0));
+			++expected;
+		}
+		producer.join();
+	}
+
+	// Folding into frames: a pulse that starts and ends between two frames is
+	// still a rising edge, aged from its start; the newest of several wins;
+	// edges after the frame's time wait for the next frame.
+	{
+		EdgeQueue queue;
+		EdgeInput input;
+		queue.push(1030, true);
+		queue.push(1040, false);
+		queue.push(1080, true);
+		queue.push(1090, false);
+		queue.push(1130, true);
+		input.drain(queue, 1125);
+		EdgeInput::State state = input.take(1125);
+		assert(state.rose && !state.high && state.rise_age_us == 45);
+
+		input.drain(queue, 1250);
+		state = input.take(1250);
+		assert(state.rose && state.high && state.rise_age_us == 120);
+
+		input.drain(queue, 1375);
+		state = input.take(1375);
+		assert(!state.rose && state.high && state.rise_age_us == 0);
+
+		// Ages saturate rather than wrap.
+		input.add(0, false);
+		input.add(100, true);
+		state = input.take(100 + 1000000);
+		assert(state.rose && state.rise_age_us == 0xFFFF);
+		// An edge timed a little after the frame counts as at the frame.
+		input.add(0xFFFFFFF0u, false);
+		input.add(5, true);
+		state = input.take(0xFFFFFFFEu);
+		assert(state.rose && state.rise_age_us == 0);
+	}
+
+	// Gate comparator: noise around the threshold gives one rise and one fall.
+	{
+		GateComparator gate;
+		uint32_t rises = 0;
+		uint32_t falls = 0;
+		const int32_t levels[] = {0, 980, 995, 1000, 970, 1010, 940, 1020, 905, 1000,
+								  960, 899, 950, 905, 899, 0};
+		for (int32_t mv : levels) {
+			const GateComparator::Transition t = gate.update(mv);
+			if (t == GateComparator::Transition::kRise) ++rises;
+			if (t == GateComparator::Transition::kFall) ++falls;
+		}
+		assert(rises == 1 && falls == 1);
+		assert(!gate.high());
+	}
+
+	// Raw-code thresholds: the lowest code reading at or above the level.
+	{
+		InputCalibration cal;
+		InputCalibration::Endpoints skewed{InputCalibration::kNominal.minus_q4 + 200,
+										   InputCalibration::kNominal.plus_q4 - 150};
+		assert(cal.set_endpoints(InputCalibration::kChannelB, skewed));
+		const int32_t levels[] = {-5000, -1, 0, GateComparator::kFallMv, GateComparator::kRiseMv,
+								  4999};
+		for (uint8_t channel = 0; channel < InputCalibration::kNumChannels; ++channel) {
+			for (int32_t mv : levels) {
+				const uint32_t raw = cal.raw_at_mv(channel, mv);
+				assert(raw > 0 && raw < InputCalibration::kNumCodes);
+				assert(cal.to_signal_mv(channel, static_cast<uint16_t>(raw)) >= mv);
+				assert(cal.to_signal_mv(channel, static_cast<uint16_t>(raw - 1)) < mv);
+			}
+		}
+		assert(cal.raw_at_mv(InputCalibration::kChannelA, 30000) == InputCalibration::kNumCodes);
+	}
+
+	// Envelope timing: a trigger one frame old starts the attack exactly
+	// where a trigger on the previous frame would have it.
+	{
+		ControlSnapshot controls{};
+		controls.set_pot(0, 60, 0);
+		controls.set_pot(1, 60, 0);
+		AdEnvelope early;
+		AdEnvelope late;
+		Frame idle{0, 0, 0};
+		Frame on_time{0, 0, Frame::kPulseRise};
+		Frame aged{0, 0, Frame::kPulseRise};
+		aged.pulse_us = kTickUs;
+		Frame gate_aged{0, 0, 0};
+		gate_aged.gate = Frame::kGateRiseA | Frame::kGateRiseB;
+		gate_aged.gate_rise_age_us[0] = kTickUs;
+		gate_aged.gate_rise_age_us[1] = kTickUs;
+		AdEnvelope gated;
+		for (uint32_t k = 0; k < 400; ++k) {
+			const BlockParams params{controls, k * kTickUs, kTickUs};
+			Frame out_early;
+			Frame out_late;
+			Frame out_gated;
+			early.process(params, k == 9 ? &on_time : &idle, &out_early, 1);
+			late.process(params, k == 10 ? &aged : &idle, &out_late, 1);
+			gated.process(params, k == 10 ? &gate_aged : &idle, &out_gated, 1);
+			if (k >= 10) {
+				assert(out_early.a == out_late.a && out_early.b == out_late.b);
+				assert(out_early.a == out_gated.a && out_early.b == out_gated.b);
+			}
+		}
+	}
+
+	std::puts("edge_queue_test: PASS");
+	return 0;
+}
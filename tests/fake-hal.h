@@ -0,0 +1,256 @@
+#ifndef FAKE_HAL_H_
+#define FAKE_HAL_H_
+
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include "../src/frame.h"
+#include "../src/gate-comparator.h"
+#include "../src/hal.h"
+#include "../src/input-calibration.h"
+#include "../src/output-calibration.h"
+#include "../src/pulse-out.h"
+#include "../src/pulse-scheduler.h"
+#include "../src/sigma-delta.h"
+
+// In-memory HAL fakes for host builds of the mode classes.
+namespace fake {
+
+// ADC model: a nominal unit with the DNL InputCalibration corrects for.
+inline float raw_to_voltage(uint16_t raw) {
+	const InputCalibration::Endpoints& e = InputCalibration::kNominal;
+	return -5.0f + static_cast<float>(InputCalibration::linearize_q4(raw) - e.minus_q4) * 10.0f /
+					   static_cast<float>(e.plus_q4 - e.minus_q4);
+}
+
+// The code the modelled ADC reads for `voltage`: the one whose width (one
+// code, or wider on a DNL spike) around its linearized centre covers it.
+inline uint16_t voltage_to_raw(float voltage) {
+	const InputCalibration::Endpoints& e = InputCalibration::kNominal;
+	const float q4 = static_cast<float>(e.minus_q4) +
+					 (voltage + 5.0f) * static_cast<float>(e.plus_q4 - e.minus_q4) / 10.0f;
+	for (uint16_t raw = 0; raw < InputCalibration::kNumCodes - 1; ++raw) {
+		const bool wide = raw % InputCalibration::kDnlSpikePeriod == InputCalibration::kDnlFirstSpike;
+		const int32_t width_q4 = 16 + (wide ? InputCalibration::kDnlExtraWidthQ4 : 0);
+		if (q4 < static_cast<float>(InputCalibration::linearize_q4(raw) + width_q4 / 2)) return raw;
+	}
+	return InputCalibration::kNumCodes - 1;
+}
+
+class CvIn : public hal::CvIn {
+public:
+	void set_raw(uint16_t a, uint16_t b) {
+		raw_a_ = a;
+		raw_b_ = b;
+	}
+	void set_voltage(float a, float b) { set_raw(voltage_to_raw(a), voltage_to_raw(b)); }
+
+	uint16_t get_raw_channel_a() const override { return raw_a_; }
+	uint16_t get_raw_channel_b() const override { return raw_b_; }
+	float get_voltage_channel_a() const override { return raw_to_voltage(raw_a_); }
+	float get_voltage_channel_b() const override { return raw_to_voltage(raw_b_); }
+
+private:
+	uint16_t raw_a_ = voltage_to_raw(0.0f);
+	uint16_t raw_b_ = voltage_to_raw(0.0f);
+};
+
+class CvOut : public hal::CvOut {
+public:
+	void stage(hal::CvOutChannel channel, uint16_t code) override {
+		staged_[static_cast<uint8_t>(channel)] = code;
+		staged_any_ = true;
+	}
+
+	bool latch() override {
+		if (!staged_any_) return false;
+		staged_any_ = false;
+		code_a = staged_[0];
+		code_b = staged_[1];
+		++writes;
+		return true;
+	}
+
+	// Output voltage the DAC would produce for the last latched code.
+	float voltage_a() const { return code_to_voltage(code_a); }
+	float voltage_b() const { return code_to_voltage(code_b); }
+
+	uint16_t code_a = 0;
+	uint16_t code_b = 0;
+	uint64_t writes = 0;
+
+private:
+	uint16_t staged_[2] = {};
+	bool staged_any_ = false;
+
+	static float code_to_voltage(uint16_t code) { return static_cast<float>(code) * 10.0f / 4095.0f; }
+};
+
+class Pulse : public hal::Pulse {
+public:
+	// Drive the pulse input; a rising edge fires the on_rise callback on the next poll().
+	void set_input(bool high) {
+		if (high && !input_high_) rise_pending_ = true;
+		input_high_ = high;
+	}
+
+	void on_rise(std::function<void()> callback) override { on_rise_ = std::move(callback); }
+	void poll() override {
+		if (rise_pending_ && on_rise_) on_rise_();
+		rise_pending_ = false;
+	}
+	bool read() override { return input_high_; }
+	void set(bool high) override {
+		if (high && !output_high) ++output_rises;
+		output_high = high;
+	}
+
+	bool output_high = false;
+	uint32_t output_rises = 0;
+
+private:
+	std::function<void()> on_rise_;
+	bool input_high_ = false;
+	bool rise_pending_ = false;
+};
+
+class Leds : public hal::Leds {
+public:
+	void on(uint8_t index) override { brightness[index] = 255; }
+	void off(uint8_t index) override { brightness[index] = 0; }
+	void off_all() override {
+		for (uint8_t& b : brightness) b = 0;
+	}
+	void set_brightness(uint8_t index, uint8_t value) override { brightness[index] = value; }
+
+	uint8_t brightness[6] = {};
+};
+
+class Clock : public hal::Clock {
+public:
+	uint32_t now_us() const override { return now; }
+	void advance(uint32_t us) { now += us; }
+
+	uint32_t now = 0;
+};
+
+// Thrown by Flash when the simulated power cut hits.
+struct PowerLoss {};
+
+// RAM-backed NOR flash. Programming ANDs bits in like the real part. Setting
+// power_loss_at = n cuts power during the n-th program or erase from then on:
+// the operation is left partly done (the first tear_*_bytes of it) and
+// PowerLoss is thrown.
+class Flash : public hal::Flash {
+public:
+	explicit Flash(uint32_t num_sectors)
+		: memory(num_sectors * kSectorSize, 0xFF), erase_counts(num_sectors, 0) {}
+
+	uint32_t size() const override { return static_cast<uint32_t>(memory.size()); }
+
+	void read(uint32_t offset, void* out, uint32_t size) const override {
+		std::memcpy(out, memory.data() + offset, size);
+	}
+
+	bool program_page(uint32_t offset, const uint8_t* data) override {
+		for (uint32_t i = 0; i < kPageSize; ++i) {
+			if (memory[offset + i] != 0xFF) ++overwrites;
+		}
+		const uint32_t bytes = cut_now() ? tear_program_bytes : kPageSize;
+		for (uint32_t i = 0; i < bytes; ++i) memory[offset + i] &= data[i];
+		++programs;
+		if (bytes != kPageSize) throw PowerLoss{};
+		return true;
+	}
+
+	bool erase_sector(uint32_t offset) override {
+		const uint32_t bytes = cut_now() ? tear_erase_bytes : kSectorSize;
+		std::memset(memory.data() + offset, 0xFF, bytes);
+		++erase_counts[offset / kSectorSize];
+		if (bytes != kSectorSize) throw PowerLoss{};
+		return true;
+	}
+
+	std::vector<uint8_t> memory;
+	std::vector<uint32_t> erase_counts;
+	uint32_t programs = 0;
+	uint32_t overwrites = 0;  // programs onto pages that were not erased
+	uint32_t power_loss_at = 0;
+	uint32_t tear_program_bytes = kPageSize / 2;
+	uint32_t tear_erase_bytes = kSectorSize / 2;
+
+private:
+	bool cut_now() {
+		if (power_loss_at == 0) return false;
+		return --power_loss_at == 0;
+	}
+};
+
+// Runs a mode one frame per tick against the fakes, the way the firmware's
+// sample tick bridges the HAL and process(): calibrated millivolts in,
+// calibrated DAC codes out. Edges land on frame times here, and the gate
+// comparators see one reading per frame rather than every oversampled pair.
+class Rig {
+public:
+	explicit Rig(uint32_t period_us = 125) : period_us(period_us) {
+		pulse.on_rise([this]() { pulse_rise_pending_ = true; });
+	}
+
+	template <typename Mode>
+	void tick(Mode& mode, const ControlSnapshot& controls) {
+		clock.advance(period_us);
+		pulse.poll();
+		Frame in{};
+		in.a = input_cal.to_signal_mv(InputCalibration::kChannelA, cv_in.get_raw_channel_a());
+		in.b = input_cal.to_signal_mv(InputCalibration::kChannelB, cv_in.get_raw_channel_b());
+		in.pulse = static_cast<uint8_t>((pulse.read() ? Frame::kPulseHigh : 0) |
+										(pulse_rise_pending_ ? Frame::kPulseRise : 0));
+		pulse_rise_pending_ = false;
+		in.gate = gate_bits(gates_[0].update(in.a), gates_[0].high(), Frame::kGateHighA,
+							Frame::kGateRiseA) |
+				  gate_bits(gates_[1].update(in.b), gates_[1].high(), Frame::kGateHighB,
+							Frame::kGateRiseB);
+
+		Frame out;
+		mode.process(BlockParams{controls, clock.now, period_us}, &in, &out, 1);
+		// The firmware latches a frame at the start of the next tick; here it
+		// lands straight away, so tests read a tick's output right after it.
+		cv_out.stage(hal::CvOutChannel::kChannelA,
+					 output_dither_[0].process(output_cal.apply_q8(
+						 OutputCalibration::kChannelA, out.a, out.code_frac[0])));
+		cv_out.stage(hal::CvOutChannel::kChannelB,
+					 output_dither_[1].process(output_cal.apply_q8(
+						 OutputCalibration::kChannelB, out.b, out.code_frac[1])));
+		cv_out.latch();
+		// The alarm's transitions land on tick times here.
+		if (out.pulse & Frame::kPulseRise) pulse_out_.request(clock.now, out.pulse_us);
+		pulse.set(pulse_out_.update(clock.now));
+	}
+
+	CvIn cv_in;
+	CvOut cv_out;
+	Pulse pulse;
+	Clock clock;
+	InputCalibration input_cal;
+	OutputCalibration output_cal;
+	uint32_t period_us;
+
+private:
+	static uint8_t gate_bits(GateComparator::Transition t, bool high, uint8_t high_bit,
+							 uint8_t rise_bit) {
+		return static_cast<uint8_t>((high ? high_bit : 0) |
+									(t == GateComparator::Transition::kRise ? rise_bit : 0));
+	}
+
+	bool pulse_rise_pending_ = false;
+	GateComparator gates_[2];
+	SigmaDelta output_dither_[2];
+	PulseScheduler pulse_out_{PulseOut::kMinGapUs, PulseScheduler::Retrigger::kRestart};
+};
+
+}  // namespace fake
+
+#endif  // FAKE_HAL_H_
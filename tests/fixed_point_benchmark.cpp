@@ -0,0 +1,34 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+#include "../src/fixed-point-bench.h"
+
+// Times each fixed_point primitive, its shift-based variant and each pot
+// curve against its lookup table, in isolation. The same kernels run on the
+// module from the USB console ('b'), in cycles.
+// Usage: fixed_point_benchmark [iterations]
+int main(int argc, char** argv) {
+	uint32_t iterations = 50000000;
+	if (argc > 1) iterations = static_cast<uint32_t>(std::strtoul(argv[1], nullptr, 10));
+	if (iterations == 0) iterations = 1;
+
+	double ns[64] = {};
+	uint32_t checksum = 0;
+	for (uint32_t k = 0; k < fixed_point_bench::kNumKernels && k < 64; ++k) {
+		const auto start = std::chrono::steady_clock::now();
+		checksum += fixed_point_bench::kKernels[k].run(iterations);
+		const auto end = std::chrono::steady_clock::now();
+		ns[k] = std::chrono::duration<double, std::nano>(end - start).count() / iterations;
+	}
+
+	std::printf("ns/op, input generation (baseline) subtracted\n");
+	std::printf("%-20s %8.2f (raw)\n", fixed_point_bench::kKernels[0].name, ns[0]);
+	for (uint32_t k = 1; k < fixed_point_bench::kNumKernels && k < 64; ++k) {
+		std::printf("%-20s %8.2f\n", fixed_point_bench::kKernels[k].name, ns[k] - ns[0]);
+	}
+	// Keep the work observable so the optimizer cannot drop it.
+	if (checksum == 0xFFFFFFFFu) std::puts("");
+	return 0;
+}
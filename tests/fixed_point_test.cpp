@@ -0,0 +1,78 @@
+#include <cassert>
+#include <cstdint>
+#include <cstdio>
+
+#include "../src/fixed-point.h"
+
+// Exhaustive checks of the shift-based variants against the reference
+// primitives. The rounding kernel is checked over every int32; the narrow
+// multiply over every int16 value at every Q15 gain.
+namespace {
+constexpr int32_t kQ15One = fixed_point::kQ15One;
+
+int64_t floor_div_q15(int64_t p) {
+	return p >= 0 ? p / kQ15One : -((-p + kQ15One - 1) / kQ15One);
+}
+}  // namespace
+
+int main() {
+	// The biased shift truncates like the signed divide, for every int32.
+	for (int64_t p = INT32_MIN; p <= INT32_MAX; ++p) {
+		const int32_t p32 = static_cast<int32_t>(p);
+		assert(fixed_point::shift_q15_trunc(p32) == p32 / kQ15One);
+	}
+
+	// mul_q15_narrow is bit-identical to mul_q15 for every int16 value and
+	// gain 0..1; mul_q15_floor rounds down instead, one less exactly when the
+	// product is negative and not a multiple of 2^15.
+	for (int32_t value = INT16_MIN; value <= INT16_MAX; ++value) {
+		for (int32_t gain = 0; gain <= kQ15One; ++gain) {
+			const uint16_t g = static_cast<uint16_t>(gain);
+			const int32_t reference = fixed_point::mul_q15(value, g);
+			assert(fixed_point::mul_q15_narrow(value, g) == reference);
+			const int64_t product = static_cast<int64_t>(value) * gain;
+			const int32_t floored = fixed_point::mul_q15_floor(value, g);
+			assert(floored == floor_div_q15(product));
+			assert(floored == reference - (product < 0 && product % kQ15One != 0 ? 1 : 0));
+		}
+	}
+
+	// ... and out to the edges of the narrow range.
+	const int32_t edges[] = {-fixed_point::kNarrowMax, -fixed_point::kNarrowMax + 1, -40000,
+							 40000, fixed_point::kNarrowMax - 1, fixed_point::kNarrowMax};
+	for (int32_t value : edges) {
+		for (int32_t gain = 0; gain <= kQ15One; ++gain) {
+			const uint16_t g = static_cast<uint16_t>(gain);
+			assert(fixed_point::mul_q15_narrow(value, g) == fixed_point::mul_q15(value, g));
+		}
+	}
+
+	// blend_q15_narrow matches blend_q15 across the narrow range: every t for
+	// a spread of endpoint pairs, including the extremes.
+	for (int32_t a = -fixed_point::kNarrowMax; a <= fixed_point::kNarrowMax; a += 4093) {
+		for (int32_t b = -fixed_point::kNarrowMax; b <= fixed_point::kNarrowMax; b += 4099) {
+			for (int32_t t = 0; t <= kQ15One; ++t) {
+				const uint16_t tq = static_cast<uint16_t>(t);
+				assert(fixed_point::blend_q15_narrow(a, b, tq) == fixed_point::blend_q15(a, b, tq));
+			}
+		}
+	}
+	for (int32_t a : edges) {
+		for (int32_t b : edges) {
+			for (int32_t t = 0; t <= kQ15One; ++t) {
+				const uint16_t tq = static_cast<uint16_t>(t);
+				assert(fixed_point::blend_q15_narrow(a, b, tq) == fixed_point::blend_q15(a, b, tq));
+			}
+		}
+	}
+
+	// u8_to_q15_shift is identical for all 256 pot values.
+	for (uint32_t v = 0; v < 256; ++v) {
+		const uint8_t v8 = static_cast<uint8_t>(v);
+		assert(fixed_point::u8_to_q15_shift(v8) == fixed_point::u8_to_q15(v8));
+	}
+	assert(fixed_point::u8_to_q15_shift(255) == kQ15One);
+
+	std::puts("fixed_point_test: PASS");
+	return 0;
+}
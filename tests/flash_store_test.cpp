@@ -0,0 +1,220 @@
+#include <cassert>
+#include <cstdint>
+#include <cstdio>
+
+#include "../src/flash-store.h"
+#include "fake-hal.h"
+
+namespace {
+constexpr uint32_t kSectors = 4;
+constexpr StoreKey kKeyA = StoreKey::kCalibration;
+constexpr StoreKey kKeyB = static_cast<StoreKey>(1);
+constexpr uint32_t kNoValue = 0;
+
+// Payloads are filled from their value so a mixed or torn payload is caught.
+struct BigPayload {
+	uint32_t value;
+	uint8_t fill[40];
+};
+struct SmallPayload {
+	uint32_t value;
+	uint32_t check;
+};
+
+bool save_value(FlashStore& store, StoreKey key, uint32_t value) {
+	if (key == kKeyA) {
+		BigPayload p{value, {}};
+		for (uint8_t i = 0; i < sizeof(p.fill); ++i) p.fill[i] = static_cast<uint8_t>(value + i);
+		return store.save(key, &p, sizeof(p));
+	}
+	const SmallPayload p{value, ~value};
+	return store.save(key, &p, sizeof(p));
+}
+
+uint32_t load_value(const FlashStore& store, StoreKey key) {
+	if (key == kKeyA) {
+		BigPayload p;
+		if (!store.load(key, &p, sizeof(p))) return kNoValue;
+		for (uint8_t i = 0; i < sizeof(p.fill); ++i) {
+			assert(p.fill[i] == static_cast<uint8_t>(p.value + i));
+		}
+		return p.value;
+	}
+	SmallPayload p;
+	if (!store.load(key, &p, sizeof(p))) return kNoValue;
+	assert(p.check == ~p.value);
+	return p.value;
+}
+
+// The workload: key A saved often, key B rarely, maintenance as soon as it is
+// pending, enough saves to lap the region several times.
+constexpr uint32_t kNumSaves = 200;
+
+StoreKey key_for(uint32_t i) { return i % 64 == 3 ? kKeyB : kKeyA; }
+
+struct Committed {
+	uint32_t a = kNoValue;
+	uint32_t b = kNoValue;
+	uint32_t& operator[](StoreKey key) { return key == kKeyA ? a : b; }
+};
+
+// Runs the workload on a freshly booted store; `committed` tracks every
+// save that returned, `in_flight` the one being made.
+void run_workload(fake::Flash& flash, Committed& committed, StoreKey& in_flight_key,
+				  uint32_t& in_flight_value) {
+	FlashStore store(flash);
+	store.init();
+	for (uint32_t i = 0; i < kNumSaves; ++i) {
+		in_flight_key = key_for(i);
+		in_flight_value = i + 1;
+		const uint32_t erases_before = flash.erase_counts[0] + flash.erase_counts[1] +
+									   flash.erase_counts[2] + flash.erase_counts[3];
+		assert(save_value(store, in_flight_key, in_flight_value));
+		// Saving never erases.
+		assert(flash.erase_counts[0] + flash.erase_counts[1] + flash.erase_counts[2] +
+				   flash.erase_counts[3] ==
+			   erases_before);
+		committed[in_flight_key] = in_flight_value;
+		in_flight_value = kNoValue;
+		if (store.maintenance_pending()) assert(store.maintain());
+	}
+}
+}  // namespace
+
+int main() {
+	// Empty flash: nothing to load, saves round-trip and survive a reboot.
+	{
+		fake::Flash flash(kSectors);
+		FlashStore store(flash);
+		store.init();
+		assert(load_value(store, kKeyA) == kNoValue);
+		assert(!store.maintenance_pending());
+		assert(save_value(store, kKeyA, 7) && save_value(store, kKeyB, 9));
+		assert(save_value(store, kKeyA, 8));
+		assert(load_value(store, kKeyA) == 8 && load_value(store, kKeyB) == 9);
+
+		FlashStore rebooted(flash);
+		rebooted.init();
+		assert(load_value(rebooted, kKeyA) == 8 && load_value(rebooted, kKeyB) == 9);
+
+		// A size mismatch is not a valid load; oversize saves are refused.
+		uint32_t wrong;
+		assert(!rebooted.load(kKeyA, &wrong, sizeof(wrong)));
+		uint8_t big[FlashStore::kMaxPayload + 1] = {};
+		assert(!rebooted.save(kKeyA, big, sizeof(big)));
+	}
+
+	// Full workload: every record lands on an erased page, the rarely saved key
+	// is carried across laps, and erases spread evenly over the sectors.
+	{
+		fake::Flash flash(kSectors);
+		Committed committed;
+		StoreKey key;
+		uint32_t value;
+		run_workload(flash, committed, key, value);
+		assert(flash.overwrites == 0);
+		assert(flash.programs > kNumSaves);  // key B was copied forward
+
+		FlashStore store(flash);
+		store.init();
+		assert(load_value(store, kKeyA) == committed.a);
+		assert(load_value(store, kKeyB) == committed.b);
+
+		uint32_t min_erases = flash.erase_counts[0];
+		uint32_t max_erases = flash.erase_counts[0];
+		for (uint32_t count : flash.erase_counts) {
+			min_erases = count < min_erases ? count : min_erases;
+			max_erases = count > max_erases ? count : max_erases;
+		}
+		assert(min_erases >= 2 && max_erases - min_erases <= 1);
+		std::printf("workload: %u programs, erases per sector %u-%u\n", flash.programs,
+					min_erases, max_erases);
+	}
+
+	// Deferred maintenance: saves fill the current sector up to the reserve and
+	// then fail, but nothing is lost, and maintain() makes room again.
+	{
+		fake::Flash flash(kSectors);
+		FlashStore store(flash);
+		store.init();
+		assert(save_value(store, kKeyB, 1000));
+		uint32_t value = 1;
+		while (!store.maintenance_pending()) assert(save_value(store, kKeyA, value++));
+		uint32_t accepted = 0;
+		while (save_value(store, kKeyA, value)) {
+			++accepted;
+			++value;
+		}
+		assert(accepted > 0 && accepted < 16);
+		assert(load_value(store, kKeyA) == value - 1);
+		assert(store.maintain());
+		assert(save_value(store, kKeyA, value));
+		assert(load_value(store, kKeyA) == value && load_value(store, kKeyB) == 1000);
+	}
+
+	// Power loss at every program and erase step of the workload, with torn
+	// pages and sectors of several shapes. After the reboot each key holds its
+	// last committed value or the one in flight, and the store keeps working.
+	{
+		uint32_t total_steps;
+		{
+			fake::Flash flash(kSectors);
+			Committed committed;
+			StoreKey key;
+			uint32_t value;
+			run_workload(flash, committed, key, value);
+			total_steps = flash.programs;
+			for (uint32_t count : flash.erase_counts) total_steps += count;
+		}
+
+		const uint32_t kTearProgram[] = {0, 4, 12, 100, 255};
+		const uint32_t kTearErase[] = {0, 256, 2048, 4095};
+		uint32_t cuts = 0;
+		for (uint32_t tear = 0; tear < 5; ++tear) {
+			for (uint32_t step = 1; step <= total_steps; ++step) {
+				fake::Flash flash(kSectors);
+				flash.tear_program_bytes = kTearProgram[tear];
+				flash.tear_erase_bytes = kTearErase[tear % 4];
+				flash.power_loss_at = step;
+				Committed committed;
+				StoreKey in_flight_key = kKeyA;
+				uint32_t in_flight_value = kNoValue;
+				bool lost = false;
+				try {
+					run_workload(flash, committed, in_flight_key, in_flight_value);
+				} catch (const fake::PowerLoss&) {
+					lost = true;
+				}
+				assert(lost);
+				++cuts;
+
+				FlashStore store(flash);
+				store.init();
+				const StoreKey keys[] = {kKeyA, kKeyB};
+				for (StoreKey key : keys) {
+					const uint32_t loaded = load_value(store, key);
+					const bool ok = loaded == committed[key] ||
+									(key == in_flight_key && loaded == in_flight_value &&
+									 in_flight_value != kNoValue);
+					if (!ok) {
+						std::printf("step %u tear %u: key %u loaded %u, committed %u\n", step,
+									tear, static_cast<unsigned>(key), loaded, committed[key]);
+					}
+					assert(ok);
+				}
+
+				// Still usable: finish any maintenance and save again.
+				if (store.maintenance_pending()) assert(store.maintain());
+				assert(save_value(store, kKeyB, 5000));
+				assert(save_value(store, kKeyA, 5001));
+				FlashStore again(flash);
+				again.init();
+				assert(load_value(again, kKeyA) == 5001 && load_value(again, kKeyB) == 5000);
+			}
+		}
+		std::printf("power loss: %u cuts over %u steps\n", cuts, total_steps);
+	}
+
+	std::puts("flash_store_test: PASS");
+	return 0;
+}
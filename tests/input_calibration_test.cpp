@@ -0,0 +1,109 @@
+#include <cassert>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+#include "../src/input-calibration.h"
+#include "fake-hal.h"
+
+int main() {
+	using IC = InputCalibration;
+
+	// DNL model: one code per step, except each wide code takes the extra
+	// width, split evenly before and after its centre.
+	for (uint16_t raw = 1; raw < IC::kNumCodes; ++raw) {
+		const int32_t step = IC::linearize_q4(raw) - IC::linearize_q4(raw - 1);
+		const bool into_spike = raw % IC::kDnlSpikePeriod == IC::kDnlFirstSpike;
+		const bool out_of_spike = raw % IC::kDnlSpikePeriod == IC::kDnlFirstSpike + 1;
+		if (into_spike || out_of_spike) {
+			assert(step == 16 + IC::kDnlExtraWidthQ4 / 2);
+		} else {
+			assert(step == 16);
+		}
+	}
+
+	// Nominal conversion hits both endpoints and 0V, and rises with every code.
+	IC cal;
+	for (uint8_t channel = 0; channel < IC::kNumChannels; ++channel) {
+		assert(cal.to_signal_mv(channel, 298) == -5000);
+		assert(cal.to_signal_mv(channel, 3723) == 5000);
+		assert(std::abs(cal.to_signal_mv(channel, fake::voltage_to_raw(0.0f))) <= 2);
+		for (uint16_t raw = 1; raw < IC::kNumCodes; ++raw) {
+			assert(cal.to_signal_mv(channel, raw) > cal.to_signal_mv(channel, raw - 1));
+		}
+	}
+
+	// The conversion undoes the modelled ADC to within half the width of the code
+	// read: ~1.5 mV, or ~13 mV on a wide code. Without the DNL model the error
+	// would grow by ~23 mV past each wide code.
+	for (int32_t mv = -5000; mv <= 5000; mv += 7) {
+		const uint16_t raw = fake::voltage_to_raw(static_cast<float>(mv) / 1000.0f);
+		const bool wide = raw % IC::kDnlSpikePeriod == IC::kDnlFirstSpike;
+		assert(std::abs(cal.to_signal_mv(IC::kChannelA, raw) - mv) <= (wide ? 14 : 2));
+	}
+
+	// Fit: a two-point capture at +-4V extends to the +-5V endpoints.
+	{
+		IC::Endpoints e;
+		const int32_t low_q4 = IC::linearize_q4(640) + 5;
+		const int32_t high_q4 = IC::linearize_q4(3380) - 3;
+		assert(IC::fit(-4000, low_q4, 4000, high_q4, e));
+		const int32_t span = high_q4 - low_q4;
+		assert(std::abs(e.minus_q4 - (low_q4 - span / 8)) <= 1);
+		assert(std::abs(e.plus_q4 - (high_q4 + span / 8)) <= 1);
+		assert(IC::plausible(e));
+
+		// Applying it moves only that channel, and the captured points now read
+		// back as +-4V.
+		assert(cal.set_endpoints(IC::kChannelB, e));
+		assert(cal.to_signal_mv(IC::kChannelA, 298) == -5000);
+		assert(std::abs(cal.to_signal_mv(IC::kChannelB, 640) - -4000) <= 2);
+		assert(std::abs(cal.to_signal_mv(IC::kChannelB, 3380) - 4000) <= 2);
+	}
+
+	// Rejected: falling or degenerate lines, and endpoints far off nominal
+	// (say, an unpatched input reading 0V at both levels).
+	{
+		IC::Endpoints e;
+		assert(!IC::fit(-4000, 3000 * 16, 4000, 1000 * 16, e));
+		assert(!IC::fit(-4000, 2000 * 16, 4000, 2000 * 16, e));
+		assert(IC::fit(-4000, 1990 * 16, 4000, 2010 * 16, e));
+		assert(!IC::plausible(e));
+		const IC::Endpoints before = cal.endpoints(IC::kChannelA);
+		const int16_t mv_before = cal.to_signal_mv(IC::kChannelA, 1000);
+		assert(!cal.set_endpoints(IC::kChannelA, e));
+		assert(cal.endpoints(IC::kChannelA).minus_q4 == before.minus_q4);
+		assert(cal.to_signal_mv(IC::kChannelA, 1000) == mv_before);
+		assert(!cal.set_endpoints(IC::kNumChannels, IC::kNominal));
+	}
+
+	// Codes beyond the endpoints keep extrapolating the line.
+	assert(cal.to_signal_mv(IC::kChannelA, 0) < -5000);
+	assert(cal.to_signal_mv(IC::kChannelA, 4095) > 5000);
+
+	// The 32-bit conversion stays within rounding of the exact line for every
+	// reading in the ADC's range, at the extremes of plausible endpoints too.
+	{
+		const int32_t m = IC::kMaxEndpointErrorQ4;
+		const IC::Endpoints cases[] = {
+			IC::kNominal,
+			{IC::kNominal.minus_q4 + m, IC::kNominal.plus_q4 - m},
+			{IC::kNominal.minus_q4 - m, IC::kNominal.plus_q4 + m},
+			{IC::kNominal.minus_q4 - m, IC::kNominal.plus_q4 - m},
+			{IC::kNominal.minus_q4 + m, IC::kNominal.plus_q4 + m},
+			{IC::kNominal.minus_q4 + 7, IC::kNominal.plus_q4 - 3},
+		};
+		for (const IC::Endpoints& e : cases) {
+			IC line;
+			assert(line.set_endpoints(IC::kChannelA, e));
+			for (int32_t q4 = 0; q4 <= IC::linearize_q4(IC::kNumCodes - 1); ++q4) {
+				const double exact = (q4 - e.minus_q4) * 10000.0 / (e.plus_q4 - e.minus_q4) - 5000.0;
+				const double error = line.linear_to_signal_mv(IC::kChannelA, q4) - exact;
+				assert(error > -0.6 && error < 0.6);
+			}
+		}
+	}
+
+	std::puts("input_calibration_test: PASS");
+	return 0;
+}
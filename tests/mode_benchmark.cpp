@@ -0,0 +1,84 @@
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+#include "../src/ad-envelope.h"
+#include "../src/attenuverter.h"
+#include "../src/cv-mixer.h"
+#include "../src/frame.h"
+#include "../src/noise.h"
+#include "../src/precision-adder.h"
+#include "../src/slew-limiter.h"
+
+// Drives every mode through process() and reports host ns/sample for each
+// block size, so per-block overhead shows up as the gap between columns.
+// Usage: mode_benchmark [samples]
+namespace {
+constexpr uint32_t kTickUs = 125;  // 8 kHz
+constexpr size_t kBlockSizes[] = {1, 8, 32, 128};
+constexpr size_t kMaxBlock = 128;
+
+// Triangle input sweeping the full ADC range, plus a pulse clock.
+Frame input_frame(uint32_t i) {
+	const uint32_t phase = i % 8192;
+	// Triangle sweeping -5V..+5V and its mirror, in millivolts.
+	const int32_t ramp = static_cast<int32_t>(phase < 4096 ? phase : 8191 - phase);
+	const int16_t mv = static_cast<int16_t>(ramp * 10000 / 4095 - 5000);
+	uint8_t pulse = (i % 400) < 8 ? Frame::kPulseHigh : 0;
+	if (i % 400 == 0) pulse |= Frame::kPulseRise;
+	return {mv, static_cast<int16_t>(-mv), pulse};
+}
+
+template <typename Mode>
+double ns_per_sample(uint32_t samples, size_t block) {
+	Mode mode;
+	Frame in[kMaxBlock];
+	Frame out[kMaxBlock];
+	BlockParams params{{{100, 180, 140}, {1600, 2880, 2240}, {}, false}, 0, kTickUs};
+	uint32_t checksum = 0;
+	const auto start = std::chrono::steady_clock::now();
+	for (uint32_t done = 0; done < samples; done += block) {
+		for (size_t i = 0; i < block; ++i) {
+			in[i] = input_frame(done + static_cast<uint32_t>(i));
+		}
+		mode.process(params, in, out, block);
+		params.start_us += static_cast<uint32_t>(block) * kTickUs;
+		checksum += out[block - 1].a;
+	}
+	const auto end = std::chrono::steady_clock::now();
+	// Keep the work observable so the optimizer cannot drop it.
+	if (checksum == 0xFFFFFFFFu) std::puts("");
+	return std::chrono::duration<double, std::nano>(end - start).count() / samples;
+}
+
+template <typename Mode>
+void run(const char* name, uint32_t samples) {
+	std::printf("%-16s", name);
+	for (size_t block : kBlockSizes) {
+		std::printf(" %8.1f", ns_per_sample<Mode>(samples, block));
+	}
+	std::printf("\n");
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+	uint32_t samples = 2000000;
+	if (argc > 1) samples = static_cast<uint32_t>(std::strtoul(argv[1], nullptr, 10));
+	// Whole blocks only, for every block size.
+	samples -= samples % kMaxBlock;
+	if (samples == 0) samples = kMaxBlock;
+
+	std::printf("ns/sample by block size\n%-16s", "mode");
+	for (size_t block : kBlockSizes) std::printf(" %8zu", block);
+	std::printf("\n");
+
+	run<Attenuverter>("attenuverter", samples);
+	run<PrecisionAdder>("precision-adder", samples);
+	run<SlewLimiter>("slew-limiter", samples);
+	run<AdEnvelope>("ad-envelope", samples);
+	run<CvMixer>("cv-mixer", samples);
+	run<Noise>("noise", samples);
+	return 0;
+}
@@ -0,0 +1,201 @@
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+
+#include "../src/ad-envelope.h"
+#include "../src/attenuverter.h"
+#include "../src/cv-mixer.h"
+#include "../src/noise.h"
+#include "../src/pot-curves.h"
+#include "../src/precision-adder.h"
+#include "../src/slew-limiter.h"
+#include "fake-hal.h"
+
+namespace {
+constexpr uint32_t kTickUs = 125;  // 8 kHz
+constexpr float kDacLsbV = 10.0f / 4095.0f;
+
+// Successive calls share pot generations, like consecutive UI snapshots.
+ControlSnapshot make_controls(uint8_t p0, uint8_t p1, uint8_t p2, bool button_b = false) {
+	static ControlSnapshot c{};
+	const uint8_t pots[ControlSnapshot::kNumPots] = {p0, p1, p2};
+	for (uint8_t i = 0; i < ControlSnapshot::kNumPots; ++i) {
+		c.set_pot(i, pots[i], static_cast<uint16_t>(pots[i] * 16));
+	}
+	c.button_b_pressed = button_b;
+	return c;
+}
+
+bool near(float a, float b, float tolerance) {
+	return std::fabs(a - b) <= tolerance;
+}
+}  // namespace
+
+int main() {
+	fake::Rig rig(kTickUs);
+	fake::CvIn& cv_in = rig.cv_in;
+	fake::CvOut& cv_out = rig.cv_out;
+	fake::Pulse& pulse = rig.pulse;
+
+	// Attenuverter: centered pots mute the input around the 5V center.
+	{
+		Attenuverter mode;
+		cv_in.set_voltage(3.0f, -2.0f);
+		rig.tick(mode, make_controls(128, 128, 128));
+		assert(near(cv_out.voltage_a(), 5.0f, 0.01f));
+		assert(near(cv_out.voltage_b(), 5.0f, 0.01f));
+		rig.tick(mode, make_controls(255, 0, 128));
+		assert(cv_out.voltage_a() > 7.0f);
+		assert(cv_out.voltage_b() > 5.8f);
+	}
+
+	// CV mixer: zero main level outputs the center voltage on both channels.
+	{
+		CvMixer mode;
+		cv_in.set_voltage(2.0f, 2.0f);
+		rig.tick(mode, make_controls(255, 255, 0));
+		assert(near(cv_out.voltage_a(), 5.0f, kDacLsbV));
+		rig.tick(mode, make_controls(255, 0, 255));
+		assert(near(cv_out.voltage_a(), 7.0f, 0.05f));
+		assert(cv_out.voltage_a() == cv_out.voltage_b());
+	}
+
+	// Precision adder: +1 octave pot adds ~1V.
+	{
+		PrecisionAdder mode;
+		cv_in.set_voltage(0.0f, 0.0f);
+		rig.tick(mode, make_controls(128, 128, 128));
+		const float base = cv_out.voltage_a();
+		PrecisionAdder shifted;
+		rig.tick(shifted, make_controls(150, 128, 128));
+		assert(near(cv_out.voltage_a() - base, 1.0f, 0.02f));
+	}
+
+	// Slew limiter: fastest setting follows a step, slow setting lags it.
+	{
+		SlewLimiter fast;
+		SlewLimiter slow;
+		cv_in.set_voltage(3.0f, 3.0f);
+		for (int i = 0; i < 200; ++i) {
+			rig.tick(fast, make_controls(0, 0, 0));
+		}
+		assert(near(cv_out.voltage_a(), 8.0f, 0.05f));
+		for (int i = 0; i < 200; ++i) {
+			rig.tick(slow, make_controls(200, 200, 0));
+		}
+		assert(cv_out.voltage_a() < 7.0f);
+
+		// Cached coefficients follow the pots: turning rise to fastest catches up.
+		for (int i = 0; i < 200; ++i) {
+			rig.tick(slow, make_controls(0, 0, 0));
+		}
+		assert(near(cv_out.voltage_a(), 8.0f, 0.05f));
+	}
+
+	// AD envelope: a pulse trigger runs attack/decay and fires end-of-cycle.
+	{
+		AdEnvelope mode;
+		cv_in.set_voltage(0.0f, 0.0f);
+		const ControlSnapshot controls = make_controls(10, 10, 0);
+		pulse.set_input(true);
+		float peak = 0.0f;
+		uint32_t eoc_rises_before = pulse.output_rises;
+		for (int i = 0; i < 8000; ++i) {
+			rig.tick(mode, controls);
+			if (cv_out.voltage_a() > peak) peak = cv_out.voltage_a();
+		}
+		assert(peak > 9.9f);
+		assert(near(cv_out.voltage_a(), 5.0f, kDacLsbV));
+		assert(pulse.output_rises == eoc_rises_before + 1);
+		pulse.set_input(false);
+	}
+
+	// Noise: steps change the output over time and emit change triggers.
+	{
+		Noise mode;
+		const ControlSnapshot controls = make_controls(0, 0, 255);
+		const uint32_t rises_before = pulse.output_rises;
+		float first = -1.0f;
+		bool changed = false;
+		for (int i = 0; i < 1000; ++i) {
+			rig.tick(mode, controls);
+			if (first < 0.0f) first = cv_out.voltage_a();
+			if (cv_out.voltage_a() != first) changed = true;
+			assert(cv_out.voltage_a() >= 0.0f && cv_out.voltage_a() <= 10.0f);
+		}
+		assert(changed);
+		assert(pulse.output_rises > rises_before);
+		// At full range the extremes of a step land on the DAC's end codes.
+		assert(Noise::scale_step(0, 2048) == 0);
+		assert(Noise::scale_step(4095, 2048) == 4095);
+		assert(Noise::scale_step(4095, 1024) == 3072);
+	}
+
+	// Blocks: one 32-frame block matches 32 one-frame blocks at the same times.
+	{
+		SlewLimiter whole;
+		SlewLimiter framewise;
+		AdEnvelope env_whole;
+		AdEnvelope env_framewise;
+		const ControlSnapshot controls = make_controls(60, 90, 128);
+		constexpr size_t kBlock = 32;
+		Frame in[kBlock];
+		Frame out_whole[kBlock];
+		Frame out_framewise[kBlock];
+		Frame env_out_whole[kBlock];
+		Frame env_out_framewise[kBlock];
+		for (size_t i = 0; i < kBlock; ++i) {
+			const int16_t mv = i < kBlock / 2 ? -3000 : 4000;
+			in[i] = {mv, mv, static_cast<uint8_t>(i == 3 ? Frame::kPulseRise : 0)};
+		}
+		const uint32_t start_us = 1000;
+		whole.process(BlockParams{controls, start_us, kTickUs}, in, out_whole, kBlock);
+		env_whole.process(BlockParams{controls, start_us, kTickUs}, in, env_out_whole,
+						  kBlock);
+		for (size_t i = 0; i < kBlock; ++i) {
+			const BlockParams one{controls, start_us + static_cast<uint32_t>(i) * kTickUs,
+								  kTickUs};
+			framewise.process(one, &in[i], &out_framewise[i], 1);
+			env_framewise.process(one, &in[i], &env_out_framewise[i], 1);
+		}
+		for (size_t i = 0; i < kBlock; ++i) {
+			assert(out_whole[i].a == out_framewise[i].a && out_whole[i].b == out_framewise[i].b);
+			assert(env_out_whole[i].a == env_out_framewise[i].a);
+			assert(env_out_whole[i].pulse == env_out_framewise[i].pulse);
+		}
+	}
+
+	// Virtual time: an hour of noise steps at 1 kHz, across the 32-bit
+	// microsecond wrap, keeps the same step rate on both sides of it.
+	{
+		fake::Rig slow_rig(1000);
+		slow_rig.clock.now = 0xFFFFFFFFu - 30u * 60u * 1000000u;
+		Noise mode;
+		const ControlSnapshot controls = make_controls(64, 0, 255);
+		// Steps land on the first 1 ms frame at or past the interval.
+		const uint32_t step_frames = (pot_curves::noise_interval_us(64) + 999) / 1000;
+		constexpr uint32_t kWindowFrames = 10u * 60u * 1000u;
+		uint32_t steps[6] = {};
+		slow_rig.tick(mode, controls);  // the first step is immediate
+		uint32_t since_change = 0;
+		uint16_t last = slow_rig.cv_out.code_a;
+		for (uint32_t frame = 0; frame < 6 * kWindowFrames; ++frame) {
+			slow_rig.tick(mode, controls);
+			++since_change;
+			if (slow_rig.cv_out.code_a != last) {
+				last = slow_rig.cv_out.code_a;
+				++steps[frame / kWindowFrames];
+				// Rarely a step repeats the value; never is one missed for long.
+				assert(since_change % step_frames == 0 && since_change <= 3 * step_frames);
+				since_change = 0;
+			}
+		}
+		for (uint32_t w = 0; w < 6; ++w) {
+			assert(steps[w] * 1000 > kWindowFrames / step_frames * 995);
+		}
+	}
+
+	std::puts("modes_test: PASS");
+	return 0;
+}
@@ -0,0 +1,90 @@
+#include <cassert>
+#include <cstdint>
+#include <cstdio>
+
+#include "../src/attenuverter.h"
+#include "../src/output-calibration.h"
+#include "fake-hal.h"
+
+int main() {
+	constexpr uint8_t kA = OutputCalibration::kChannelA;
+	constexpr uint8_t kB = OutputCalibration::kChannelB;
+
+	// Calibration points sit on whole volts.
+	assert(OutputCalibration::point_code(0) == 0);
+	assert(OutputCalibration::point_code(5) == 2048);
+	assert(OutputCalibration::point_code(10) == 4095);
+
+	// No corrections: every code passes through.
+	OutputCalibration cal;
+	for (uint32_t code = 0; code < OutputCalibration::kNumCodes; ++code) {
+		assert(cal.apply(kA, static_cast<uint16_t>(code)) == code);
+		assert(cal.apply(kB, static_cast<uint16_t>(code)) == code);
+	}
+
+	// Corrections hit exactly at their points and interpolate linearly between.
+	cal.set_correction(kA, 1, 20);
+	cal.set_correction(kA, 2, -20);
+	cal.rebuild(kA);
+	const uint16_t v1 = OutputCalibration::point_code(1);
+	const uint16_t v2 = OutputCalibration::point_code(2);
+	assert(cal.apply(kA, v1) == v1 + 20);
+	assert(cal.apply(kA, v2) == v2 - 20);
+	const uint16_t mid = static_cast<uint16_t>((v1 + v2) / 2);
+	const int32_t mid_correction = cal.apply(kA, mid) - mid;
+	assert(mid_correction >= -1 && mid_correction <= 1);
+	// Halfway from 0V (no correction) to 1V (+20).
+	const uint16_t quarter = static_cast<uint16_t>(v1 / 2);
+	assert(cal.apply(kA, quarter) - quarter >= 9 && cal.apply(kA, quarter) - quarter <= 11);
+	// Monotonic between points, untouched beyond them, other channel untouched.
+	for (uint16_t code = 1; code <= v2; ++code) {
+		const int32_t step = cal.apply(kA, code) - cal.apply(kA, static_cast<uint16_t>(code - 1));
+		assert(step >= 0 && step <= 2);
+	}
+	assert(cal.apply(kA, 3000) == 3000);
+	assert(cal.apply(kB, v1) == v1);
+
+	// Corrections clamp at the DAC range ends.
+	cal.set_correction(kB, 10, 50);
+	cal.set_correction(kB, 0, -50);
+	cal.rebuild(kB);
+	assert(cal.apply(kB, 4095) == 4095);
+	assert(cal.apply(kB, 0) == 0);
+
+	// Codes past the range clamp to the top code instead of wrapping to 0 V.
+	assert(cal.apply(kB, 4096) == cal.apply(kB, 4095));
+	assert(cal.apply(kB, 0xFFFF) == cal.apply(kB, 4095));
+	assert(cal.apply_q8(kB, 4096, 128) == static_cast<uint32_t>(cal.apply(kB, 4095)) << 8);
+
+	// The rig's output stage applies the table to every mode.
+	{
+		fake::Rig rig;
+		rig.output_cal.set_correction(kA, 5, 12);
+		rig.output_cal.rebuild(kA);
+		Attenuverter mode;
+		ControlSnapshot controls{};
+		controls.set_pot(0, 128, 2048);
+		controls.set_pot(1, 128, 2048);
+		controls.set_pot(2, 128, 2048);
+		rig.cv_in.set_voltage(0.0f, 0.0f);
+		rig.tick(mode, controls);
+		assert(rig.cv_out.code_a == 2048 + 12);
+		assert(rig.cv_out.code_b == 2048);
+	}
+
+	// Staged codes reach the outputs together, only on latch.
+	{
+		fake::CvOut out;
+		assert(!out.latch());
+		out.stage(hal::CvOutChannel::kChannelA, 100);
+		assert(out.code_a == 0 && out.writes == 0);
+		out.stage(hal::CvOutChannel::kChannelB, 200);
+		assert(out.latch());
+		assert(out.code_a == 100 && out.code_b == 200 && out.writes == 1);
+		assert(!out.latch());
+		assert(out.writes == 1);
+	}
+
+	std::puts("output_calibration_test: PASS");
+	return 0;
+}
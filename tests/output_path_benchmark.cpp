@@ -0,0 +1,50 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+#include "../src/cv-units.h"
+
+// Compares the old float output path (mode computes volts, driver converts
+// back to a DAC code) with writing integer DAC codes directly.
+// The host has an FPU, so this understates the gap on the RP2040's soft float.
+// Usage: output_path_benchmark [samples]
+namespace {
+volatile uint16_t g_dac_sink;
+
+// What the driver did with a float voltage before it reached the DAC.
+void driver_set_voltage(float voltage) {
+	if (voltage < 0.0f) voltage = 0.0f;
+	if (voltage > 10.0f) voltage = 10.0f;
+	g_dac_sink = static_cast<uint16_t>(voltage * 4095.0f / 10.0f + 0.5f);
+}
+
+void driver_write_code(uint16_t code) {
+	g_dac_sink = code;
+}
+
+template <typename Fn>
+void run(const char* name, uint32_t samples, Fn&& output) {
+	const auto start = std::chrono::steady_clock::now();
+	for (uint32_t i = 0; i < samples; ++i) {
+		// Millivolt ramp over the full output range, as a mode would produce.
+		output(static_cast<int32_t>(i % 10001));
+	}
+	const auto end = std::chrono::steady_clock::now();
+	const double ns = std::chrono::duration<double, std::nano>(end - start).count();
+	std::printf("%-16s %8.2f ns/sample\n", name, ns / samples);
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+	uint32_t samples = 20000000;
+	if (argc > 1) samples = static_cast<uint32_t>(std::strtoul(argv[1], nullptr, 10));
+
+	run("float volts", samples, [](int32_t mv) {
+		driver_set_voltage(static_cast<float>(mv) / 1000.0f);
+	});
+	run("integer code", samples, [](int32_t mv) {
+		driver_write_code(cv_units::mv_to_dac(mv));
+	});
+	return 0;
+}
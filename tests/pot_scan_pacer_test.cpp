@@ -0,0 +1,96 @@
+#include <cassert>
+#include <cstdint>
+#include <cstdio>
+
+#include "../src/pot-scan-pacer.h"
+
+namespace {
+constexpr uint64_t kPairRateHz = 128000;  // CvUtils::kCvInCaptureRateHz
+constexpr uint32_t kRunUs = 10000000;
+
+// UI loop timing: each pass does the button poll, console, LEDs, session and
+// trace drain (pass_us), plus the pot scan when one is due (scan_us). Ranges
+// cover the stages' profiled spread; every `slow_every` passes one stalls
+// for slow_pass_us (a console dump or a trace burst).
+struct LoopTiming {
+	uint32_t pass_min_us;
+	uint32_t pass_max_us;
+	uint32_t scan_min_us;
+	uint32_t scan_max_us;
+	uint32_t slow_every;
+	uint32_t slow_pass_us;
+};
+
+struct Result {
+	uint64_t converted;
+	uint64_t missed;
+	uint32_t longest_scan_gap_us;
+};
+
+uint32_t rng = 7;
+uint32_t between(uint32_t lo, uint32_t hi) {
+	rng = rng * 1664525u + 1013904223u;
+	return lo + (rng >> 8) % (hi - lo + 1);
+}
+
+// Pairs due in [from, to) on the capture's grid, from the run's start.
+uint64_t pairs_in(uint64_t from_us, uint64_t to_us) {
+	return to_us * kPairRateHz / 1000000 - from_us * kPairRateHz / 1000000;
+}
+
+// Runs the UI loop for kRunUs on a clock that wraps mid-run. With `paced`
+// false every pass scans, as the loop used to.
+Result run(const LoopTiming& timing, bool paced) {
+	PotScanPacer pacer;
+	const uint32_t clock_base = 0xFFFFFFFFu - kRunUs / 2;
+	uint64_t t = 0;
+	uint64_t missed = 0;
+	uint64_t last_scan = 0;
+	uint32_t longest_gap = 0;
+	for (uint32_t pass = 1; t < kRunUs; ++pass) {
+		const uint32_t now = clock_base + static_cast<uint32_t>(t);
+		if (!paced || pacer.due(now)) {
+			const uint32_t scan = between(timing.scan_min_us, timing.scan_max_us);
+			missed += pairs_in(t, t + scan);
+			if (last_scan != 0 && t - last_scan > longest_gap) {
+				longest_gap = static_cast<uint32_t>(t - last_scan);
+			}
+			last_scan = t;
+			pacer.scanned(now, now + scan);
+			t += scan;
+		}
+		t += pass % timing.slow_every == 0 ? timing.slow_pass_us
+										   : between(timing.pass_min_us, timing.pass_max_us);
+	}
+	return {pairs_in(0, t) - missed, missed, longest_gap};
+}
+}  // namespace
+
+int main() {
+	const LoopTiming kTypical{20, 120, 150, 400, 500, 3000};
+	const LoopTiming kSlowScans{20, 120, 1000, 3000, 500, 3000};
+	const LoopTiming kSlowLoop{300, 1500, 150, 400, 50, 8000};
+	const LoopTiming timings[] = {kTypical, kSlowScans, kSlowLoop};
+
+	for (const LoopTiming& timing : timings) {
+		const Result r = run(timing, true);
+		// At most kMaxPausedPercent of the pairs fall in pauses: 19 converted
+		// for every one missed.
+		assert(r.converted >= r.missed * (100 / PotScanPacer::kMaxPausedPercent - 1));
+		// Pots are still scanned promptly: one interval, stretched only by a
+		// pass that was already running or by the duty-cycle cap.
+		const uint32_t cap_us = timing.scan_max_us * (100 / PotScanPacer::kMaxPausedPercent);
+		const uint32_t spacing_us = cap_us > PotScanPacer::kIntervalUs ? cap_us
+																	   : PotScanPacer::kIntervalUs;
+		assert(r.longest_scan_gap_us <= spacing_us + timing.slow_pass_us);
+	}
+
+	// Scanning on every pass, as before, left capture paused most of the time.
+	{
+		const Result r = run(kTypical, false);
+		assert(r.missed > r.converted);
+	}
+
+	std::puts("pot_scan_pacer_test: PASS");
+	return 0;
+}
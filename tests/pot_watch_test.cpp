@@ -0,0 +1,47 @@
+#include <cassert>
+#include <cstdio>
+
+#include "../src/control-snapshot.h"
+#include "../src/pot-curves.h"
+
+namespace {
+constexpr uint32_t square(uint8_t pot_value) {
+	return static_cast<uint32_t>(pot_value) * pot_value;
+}
+
+constexpr auto kSquares = pot_curves::make_table<uint32_t>(square);
+static_assert(kSquares[0] == 0, "table built at compile time");
+static_assert(kSquares[255] == 255u * 255u, "table built at compile time");
+}  // namespace
+
+int main() {
+	ControlSnapshot controls{};
+	PotWatch watch;
+
+	// Everything counts as changed the first time.
+	assert(watch.changed(controls, 0));
+	assert(watch.changed(controls, 1));
+	assert(!watch.changed(controls, 0));
+
+	// Only a new 8-bit value bumps the generation; raw jitter does not.
+	controls.set_pot(0, 10, 160);
+	controls.set_pot(0, 10, 161);
+	assert(controls.pot_generation[0] == 1);
+	assert(controls.pots_raw[0] == 161);
+	assert(watch.changed(controls, 0));
+	assert(!watch.changed(controls, 0));
+	assert(!watch.changed(controls, 1));
+
+	// Several moves between checks are reported once.
+	controls.set_pot(1, 20, 320);
+	controls.set_pot(1, 21, 336);
+	assert(watch.changed(controls, 1));
+	assert(!watch.changed(controls, 1));
+
+	for (uint32_t i = 0; i < pot_curves::kNumPotValues; ++i) {
+		assert(kSquares[static_cast<uint8_t>(i)] == i * i);
+	}
+
+	std::puts("pot_watch_test: PASS");
+	return 0;
+}
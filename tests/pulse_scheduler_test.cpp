@@ -0,0 +1,124 @@
+#include <cassert>
+#include <cstdint>
+#include <cstdio>
+
+#include "../src/pulse-scheduler.h"
+
+namespace {
+constexpr uint32_t kGapUs = 500;
+
+PulseScheduler restart() {
+	return PulseScheduler(kGapUs, PulseScheduler::Retrigger::kRestart);
+}
+
+// Steps `s` through [from_us, to_us) one microsecond at a time, the way the
+// alarm would, and returns how many rising edges the output made.
+uint32_t run(PulseScheduler& s, uint32_t from_us, uint32_t to_us, uint32_t& high_us) {
+	uint32_t rises = 0;
+	bool level = s.high();
+	high_us = 0;
+	for (uint32_t t = from_us; t != to_us; ++t) {
+		const bool now_high = s.update(t);
+		if (now_high && !level) ++rises;
+		if (now_high) ++high_us;
+		level = now_high;
+	}
+	return rises;
+}
+}  // namespace
+
+int main() {
+	// Exact width, from when the output really went high.
+	{
+		PulseScheduler s = restart();
+		s.request(1000, 5000);
+		uint32_t at = 0;
+		assert(s.next_transition(at) && at == 1000);
+		assert(!s.update(999));
+		assert(s.update(1003));
+		assert(s.next_transition(at) && at == 6003);
+		assert(s.update(6002));
+		assert(!s.update(6003));
+		assert(!s.next_transition(at));
+	}
+
+	// Minimum gap: a pulse due right after one ends waits out the gap.
+	{
+		PulseScheduler s = restart();
+		s.request(0, 1000);
+		s.update(0);
+		s.update(1000);
+		s.request(1100, 1000);
+		uint32_t at = 0;
+		assert(s.next_transition(at) && at == 1000 + kGapUs);
+		assert(!s.update(1499));
+		assert(s.update(1500));
+	}
+
+	// Restart: a trigger during a pulse ends it and starts a full new one
+	// after the gap.
+	{
+		PulseScheduler s = restart();
+		s.request(10000, 10000);
+		s.update(10000);
+		s.request(12000, 3000);
+		assert(s.update(11999));
+		assert(!s.update(12000));
+		assert(!s.update(12499));
+		assert(s.update(12500));
+		assert(s.update(15499));
+		assert(!s.update(15500));
+	}
+
+	// Extend: the pulse stays high until the later end, with no extra edge.
+	{
+		PulseScheduler s(kGapUs, PulseScheduler::Retrigger::kExtend);
+		s.request(0, 1000);
+		s.request(0, 100);
+		uint32_t high_us = 0;
+		assert(run(s, 0, 500, high_us) == 1);
+		s.request(500, 2000);
+		s.request(600, 100);
+		assert(run(s, 500, 5000, high_us) == 0);
+		assert(high_us == 2000);
+	}
+
+	// Requests before the pulse starts merge: earliest start, longest width.
+	{
+		PulseScheduler s = restart();
+		s.request(100, 1000);
+		s.request(50, 3000);
+		uint32_t high_us = 0;
+		assert(run(s, 0, 10000, high_us) == 1);
+		assert(high_us == 3000);
+	}
+
+	// Triggers faster than the width: every one still gives its own edge,
+	// each pulse high until the next trigger less the gap.
+	{
+		PulseScheduler s = restart();
+		uint32_t rises = 0;
+		uint32_t high_us = 0;
+		for (uint32_t k = 0; k < 20; ++k) {
+			s.request(k * 2000, 10000);
+			uint32_t segment_high = 0;
+			rises += run(s, k * 2000, (k + 1) * 2000, segment_high);
+			high_us += segment_high;
+		}
+		assert(rises == 20);
+		assert(high_us == 2000 + 19 * (2000 - kGapUs));
+	}
+
+	// The microsecond counter wrapping mid-pulse changes nothing.
+	{
+		PulseScheduler s = restart();
+		const uint32_t start = 0xFFFFFFFFu - 1000;
+		s.request(start, 5000);
+		uint32_t high_us = 0;
+		assert(run(s, start, start + 20000, high_us) == 1);
+		assert(high_us == 5000);
+	}
+
+	std::puts("pulse_scheduler_test: PASS");
+	return 0;
+}
@@ -0,0 +1,71 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+#include "../src/quantizer.h"
+
+// Compares table quantizing against the per-call semitone division and
+// note-array scan that Noise used before (kept here as the baseline).
+// Usage: quantizer_benchmark [lookups]
+namespace {
+constexpr uint32_t kSemitoneDac256 = 8736;
+constexpr uint16_t kDacMax = 4095;
+const uint8_t kMajorNotes[] = {0, 2, 4, 5, 7, 9, 11};
+
+uint16_t legacy_quantize(uint16_t dac_value) {
+	const uint32_t dac256 = static_cast<uint32_t>(dac_value) * 256;
+	const uint32_t total_semitones = (dac256 + kSemitoneDac256 / 2) / kSemitoneDac256;
+	const uint32_t octave = total_semitones / 12;
+	const uint32_t semitone_in_octave = total_semitones % 12;
+	uint8_t best_note = 0;
+	uint32_t best_dist = 12;
+	for (uint8_t note : kMajorNotes) {
+		uint32_t dist = semitone_in_octave >= note ? semitone_in_octave - note
+												   : note - semitone_in_octave;
+		const uint32_t wrap_dist = 12 - dist;
+		if (wrap_dist < dist) dist = wrap_dist;
+		if (dist < best_dist) {
+			best_dist = dist;
+			best_note = note;
+		}
+	}
+	const uint32_t result = ((octave * 12 + best_note) * kSemitoneDac256) / 256;
+	return static_cast<uint16_t>(result > kDacMax ? kDacMax : result);
+}
+
+template <typename Quantize>
+double ns_per_lookup(uint32_t lookups, Quantize quantize) {
+	uint32_t rng = 123456789;
+	uint32_t checksum = 0;
+	const auto start = std::chrono::steady_clock::now();
+	for (uint32_t i = 0; i < lookups; ++i) {
+		rng ^= rng << 13;
+		rng ^= rng >> 17;
+		rng ^= rng << 5;
+		checksum += quantize(static_cast<uint16_t>(rng & kDacMax));
+	}
+	const auto end = std::chrono::steady_clock::now();
+	// Keep the work observable so the optimizer cannot drop it.
+	if (checksum == 0xFFFFFFFFu) std::puts("");
+	return std::chrono::duration<double, std::nano>(end - start).count() / lookups;
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+	uint32_t lookups = 20000000;
+	if (argc > 1) lookups = static_cast<uint32_t>(std::strtoul(argv[1], nullptr, 10));
+	if (lookups == 0) lookups = 1;
+
+	quantizer::Quantizer held;
+	held.set_table(&quantizer::kMajorTable);
+	held.set_hysteresis(4);
+
+	std::printf("ns/lookup, major scale, random codes\n");
+	std::printf("%-20s %8.2f\n", "legacy scan", ns_per_lookup(lookups, legacy_quantize));
+	std::printf("%-20s %8.2f\n", "table",
+				ns_per_lookup(lookups, [](uint16_t c) { return quantizer::kMajorTable[c]; }));
+	std::printf("%-20s %8.2f\n", "table + hysteresis",
+				ns_per_lookup(lookups, [&held](uint16_t c) { return held.process(c); }));
+	return 0;
+}
@@ -0,0 +1,122 @@
+#include <cassert>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+#include "../src/quantizer.h"
+
+namespace {
+// Compile-time tables: C# ties down to C, B rounds up to the next C.
+constexpr quantizer::Table kRootOnly = quantizer::make_table(0x0001);
+static_assert(quantizer::kMajorTable[quantizer::semitone_to_code(13)] ==
+				  quantizer::semitone_to_code(12),
+			  "tie goes to the lower note");
+static_assert(kRootOnly[quantizer::semitone_to_code(23)] == quantizer::semitone_to_code(24),
+			  "nearest note can be in the next octave");
+
+bool in_scale(uint16_t mask, uint16_t code) {
+	for (uint32_t s = 0; s <= quantizer::kNumSemitones; ++s) {
+		if (quantizer::semitone_to_code(s) == code) return (mask >> (s % 12)) & 1u;
+	}
+	return false;
+}
+
+uint32_t semitone_of(uint16_t code) {
+	return (code * 256u + quantizer::kSemitoneDac256 / 2) / quantizer::kSemitoneDac256;
+}
+}  // namespace
+
+int main() {
+	const uint16_t kMasks[] = {quantizer::kChromatic, quantizer::kMajor, quantizer::kMinor,
+							   quantizer::kPentatonic, quantizer::kWholeTone, 0x0081, 0x0001,
+							   // Without C the top codes sit above the highest scale note.
+							   0x0AB4, 0x0800};
+	static quantizer::Table table;
+	for (uint16_t mask : kMasks) {
+		quantizer::build_table(mask, table);
+		for (uint32_t code = 0; code < quantizer::kNumCodes; ++code) {
+			const uint16_t q = table[static_cast<uint16_t>(code)];
+			// Every output is a scale note, and no scale note is nearer to the
+			// input's semitone.
+			assert(in_scale(mask, q));
+			const int32_t semitone = static_cast<int32_t>(semitone_of(static_cast<uint16_t>(code)));
+			const int32_t distance = std::abs(static_cast<int32_t>(semitone_of(q)) - semitone);
+			for (int32_t d = 0; d < distance; ++d) {
+				const int32_t candidates[] = {semitone - d, semitone + d};
+				for (int32_t candidate : candidates) {
+					if (candidate < 0 || candidate > static_cast<int32_t>(quantizer::kNumSemitones)) {
+						continue;
+					}
+					assert(!((mask >> (candidate % 12)) & 1u));
+				}
+			}
+		}
+	}
+
+	// Top codes of a scale without C hold its highest note, B below the top C.
+	quantizer::build_table(0x0800, table);
+	assert(table[quantizer::kDacMax] == quantizer::semitone_to_code(quantizer::kNumSemitones - 1));
+
+	// Codes past the DAC range quantize as the top code rather than wrapping.
+	assert(quantizer::kMajorTable[quantizer::kNumCodes] ==
+		   quantizer::kMajorTable[quantizer::kDacMax]);
+
+	// Runtime tables for built-in masks match the compile-time ones.
+	quantizer::build_table(quantizer::kMajor, table);
+	for (uint32_t code = 0; code < quantizer::kNumCodes; ++code) {
+		assert(table.codes[code] == quantizer::kMajorTable.codes[code]);
+	}
+
+	// Empty mask and no table both pass codes through.
+	quantizer::build_table(0, table);
+	for (uint32_t code = 0; code < quantizer::kNumCodes; ++code) assert(table.codes[code] == code);
+	quantizer::Quantizer passthrough;
+	assert(passthrough.process(1234) == 1234);
+
+	// Hysteresis: an input wobbling across a note boundary holds its note.
+	{
+		quantizer::Quantizer plain;
+		quantizer::Quantizer held;
+		plain.set_table(&quantizer::kChromaticTable);
+		held.set_table(&quantizer::kChromaticTable);
+		held.set_hysteresis(4);
+		// Boundary between semitones 24 and 25.
+		uint16_t boundary = quantizer::semitone_to_code(24);
+		while (quantizer::kChromaticTable[boundary] == quantizer::semitone_to_code(24)) ++boundary;
+		uint32_t plain_changes = 0;
+		uint32_t held_changes = 0;
+		uint16_t plain_prev = plain.process(boundary - 3);
+		uint16_t held_prev = held.process(boundary - 3);
+		for (int i = 0; i < 100; ++i) {
+			const uint16_t code = static_cast<uint16_t>(boundary + (i % 2 == 0 ? 1 : -2));
+			const uint16_t p = plain.process(code);
+			const uint16_t h = held.process(code);
+			plain_changes += p != plain_prev;
+			held_changes += h != held_prev;
+			plain_prev = p;
+			held_prev = h;
+		}
+		assert(plain_changes == 100);
+		assert(held_changes == 0);
+		// Moving well past the boundary still switches.
+		assert(held.process(boundary + 4) == quantizer::semitone_to_code(25));
+		// Big jumps are not held back.
+		assert(held.process(quantizer::semitone_to_code(60)) == quantizer::semitone_to_code(60));
+	}
+
+	// Notes keep their exact pitch in 1/256 codes; unquantized codes are whole.
+	{
+		for (uint32_t s = 0; s <= quantizer::kNumSemitones; ++s) {
+			const uint16_t code = quantizer::semitone_to_code(s);
+			assert(quantizer::note_code_q8(code) == s * quantizer::kSemitoneDac256);
+			assert(quantizer::note_code_q8(code) >> 8 == code);
+		}
+		quantizer::Quantizer q;
+		assert(q.process_q8(1234) == 1234u * 256);
+		q.set_table(&quantizer::kChromaticTable);
+		assert(q.process_q8(quantizer::semitone_to_code(7)) == 7 * quantizer::kSemitoneDac256);
+	}
+
+	std::puts("quantizer_test: PASS");
+	return 0;
+}
@@ -0,0 +1,80 @@
+#include <cassert>
+#include <cstdint>
+#include <cstdio>
+
+#include "../src/noise.h"
+#include "../src/session.h"
+#include "../src/slew-limiter.h"
+#include "fake-hal.h"
+
+int main() {
+	constexpr uint32_t kSettle = Session::kSettleUs;
+
+	// Nothing saved yet: load fails and leaves the defaults alone.
+	fake::Flash flash(4);
+	{
+		FlashStore store(flash);
+		store.init();
+		Session session(store);
+		SessionState state{5, 1, 2, 0};
+		assert(!session.load(state));
+		assert(state.mode == 5);
+
+		// A burst of changes is coalesced into one record, written only once
+		// the state has settled.
+		uint32_t now = 1000;
+		const uint32_t programs_before = flash.programs;
+		for (uint8_t mode = 0; mode < 6; ++mode) {
+			session.update(SessionState{mode, 0, 0, 0}, now);
+			now += 100000;
+		}
+		session.update(SessionState{2, 1, 0, 0}, now);
+		assert(session.save_pending());
+		session.update(SessionState{2, 1, 0, 0}, now + kSettle - 1);
+		assert(session.save_pending() && flash.programs == programs_before);
+		session.update(SessionState{2, 1, 0, 0}, now + kSettle);
+		assert(!session.save_pending() && flash.programs == programs_before + 1);
+
+		// Unchanged state never writes again.
+		for (uint32_t i = 0; i < 10; ++i) session.update(SessionState{2, 1, 0, 0}, now + i * kSettle);
+		assert(flash.programs == programs_before + 1);
+
+		// Changing back before it settles cancels the pending save.
+		session.update(SessionState{3, 1, 0, 0}, now + 20 * kSettle);
+		session.update(SessionState{2, 1, 0, 0}, now + 20 * kSettle + 10);
+		assert(!session.save_pending());
+		session.update(SessionState{2, 1, 0, 0}, now + 30 * kSettle);
+		assert(flash.programs == programs_before + 1);
+	}
+
+	// After a power cycle the state comes back and counts as saved.
+	{
+		FlashStore store(flash);
+		store.init();
+		Session session(store);
+		SessionState state{};
+		assert(session.load(state));
+		assert(state.mode == 2 && state.slew_linked == 1 && state.noise_scale == 0);
+		const uint32_t programs_before = flash.programs;
+		session.update(state, 10 * kSettle);
+		assert(!session.save_pending() && flash.programs == programs_before);
+	}
+
+	// The persisted mode options round-trip through the modes.
+	{
+		SlewLimiter slew;
+		assert(!slew.linked());
+		slew.set_linked(true);
+		assert(slew.linked());
+
+		Noise noise;
+		assert(noise.scale() == 0);
+		noise.set_scale(3);
+		assert(noise.scale() == 3);
+		noise.set_scale(200);
+		assert(noise.scale() == 5);
+	}
+
+	std::puts("session_test: PASS");
+	return 0;
+}
@@ -0,0 +1,108 @@
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+
+#include "../src/output-calibration.h"
+#include "../src/precision-adder.h"
+#include "../src/sigma-delta.h"
+
+namespace {
+// Runs `frames` frames of a steady target; returns the mean code sent and
+// checks every code is one of the two either side of the target.
+double mean_code(SigmaDelta& sd, uint32_t target_q8, uint32_t frames) {
+	uint64_t sum = 0;
+	for (uint32_t i = 0; i < frames; ++i) {
+		const uint16_t code = sd.process(target_q8);
+		assert(code == target_q8 >> 8 || code == (target_q8 >> 8) + 1);
+		sum += code;
+	}
+	return static_cast<double>(sum) / frames;
+}
+}  // namespace
+
+int main() {
+	// Whole codes go out unchanged, whatever fraction is still carried.
+	{
+		SigmaDelta sd;
+		sd.process(100 * 256 + 200);
+		for (uint32_t i = 0; i < 10; ++i) assert(sd.process(2000 * 256) == 2000);
+	}
+
+	// Every fraction of a code averages out to within 1/256 code over 256
+	// frames; the DAC alone would be off by up to half a code.
+	const uint16_t codes[] = {0, 1, 2047, 3000, 4094};
+	for (uint16_t code : codes) {
+		for (uint32_t frac = 0; frac < 256; ++frac) {
+			SigmaDelta sd;
+			const uint32_t target_q8 = code * 256u + frac;
+			const double mean = mean_code(sd, target_q8, 256);
+			assert(std::fabs(mean - target_q8 / 256.0) <= 1.0 / 256.0);
+		}
+	}
+	{
+		SigmaDelta sd;
+		assert(mean_code(sd, 4095 * 256, 64) == 4095.0);
+	}
+
+	// Through the output calibration: a fraction of a code lands between the
+	// two corrected codes either side of it.
+	{
+		OutputCalibration cal;
+		cal.set_correction(OutputCalibration::kChannelA, 5, 12);
+		cal.rebuild(OutputCalibration::kChannelA);
+		for (uint16_t code = 1500; code < 2600; code += 7) {
+			const double lo = cal.apply(OutputCalibration::kChannelA, code);
+			const double hi = cal.apply(OutputCalibration::kChannelA, static_cast<uint16_t>(code + 1));
+			for (uint32_t frac = 0; frac < 256; frac += 17) {
+				SigmaDelta sd;
+				const uint32_t target_q8 = cal.apply_q8(OutputCalibration::kChannelA, code,
+														 static_cast<uint8_t>(frac));
+				const double mean = mean_code(sd, target_q8, 1024);
+				assert(std::fabs(mean - (lo + (hi - lo) * frac / 256.0)) < 1.0 / 64.0);
+			}
+		}
+		assert(cal.apply_q8(OutputCalibration::kChannelA, 4095, 200) ==
+			   cal.apply(OutputCalibration::kChannelA, 4095) * 256u);
+	}
+
+	// Precision adder at every fine tune setting, 0V in: the averaged output
+	// is within a fiftieth of a code of the exact pitch. Whole codes alone
+	// miss it by up to half a code (a sixtieth of a semitone).
+	{
+		double worst_dithered = 0.0;
+		double worst_whole = 0.0;
+		for (uint32_t pot = 0; pot < 256; ++pot) {
+			PrecisionAdder mode;
+			BlockParams params{};
+			params.period_us = 125;
+			params.controls.set_pot(0, 128, 2048);
+			params.controls.set_pot(1, 128, 2048);
+			params.controls.set_pot(2, static_cast<uint8_t>(pot), static_cast<uint16_t>(pot * 16));
+			const double semitones = pot > 128 ? (pot - 128) * 5.0 / 127.0
+								   : -((128.0 - pot) * 5.0 / 128.0);
+			const double exact = (5000.0 + semitones * 1000.0 / 12.0) * 4095.0 / 10000.0;
+
+			SigmaDelta sd;
+			uint64_t sum = 0;
+			constexpr uint32_t kFrames = 1024;
+			for (uint32_t i = 0; i < kFrames; ++i) {
+				Frame in{};
+				in.a = 0;
+				in.b = 0;
+				Frame out;
+				mode.process(params, &in, &out, 1);
+				sum += sd.process(out.a * 256u + out.code_frac[0]);
+				const double whole = std::fabs(std::lround(out.a + out.code_frac[0] / 256.0) - exact);
+				if (whole > worst_whole) worst_whole = whole;
+			}
+			const double error = std::fabs(static_cast<double>(sum) / kFrames - exact);
+			if (error > worst_dithered) worst_dithered = error;
+		}
+		assert(worst_dithered < 0.02);
+		assert(worst_whole > 0.45);
+	}
+
+	std::puts("sigma_delta_test: PASS");
+	return 0;
+}
@@ -1,7 +1,9 @@
 #include <cassert>
+#include <cmath>
 #include <cstdint>
 #include <cstdio>
 
+#include "../src/exp-table.h"
 #include "../src/fixed-point.h"
 
 namespace {
@@ -22,70 +24,109 @@ uint16_t pot_to_slew_rate_q15(uint8_t pot_value) {
 		scaled > fixed_point::kQ15One ? fixed_point::kQ15One : scaled);
 }
 
-uint16_t compute_coeff_q15(uint32_t dt_us, uint16_t rate_q15) {
-	if (rate_q15 == 0) return fixed_point::kQ15One;
-	const uint64_t denominator =
+struct StepCoeffs {
+	uint32_t exp_q30;
+	int32_t linear_q16;
+};
+
+constexpr int32_t kFullScaleQ16 = kMaxMillivolts << 16;
+
+StepCoeffs compute_step_coeffs(uint32_t dt_us, uint16_t rate_q15) {
+	if (rate_q15 == 0) return {exp_table::kQ30One, kFullScaleQ16};
+	const uint64_t slew_time_us =
 		(static_cast<uint64_t>(rate_q15) * kMaxSlewUs) / fixed_point::kQ15One;
-	if (denominator <= kMinSlewDenominatorUs) return fixed_point::kQ15One;
-	const uint64_t numerator = static_cast<uint64_t>(dt_us) * fixed_point::kQ15One;
-	const uint64_t scaled = (numerator + (denominator / 2)) / denominator;
-	return static_cast<uint16_t>(
-		scaled >= fixed_point::kQ15One ? fixed_point::kQ15One : scaled);
+	if (slew_time_us <= kMinSlewDenominatorUs) return {exp_table::kQ30One, kFullScaleQ16};
+	const uint64_t x_q32 = (static_cast<uint64_t>(dt_us) << 32) / slew_time_us;
+	const uint64_t linear_q16 =
+		(static_cast<uint64_t>(kFullScaleQ16) * dt_us + slew_time_us / 2) / slew_time_us;
+	return {exp_table::one_minus_exp_neg_q30(x_q32),
+			linear_q16 > static_cast<uint64_t>(kFullScaleQ16) ? kFullScaleQ16
+															  : static_cast<int32_t>(linear_q16)};
 }
 
-int32_t slew_channel_mv(int32_t input_mv, int32_t current_mv, uint16_t rise_coeff_q15,
-						uint16_t fall_coeff_q15, uint16_t shape_q15) {
-	const int32_t diff_mv = input_mv - current_mv;
-	if (diff_mv == 0) return current_mv;
+int32_t slew_channel_q16(int32_t input_q16, int32_t current_q16, const StepCoeffs& rise,
+						 const StepCoeffs& fall, uint16_t shape_q15) {
+	const int32_t diff_q16 = input_q16 - current_q16;
+	if (diff_q16 == 0) return current_q16;
 
-	const uint16_t coeff_q15 = diff_mv > 0 ? rise_coeff_q15 : fall_coeff_q15;
-	const int32_t exp_step_mv = fixed_point::mul_q15(diff_mv, coeff_q15);
+	const StepCoeffs& coeffs = diff_q16 > 0 ? rise : fall;
+	const int32_t exp_step_q16 =
+		static_cast<int32_t>((static_cast<int64_t>(diff_q16) * coeffs.exp_q30) >> 30);
 
-	int32_t linear_move_mv = fixed_point::mul_q15(kMaxMillivolts, coeff_q15);
-	if (diff_mv < 0) linear_move_mv = -linear_move_mv;
-	if ((diff_mv > 0 && linear_move_mv > diff_mv) || (diff_mv < 0 && linear_move_mv < diff_mv)) {
-		linear_move_mv = diff_mv;
+	int32_t linear_move_q16 = diff_q16 > 0 ? coeffs.linear_q16 : -coeffs.linear_q16;
+	if ((diff_q16 > 0 && linear_move_q16 > diff_q16) ||
+		(diff_q16 < 0 && linear_move_q16 < diff_q16)) {
+		linear_move_q16 = diff_q16;
 	}
 
-	const int32_t step_mv = fixed_point::blend_q15(linear_move_mv, exp_step_mv, shape_q15);
-	if (step_mv == 0) {
-		return current_mv + (diff_mv > 0 ? 1 : -1);
+	const int32_t step_q16 = fixed_point::blend_q15(linear_move_q16, exp_step_q16, shape_q15);
+	if (step_q16 == 0) {
+		return current_q16 + (diff_q16 > 0 ? 1 : -1);
 	}
-	return current_mv + step_mv;
+	return current_q16 + step_q16;
 }
 }  // namespace
 
 int main() {
+	// exp(-x) table: every Q16 input up to the table end stays within two Q15
+	// steps of the real curve (interpolation plus rounding).
+	for (uint32_t x_q16 = 0; x_q16 < (exp_table::kXMax << 16); ++x_q16) {
+		const double ideal = std::exp(-(x_q16 / 65536.0)) * fixed_point::kQ15One;
+		assert(std::fabs(exp_table::exp_neg_q15(x_q16) - ideal) <= 2.0);
+	}
+	assert(exp_table::exp_neg_q15(0) == fixed_point::kQ15One);
+	assert(exp_table::exp_neg_q15(exp_table::kXMax << 16) == 0);
+
+	// 1 - exp(-x) keeps its relative precision for the tiny per-frame
+	// fractions of long slews at high loop rates (20 us / 2 s = 1e-5).
+	for (double x = 1e-6; x < 8.0; x *= 1.01) {
+		const uint64_t x_q32 = static_cast<uint64_t>(x * 4294967296.0);
+		const double ideal = -std::expm1(-(x_q32 / 4294967296.0));
+		const double got = exp_table::one_minus_exp_neg_q30(x_q32) / 1073741824.0;
+		assert(std::fabs(got - ideal) <= 1e-3 * ideal + 4e-5);
+	}
+	assert(exp_table::one_minus_exp_neg_q30(0) == 0);
+
 	// Pot mapping and coeffs should stay bounded.
 	assert(pot_to_slew_rate_q15(0) == 0);
 	assert(pot_to_slew_rate_q15(255) == fixed_point::kQ15One);
-	assert(compute_coeff_q15(1000, 0) == fixed_point::kQ15One);
-	assert(compute_coeff_q15(100000, fixed_point::kQ15One) <= fixed_point::kQ15One);
+	assert(compute_step_coeffs(1000, 0).exp_q30 == exp_table::kQ30One);
+	assert(compute_step_coeffs(100000, fixed_point::kQ15One).exp_q30 <= exp_table::kQ30One);
+	assert(compute_step_coeffs(20, fixed_point::kQ15One).exp_q30 > 0);
+	assert(compute_step_coeffs(20, fixed_point::kQ15One).linear_q16 > 0);
+	// Long frames are not clamped: twenty seconds covers the full distance.
+	assert(compute_step_coeffs(20000000, fixed_point::kQ15One).exp_q30 == exp_table::kQ30One);
+
+	const StepCoeffs medium = compute_step_coeffs(125, 3000);
+	const StepCoeffs half = {exp_table::kQ30One / 2, kFullScaleQ16 / 2};
 
 	// Linear branch never overshoots target.
-	const int32_t linear_step = slew_channel_mv(5000, 1000, 3000, 3000, 0) - 1000;
+	const int32_t linear_step = slew_channel_q16(5000 << 16, 1000 << 16, medium, medium, 0) -
+								(1000 << 16);
 	assert(linear_step > 0);
-	assert(linear_step <= (5000 - 1000));
+	assert(linear_step <= ((5000 - 1000) << 16));
+	assert(slew_channel_q16(5000 << 16, 1000 << 16, half, half, 0) == 5000 << 16);
 
 	// Exponential branch moves proportionally and with correct sign.
 	const int32_t exp_up =
-		slew_channel_mv(8000, 2000, 16384, 16384, fixed_point::kQ15One) - 2000;
+		slew_channel_q16(8000 << 16, 2000 << 16, half, half, fixed_point::kQ15One) - (2000 << 16);
 	const int32_t exp_down =
-		slew_channel_mv(1000, 7000, 16384, 16384, fixed_point::kQ15One) - 7000;
-	assert(exp_up > 0);
-	assert(exp_down < 0);
+		slew_channel_q16(1000 << 16, 7000 << 16, half, half, fixed_point::kQ15One) - (7000 << 16);
+	assert(exp_up == 3000 << 16);
+	assert(exp_down == -(3000 << 16));
 
 	// Shape extremes select expected behavior.
-	const int32_t s_linear = slew_channel_mv(9000, 0, 8192, 8192, 0);
-	const int32_t s_exp = slew_channel_mv(9000, 0, 8192, 8192, fixed_point::kQ15One);
+	const int32_t s_linear = slew_channel_q16(9000 << 16, 0, medium, medium, 0);
+	const int32_t s_exp = slew_channel_q16(9000 << 16, 0, medium, medium, fixed_point::kQ15One);
 	assert(s_linear != s_exp);
 
 	// Full exponential with tiny coeff should still eventually reach target (no deadband lock).
+	const StepCoeffs tiny = {50u << 15, 0};
 	int32_t current = 0;
-	for (int i = 0; i < 2000; ++i) {
-		current = slew_channel_mv(100, current, 50, 50, fixed_point::kQ15One);
+	for (int i = 0; i < 200000; ++i) {
+		current = slew_channel_q16(100 << 16, current, tiny, tiny, fixed_point::kQ15One);
 	}
-	assert(current == 100);
+	assert(current == 100 << 16);
 
 	// Bipolar signal zero should map to 5V center in DAC domain.
 	assert(fixed_point::clamp_i32(0 + kCenterMillivolts, 0, kMaxMillivolts) == 5000);
@@ -0,0 +1,121 @@
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+
+#include "../src/cv-units.h"
+#include "../src/slew-limiter.h"
+#include "fake-hal.h"
+
+// Slew times follow the pots regardless of loop rate: the 10%-90% rise time
+// of a step, measured on the output, matches the ideal linear or RC curve for
+// the pot setting from 1 kHz to 50 kHz.
+namespace {
+constexpr double kMaxSlewS = 2.0;
+constexpr double kTolerance = 0.03;
+constexpr uint32_t kLoopRatesHz[] = {1000, 8000, 20000, 50000};
+constexpr uint8_t kPots[] = {100, 180, 255};
+
+// Full-scale slew time for a pot, mirroring the firmware's cubic taper.
+double slew_time_s(uint8_t pot) {
+	const double p = pot / 255.0;
+	return p * p * p * kMaxSlewS;
+}
+
+ControlSnapshot make_controls(uint8_t rise, uint8_t fall, uint8_t shape) {
+	ControlSnapshot c{};
+	c.set_pot(0, rise, rise * 16);
+	c.set_pot(1, fall, fall * 16);
+	c.set_pot(2, shape, shape * 16);
+	return c;
+}
+
+// Time from a 0 V -> +4 V step to the output crossing 10% and 90% of it,
+// interpolated between frames.
+double measure_rise_s(uint32_t rate_hz, uint8_t pot, bool exponential, int32_t& step_mv) {
+	SlewLimiter slew;
+	const uint32_t period_us = 1000000 / rate_hz;
+	const ControlSnapshot controls = make_controls(pot, pot, exponential ? 255 : 0);
+
+	step_mv = 4000;
+	const double low_mv = 0.1 * step_mv;
+	const double high_mv = 0.9 * step_mv;
+	const Frame in{4000, 4000, 0};
+
+	double t_low = -1.0;
+	double prev_mv = 0.0;
+	const uint32_t max_frames = static_cast<uint32_t>(rate_hz * 6.0 * kMaxSlewS);
+	for (uint32_t i = 1; i <= max_frames; ++i) {
+		Frame out;
+		slew.process(BlockParams{controls, i * period_us, period_us}, &in, &out, 1);
+		const double mv = cv_units::dac_to_mv(out.a) - cv_units::kCenterMv;
+		const double t = static_cast<double>(i) * period_us * 1e-6;
+		const double dt = period_us * 1e-6;
+		if (t_low < 0.0 && mv >= low_mv) {
+			t_low = t - dt * (mv - low_mv) / (mv - prev_mv);
+		}
+		if (mv >= high_mv) {
+			assert(t_low >= 0.0);
+			return t - dt * (mv - high_mv) / (mv - prev_mv) - t_low;
+		}
+		prev_mv = mv;
+	}
+	assert(false && "output never reached 90%");
+	return 0.0;
+}
+}  // namespace
+
+int main() {
+	for (uint8_t pot : kPots) {
+		const double slew_s = slew_time_s(pot);
+		for (uint32_t rate : kLoopRatesHz) {
+			int32_t step_mv = 0;
+			// Linear: full scale (10 V) per slew time, so 80% of the step
+			// takes 0.8 * step / 10 V of it.
+			const double linear = measure_rise_s(rate, pot, false, step_mv);
+			const double linear_ideal = 0.8 * step_mv / 10000.0 * slew_s;
+			// Exponential: time constant of one slew time, ln(9) tau from 10% to 90%.
+			const double exp = measure_rise_s(rate, pot, true, step_mv);
+			const double exp_ideal = std::log(9.0) * slew_s;
+			std::printf("pot %3u %5lu Hz: linear %.4f s (ideal %.4f), exp %.4f s (ideal %.4f)\n",
+						pot, static_cast<unsigned long>(rate), linear, linear_ideal, exp,
+						exp_ideal);
+			assert(std::fabs(linear / linear_ideal - 1.0) < kTolerance);
+			assert(std::fabs(exp / exp_ideal - 1.0) < kTolerance);
+		}
+	}
+
+	// Time the mode did not run is not slew time: after boot, and on coming
+	// back to the mode after a long gap, a step still starts from one frame's
+	// movement instead of jumping to the input.
+	{
+		SlewLimiter slew;
+		const uint32_t period_us = 125;
+		// About 10 mV per frame at this setting.
+		const ControlSnapshot controls = make_controls(100, 100, 0);
+		const Frame rest{0, 0, 0};
+		const Frame step{4000, 4000, 0};
+		Frame out;
+		uint32_t now_us = 3000000;  // first frame, long after boot
+		slew.process(BlockParams{controls, now_us, period_us}, &step, &out, 1);
+		assert(cv_units::dac_to_mv(out.a) - cv_units::kCenterMv < 20);
+		// Back down to rest, then five seconds in other modes.
+		for (uint32_t i = 0; i < 50000; ++i) {
+			now_us += period_us;
+			slew.process(BlockParams{controls, now_us, period_us}, &rest, &out, 1);
+		}
+		assert(out.a == cv_units::mv_to_dac(cv_units::kCenterMv));
+		now_us += 5000000;
+		slew.process(BlockParams{controls, now_us, period_us}, &step, &out, 1);
+		assert(cv_units::dac_to_mv(out.a) - cv_units::kCenterMv < 20);
+		// A frame a few periods late still covers its whole interval, more
+		// than two frames' worth of codes.
+		now_us += 3 * period_us;
+		Frame late;
+		slew.process(BlockParams{controls, now_us, period_us}, &step, &late, 1);
+		assert(late.a >= out.a + 8);
+	}
+
+	std::puts("slew_rise_time_test: PASS");
+	return 0;
+}
@@ -0,0 +1,87 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+#include "../src/trace.h"
+
+// Turns the firmware's trace lines (USB stdio capture) into readable text or
+// CSV. Lines that are not trace lines are skipped.
+// Usage: trace_decode [--csv] [capture.log]   (reads stdin without a file)
+namespace {
+const char* const kSourceNames[] = {"dsp", "ui"};
+
+const char* source_name(uint8_t source) {
+	return source < sizeof(kSourceNames) / sizeof(kSourceNames[0]) ? kSourceNames[source] : "?";
+}
+
+void print_text(uint8_t source, const trace::Record& r) {
+	const char* name = trace::event_name(r.event);
+	std::printf("%10.6f %-3s #%-5u ", r.timestamp_us / 1e6, source_name(source),
+				static_cast<unsigned>(r.sequence));
+	if (name == nullptr) {
+		std::printf("event_%u", static_cast<unsigned>(r.event));
+	} else {
+		std::printf("%s", name);
+	}
+	for (uint8_t i = 0; i < trace::Record::kNumArgs; ++i) {
+		const char* arg = trace::arg_name(r.event, i);
+		if (arg != nullptr) {
+			std::printf(" %s=%ld", arg, static_cast<long>(r.args[i]));
+		} else if (name == nullptr) {
+			std::printf(" %ld", static_cast<long>(r.args[i]));
+		}
+	}
+	std::printf("\n");
+}
+
+void print_csv(uint8_t source, const trace::Record& r) {
+	const char* name = trace::event_name(r.event);
+	std::printf("%lu,%s,%u,", static_cast<unsigned long>(r.timestamp_us), source_name(source),
+				static_cast<unsigned>(r.sequence));
+	if (name == nullptr) {
+		std::printf("event_%u", static_cast<unsigned>(r.event));
+	} else {
+		std::printf("%s", name);
+	}
+	for (uint8_t i = 0; i < trace::Record::kNumArgs; ++i) {
+		std::printf(",%ld", static_cast<long>(r.args[i]));
+	}
+	std::printf("\n");
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+	bool csv = false;
+	const char* path = nullptr;
+	for (int i = 1; i < argc; ++i) {
+		if (std::strcmp(argv[i], "--csv") == 0) {
+			csv = true;
+		} else {
+			path = argv[i];
+		}
+	}
+
+	FILE* in = stdin;
+	if (path != nullptr) {
+		in = std::fopen(path, "r");
+		if (in == nullptr) {
+			std::perror(path);
+			return 1;
+		}
+	}
+
+	if (csv) std::printf("timestamp_us,source,sequence,event,arg0,arg1,arg2,arg3\n");
+	char line[256];
+	while (std::fgets(line, sizeof(line), in) != nullptr) {
+		uint8_t source;
+		trace::Record record;
+		if (!trace::decode_line(line, source, record)) continue;
+		if (csv) {
+			print_csv(source, record);
+		} else {
+			print_text(source, record);
+		}
+	}
+	if (in != stdin) std::fclose(in);
+	return 0;
+}
@@ -0,0 +1,438 @@
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "../src/ad-envelope.h"
+#include "../src/attenuverter.h"
+#include "../src/control-snapshot.h"
+#include "../src/cv-mixer.h"
+#include "../src/edge-queue.h"
+#include "../src/frame.h"
+#include "../src/gate-comparator.h"
+#include "../src/noise.h"
+#include "../src/precision-adder.h"
+#include "../src/pulse-out.h"
+#include "../src/pulse-scheduler.h"
+#include "../src/slew-limiter.h"
+
+// Feeds a stimulus trace through a real mode class, frame by frame at the
+// trace's sample rate, and writes or checks the mode's output frames.
+// Usage:
+//   trace_replay STIMULUS [--golden FILE] [--write FILE] [--tolerance CODES] [--block N]
+//
+// Stimulus: text, one item per line, '#' comments. Header lines first:
+//   mode attenuverter|precision-adder|slew-limiter|ad-envelope|cv-mixer|noise
+//   rate HZ            (default 8000)
+//   duration US
+// then events, in time order (microseconds from the start):
+//   T cv A_MV B_MV            set both inputs
+//   T glide A_MV B_MV US      move both inputs linearly to A/B over US
+//   T pot INDEX VALUE [RAW]   pot 0-2 to VALUE (0-255); RAW defaults to VALUE scaled to 12 bits
+//   T button 0|1              button B released/pressed
+//   T pulse 0|1               pulse input low/high (a rising edge sets kPulseRise,
+//                             aged from T to the frame)
+// An event applies from the first frame at or after its time. Both the
+// stimulus and the golden file are streamed, so traces can be of any length.
+//
+// Output (golden) file: "# frames N", then "FRAME A B PULSE" on the first
+// frame and whenever the output changes. --golden compares every frame, codes
+// within --tolerance (default 0, bit exact) and pulses exactly. Throughput of
+// the mode's process() calls alone is reported in host ns/sample.
+namespace {
+constexpr size_t kMaxBlock = 128;
+
+struct Options {
+	const char* stimulus = nullptr;
+	const char* golden = nullptr;
+	const char* write = nullptr;
+	int32_t tolerance = 0;
+	size_t block = 32;
+};
+
+struct Stimulus {
+	FILE* file = nullptr;
+	const char* path = nullptr;
+	uint32_t line_number = 0;
+
+	char mode[32] = {};
+	uint32_t rate_hz = 8000;
+	uint32_t duration_us = 0;
+
+	// Next event, already parsed; valid while has_event.
+	bool has_event = false;
+	uint32_t event_us = 0;  // also the time of the previous event
+	char event[16] = {};
+	long args[4] = {};
+	int num_args = 0;
+	bool failed = false;
+
+	bool fail(const char* message) {
+		std::fprintf(stderr, "%s:%lu: %s\n", path, static_cast<unsigned long>(line_number),
+					 message);
+		failed = true;
+		has_event = false;
+		return false;
+	}
+
+	// Reads the header and the first event.
+	bool open(const char* stimulus_path) {
+		path = stimulus_path;
+		file = std::fopen(path, "r");
+		if (file == nullptr) {
+			std::perror(path);
+			return false;
+		}
+		advance();
+		if (failed) return false;
+		if (mode[0] == '\0' || duration_us == 0 || rate_hz == 0) {
+			return fail("header needs mode and duration");
+		}
+		return true;
+	}
+
+	// Parses lines up to the next event; header lines are taken on the way.
+	void advance() {
+		has_event = false;
+		char line[256];
+		while (std::fgets(line, sizeof(line), file) != nullptr) {
+			++line_number;
+			char* comment = std::strchr(line, '#');
+			if (comment != nullptr) *comment = '\0';
+			char word[16];
+			if (std::sscanf(line, "%15s", word) != 1) continue;
+			if (std::strcmp(word, "mode") == 0) {
+				std::sscanf(line, "%*s %31s", mode);
+				continue;
+			}
+			if (std::strcmp(word, "rate") == 0) {
+				rate_hz = static_cast<uint32_t>(std::strtoul(line + 4, nullptr, 10));
+				continue;
+			}
+			if (std::strcmp(word, "duration") == 0) {
+				duration_us = static_cast<uint32_t>(std::strtoul(line + 8, nullptr, 10));
+				continue;
+			}
+			unsigned long t = 0;
+			const int fields = std::sscanf(line, "%lu %15s %ld %ld %ld %ld", &t, event, &args[0],
+										   &args[1], &args[2], &args[3]);
+			if (fields < 2) {
+				fail("expected 'TIME EVENT ARGS...'");
+				return;
+			}
+			if (t < event_us) {
+				fail("event before the previous one");
+				return;
+			}
+			event_us = static_cast<uint32_t>(t);
+			num_args = fields - 2;
+			has_event = true;
+			return;
+		}
+	}
+};
+
+// Input and control state the events drive, rendered once per frame.
+struct Player {
+	ControlSnapshot controls{};
+	bool pulse_high = false;
+	EdgeInput pulse_edges;
+	// Gate comparators in mV, once per frame (on target: per ADC pair).
+	GateComparator gates[2];
+
+	// Inputs in mV: a glide runs from `from` at from_us to `to` at to_us.
+	int32_t from_mv[2] = {0, 0};
+	int32_t to_mv[2] = {0, 0};
+	uint32_t from_us = 0;
+	uint32_t to_us = 0;
+
+	static bool is_control(const char* event) {
+		return std::strcmp(event, "pot") == 0 || std::strcmp(event, "button") == 0;
+	}
+
+	int32_t input_mv(int channel, uint32_t now_us) const {
+		if (now_us >= to_us || to_us == from_us) return to_mv[channel];
+		const int64_t span = to_mv[channel] - from_mv[channel];
+		return from_mv[channel] +
+			   static_cast<int32_t>(span * (now_us - from_us) / (to_us - from_us));
+	}
+
+	bool apply(Stimulus& s, uint32_t now_us) {
+		const char* e = s.event;
+		if (std::strcmp(e, "cv") == 0 && s.num_args == 2) {
+			for (int c = 0; c < 2; ++c) from_mv[c] = to_mv[c] = static_cast<int32_t>(s.args[c]);
+			from_us = to_us = now_us;
+		} else if (std::strcmp(e, "glide") == 0 && s.num_args == 3 && s.args[2] >= 0) {
+			for (int c = 0; c < 2; ++c) {
+				from_mv[c] = input_mv(c, now_us);
+				to_mv[c] = static_cast<int32_t>(s.args[c]);
+			}
+			from_us = now_us;
+			to_us = now_us + static_cast<uint32_t>(s.args[2]);
+		} else if (std::strcmp(e, "pot") == 0 && (s.num_args == 2 || s.num_args == 3) &&
+				   s.args[0] >= 0 && s.args[0] < ControlSnapshot::kNumPots && s.args[1] >= 0 &&
+				   s.args[1] <= 255) {
+			const uint8_t value = static_cast<uint8_t>(s.args[1]);
+			const uint16_t raw = s.num_args == 3 ? static_cast<uint16_t>(s.args[2])
+												 : static_cast<uint16_t>(value * 4095 / 255);
+			controls.set_pot(static_cast<uint8_t>(s.args[0]), value, raw);
+		} else if (std::strcmp(e, "button") == 0 && s.num_args == 1) {
+			controls.button_b_pressed = s.args[0] != 0;
+		} else if (std::strcmp(e, "pulse") == 0 && s.num_args == 1) {
+			const bool high = s.args[0] != 0;
+			if (high != pulse_high) pulse_edges.add(s.event_us, high);
+			pulse_high = high;
+		} else {
+			return s.fail("unknown event or bad arguments");
+		}
+		return true;
+	}
+
+	Frame frame(uint32_t now_us) {
+		Frame f{};
+		f.a = static_cast<int16_t>(input_mv(0, now_us));
+		f.b = static_cast<int16_t>(input_mv(1, now_us));
+		const EdgeInput::State pulse = pulse_edges.take(now_us);
+		f.pulse = static_cast<uint8_t>((pulse.high ? Frame::kPulseHigh : 0) |
+									   (pulse.rose ? Frame::kPulseRise : 0));
+		f.pulse_us = pulse.rise_age_us;
+		const int32_t mv[2] = {f.a, f.b};
+		const uint8_t high_bits[2] = {Frame::kGateHighA, Frame::kGateHighB};
+		const uint8_t rise_bits[2] = {Frame::kGateRiseA, Frame::kGateRiseB};
+		for (int c = 0; c < 2; ++c) {
+			if (gates[c].update(mv[c]) == GateComparator::Transition::kRise) f.gate |= rise_bits[c];
+			if (gates[c].high()) f.gate |= high_bits[c];
+		}
+		return f;
+	}
+};
+
+// Streams the golden change list back out as one frame at a time.
+struct GoldenReader {
+	FILE* file = nullptr;
+	uint32_t frames = 0;
+	Frame current{};
+	bool has_next = false;
+	uint32_t next_frame = 0;
+	Frame next{};
+
+	~GoldenReader() {
+		if (file != nullptr) std::fclose(file);
+	}
+
+	bool open(const char* path) {
+		file = std::fopen(path, "r");
+		if (file == nullptr) {
+			std::perror(path);
+			return false;
+		}
+		char line[128];
+		if (std::fgets(line, sizeof(line), file) == nullptr ||
+			std::sscanf(line, "# frames %u", &frames) != 1) {
+			std::fprintf(stderr, "%s: missing '# frames N' header\n", path);
+			return false;
+		}
+		read_next();
+		return true;
+	}
+
+	void read_next() {
+		has_next = false;
+		char line[128];
+		while (std::fgets(line, sizeof(line), file) != nullptr) {
+			unsigned long index;
+			long a, b;
+			unsigned pulse;
+			if (std::sscanf(line, "%lu %ld %ld %u", &index, &a, &b, &pulse) != 4) continue;
+			next_frame = static_cast<uint32_t>(index);
+			next = {static_cast<int16_t>(a), static_cast<int16_t>(b), static_cast<uint8_t>(pulse)};
+			has_next = true;
+			return;
+		}
+	}
+
+	const Frame& at(uint32_t frame) {
+		while (has_next && next_frame <= frame) {
+			current = next;
+			read_next();
+		}
+		return current;
+	}
+};
+
+struct Comparison {
+	uint32_t mismatches = 0;
+	int32_t worst = 0;
+	uint32_t first_mismatch = 0;
+};
+
+int32_t abs_diff(int32_t a, int32_t b) {
+	return a > b ? a - b : b - a;
+}
+
+template <typename Mode>
+int replay(Stimulus& stimulus, const Options& options) {
+	Mode mode;
+	Player player;
+	const uint32_t period_us = 1000000 / stimulus.rate_hz;
+	const uint32_t num_frames = stimulus.duration_us / period_us;
+
+	FILE* out = nullptr;
+	if (options.write != nullptr) {
+		out = std::fopen(options.write, "w");
+		if (out == nullptr) {
+			std::perror(options.write);
+			return 1;
+		}
+		std::fprintf(out, "# frames %lu\n", static_cast<unsigned long>(num_frames));
+	}
+	GoldenReader golden;
+	if (options.golden != nullptr) {
+		if (!golden.open(options.golden)) return 1;
+		if (golden.frames != num_frames) {
+			std::fprintf(stderr, "golden has %lu frames, stimulus %lu\n",
+						 static_cast<unsigned long>(golden.frames),
+						 static_cast<unsigned long>(num_frames));
+			return 1;
+		}
+	}
+
+	Frame in[kMaxBlock];
+	Frame result[kMaxBlock];
+	Frame previous{};
+	// The pulse jack, scheduled as on target; the golden records its level
+	// at each frame time in place of kPulseHigh.
+	PulseScheduler pulse_out(PulseOut::kMinGapUs, PulseScheduler::Retrigger::kRestart);
+	Comparison comparison;
+	std::chrono::steady_clock::duration process_time{};
+	for (uint32_t first = 0; first < num_frames;) {
+		size_t n = num_frames - first < options.block ? num_frames - first : options.block;
+		for (size_t i = 0; i < n; ++i) {
+			const uint32_t now_us = (first + static_cast<uint32_t>(i)) * period_us;
+			// Controls are held for a block, so a control change starts a new
+			// one; the outputs then do not depend on the block size.
+			if (i > 0 && stimulus.has_event && stimulus.event_us <= now_us &&
+				Player::is_control(stimulus.event)) {
+				n = i;
+				break;
+			}
+			while (stimulus.has_event && stimulus.event_us <= now_us) {
+				if (!player.apply(stimulus, now_us)) return 1;
+				stimulus.advance();
+			}
+			if (stimulus.failed) return 1;
+			in[i] = player.frame(now_us);
+		}
+
+		const BlockParams params{player.controls, first * period_us, period_us};
+		const auto start = std::chrono::steady_clock::now();
+		mode.process(params, in, result, n);
+		process_time += std::chrono::steady_clock::now() - start;
+
+		for (size_t i = 0; i < n; ++i) {
+			const uint32_t frame = first + static_cast<uint32_t>(i);
+			Frame& f = result[i];
+			const uint32_t frame_us = frame * period_us;
+			if (f.pulse & Frame::kPulseRise) pulse_out.request(frame_us, f.pulse_us);
+			f.pulse = static_cast<uint8_t>((f.pulse & Frame::kPulseRise) |
+										   (pulse_out.update(frame_us) ? Frame::kPulseHigh : 0));
+			if (out != nullptr &&
+				(frame == 0 || f.a != previous.a || f.b != previous.b || f.pulse != previous.pulse)) {
+				std::fprintf(out, "%lu %d %d %u\n", static_cast<unsigned long>(frame), f.a, f.b,
+							 static_cast<unsigned>(f.pulse));
+			}
+			previous = f;
+			if (options.golden != nullptr) {
+				const Frame& g = golden.at(frame);
+				const int32_t diff = abs_diff(f.a, g.a) > abs_diff(f.b, g.b) ? abs_diff(f.a, g.a)
+																			 : abs_diff(f.b, g.b);
+				if (diff > options.tolerance || f.pulse != g.pulse) {
+					if (comparison.mismatches == 0) {
+						comparison.first_mismatch = frame;
+						std::fprintf(stderr,
+									 "first mismatch at frame %lu (%.6f s): got %d %d %u, golden "
+									 "%d %d %u\n",
+									 static_cast<unsigned long>(frame), frame * period_us / 1e6,
+									 f.a, f.b, static_cast<unsigned>(f.pulse), g.a, g.b,
+									 static_cast<unsigned>(g.pulse));
+					}
+					++comparison.mismatches;
+				}
+				if (diff > comparison.worst) comparison.worst = diff;
+			}
+		}
+		first += static_cast<uint32_t>(n);
+	}
+	if (out != nullptr) std::fclose(out);
+
+	const double ns = std::chrono::duration<double, std::nano>(process_time).count();
+	std::printf("%s: %lu frames, block %zu, %.1f ns/sample", stimulus.mode,
+				static_cast<unsigned long>(num_frames), options.block,
+				num_frames > 0 ? ns / num_frames : 0.0);
+	if (options.golden != nullptr) {
+		std::printf(", worst deviation %ld codes, %lu frames outside tolerance %ld",
+					static_cast<long>(comparison.worst),
+					static_cast<unsigned long>(comparison.mismatches),
+					static_cast<long>(options.tolerance));
+	}
+	std::printf("\n");
+	return comparison.mismatches == 0 ? 0 : 1;
+}
+
+bool parse_options(int argc, char** argv, Options& options) {
+	for (int i = 1; i < argc; ++i) {
+		const bool has_value = i + 1 < argc;
+		if (std::strcmp(argv[i], "--golden") == 0 && has_value) {
+			options.golden = argv[++i];
+		} else if (std::strcmp(argv[i], "--write") == 0 && has_value) {
+			options.write = argv[++i];
+		} else if (std::strcmp(argv[i], "--tolerance") == 0 && has_value) {
+			options.tolerance = static_cast<int32_t>(std::strtol(argv[++i], nullptr, 10));
+		} else if (std::strcmp(argv[i], "--block") == 0 && has_value) {
+			options.block = static_cast<size_t>(std::strtoul(argv[++i], nullptr, 10));
+		} else if (argv[i][0] != '-' && options.stimulus == nullptr) {
+			options.stimulus = argv[i];
+		} else {
+			return false;
+		}
+	}
+	return options.stimulus != nullptr && options.block >= 1 && options.block <= kMaxBlock &&
+		   options.tolerance >= 0;
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+	Options options;
+	if (!parse_options(argc, argv, options)) {
+		std::fprintf(stderr,
+					 "usage: trace_replay STIMULUS [--golden FILE] [--write FILE] "
+					 "[--tolerance CODES] [--block 1-%zu]\n",
+					 kMaxBlock);
+		return 2;
+	}
+
+	Stimulus stimulus;
+	if (!stimulus.open(options.stimulus)) return 1;
+	const char* mode = stimulus.mode;
+	int result;
+	if (std::strcmp(mode, "attenuverter") == 0) {
+		result = replay<Attenuverter>(stimulus, options);
+	} else if (std::strcmp(mode, "precision-adder") == 0) {
+		result = replay<PrecisionAdder>(stimulus, options);
+	} else if (std::strcmp(mode, "slew-limiter") == 0) {
+		result = replay<SlewLimiter>(stimulus, options);
+	} else if (std::strcmp(mode, "ad-envelope") == 0) {
+		result = replay<AdEnvelope>(stimulus, options);
+	} else if (std::strcmp(mode, "cv-mixer") == 0) {
+		result = replay<CvMixer>(stimulus, options);
+	} else if (std::strcmp(mode, "noise") == 0) {
+		result = replay<Noise>(stimulus, options);
+	} else {
+		std::fprintf(stderr, "%s: unknown mode '%s'\n", options.stimulus, mode);
+		result = 1;
+	}
+	std::fclose(stimulus.file);
+	return result;
+}
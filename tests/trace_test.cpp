@@ -0,0 +1,91 @@
+#include <cassert>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+
+#include "../src/trace.h"
+
+int main() {
+	// Round trip through the hex line format, including negative payloads.
+	{
+		const trace::Record r{123456789u, static_cast<uint16_t>(trace::Event::kSlewChannel), 42,
+							  {1, -5000, 7, 2147483647}};
+		char line[trace::kLineBufferSize];
+		trace::encode_line(trace::kSourceDsp, r, line);
+		assert(std::strlen(line) == trace::kLineChars);
+		assert(line[trace::kLineChars - 1] == '\n');
+
+		uint8_t source = 9;
+		trace::Record back{};
+		assert(trace::decode_line(line, source, back));
+		assert(source == trace::kSourceDsp);
+		assert(back.timestamp_us == r.timestamp_us && back.event == r.event);
+		assert(back.sequence == 42);
+		for (uint8_t i = 0; i < trace::Record::kNumArgs; ++i) assert(back.args[i] == r.args[i]);
+
+		// Interleaved stdio text and truncated lines are not trace lines.
+		assert(!trace::decode_line("Profile reset\n", source, back));
+		line[20] = '\0';
+		assert(!trace::decode_line(line, source, back));
+	}
+
+	// Event names cover every event and its used payloads only.
+	assert(std::strcmp(trace::event_name(static_cast<uint16_t>(trace::Event::kModeStats)),
+					   "mode_stats") == 0);
+	assert(trace::arg_name(static_cast<uint16_t>(trace::Event::kModeChange), 1) == nullptr);
+	assert(trace::event_name(static_cast<uint16_t>(trace::Event::kNumEvents)) == nullptr);
+
+	// A full ring drops and counts new records instead of overwriting.
+	{
+		trace::Ring<4> ring;
+		for (int32_t i = 0; i < 4; ++i) assert(ring.write(i, trace::Event::kModeChange, i));
+		assert(!ring.write(4, trace::Event::kModeChange, 4));
+		assert(ring.dropped() == 1);
+
+		trace::Record r;
+		for (int32_t i = 0; i < 4; ++i) {
+			assert(ring.read(r));
+			assert(r.args[0] == i && r.sequence == i);
+		}
+		assert(!ring.read(r));
+
+		// Indices wrap cleanly after draining.
+		for (int32_t i = 0; i < 10; ++i) {
+			assert(ring.write(i, trace::Event::kModeChange, i));
+			assert(ring.read(r) && r.args[0] == i);
+		}
+	}
+
+	// Concurrent writer and drainer: records arrive whole and in order, and
+	// every record is either read or counted as dropped.
+	{
+		static trace::Ring<64> ring;
+		constexpr int32_t kWrites = 200000;
+		std::thread producer([]() {
+			for (int32_t i = 0; i < kWrites; ++i) {
+				ring.write(static_cast<uint32_t>(i), trace::Event::kSlewChannel, i, -i, i, -i);
+			}
+		});
+		int32_t read = 0;
+		int32_t last = -1;
+		trace::Record r;
+		while (true) {
+			if (ring.read(r)) {
+				assert(r.args[1] == -r.args[0] && r.args[2] == r.args[0]);
+				assert(r.args[3] == -r.args[0]);
+				assert(static_cast<int32_t>(r.timestamp_us) == r.args[0]);
+				assert(r.args[0] > last);
+				last = r.args[0];
+				++read;
+			} else if (read + static_cast<int32_t>(ring.dropped()) == kWrites) {
+				break;
+			}
+		}
+		producer.join();
+		assert(!ring.read(r));
+	}
+
+	std::puts("trace_test: PASS");
+	return 0;
+}